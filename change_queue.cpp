@@ -0,0 +1,63 @@
+#include "change_queue.h"
+
+void ChangeQueue::clear() {
+    head = 0;
+    count = 0;
+    overflowed = false;
+    pendingTypes = 0;
+    pendingSettings = 0;
+}
+
+void ChangeQueue::publish(ChangeType type, uint8_t arg) {
+    uint8_t typeBit = 1U << (uint8_t)type;
+    if (type == ChangeType::SETTINGS) {
+        if (arg >= 32 || (pendingSettings & (1UL << arg))) return;
+    } else if (pendingTypes & typeBit) {
+        return;
+    }
+
+    if (count >= CAPACITY) {
+        overflowed = true;
+        return;
+    }
+
+    ChangeEvent& slot = events[(head + count) % CAPACITY];
+    slot.type = type;
+    slot.arg = arg;
+    count++;
+
+    pendingTypes |= typeBit;
+    if (type == ChangeType::SETTINGS) pendingSettings |= (1UL << arg);
+}
+
+bool ChangeQueue::pop(ChangeEvent& event) {
+    if (count == 0) return false;
+    event = events[head];
+    head = (head + 1) % CAPACITY;
+    count--;
+
+    if (event.type == ChangeType::SETTINGS) {
+        pendingSettings &= ~(1UL << event.arg);
+        if (pendingSettings == 0) pendingTypes &= ~(1U << (uint8_t)ChangeType::SETTINGS);
+    } else {
+        pendingTypes &= ~(1U << (uint8_t)event.type);
+    }
+    return true;
+}
+
+ChangeSet ChangeQueue::drain() {
+    ChangeSet set = { 0, 0 };
+    if (overflowed) {
+        set.types = (1U << CHANGE_TYPE_COUNT) - 1;
+        set.settings = 0xFFFFFFFF;
+        clear();
+        return set;
+    }
+
+    ChangeEvent event;
+    while (pop(event)) {
+        set.types |= 1U << (uint8_t)event.type;
+        if (event.type == ChangeType::SETTINGS) set.settings |= (1UL << event.arg);
+    }
+    return set;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#ifndef CHANGE_QUEUE_H
+#define CHANGE_QUEUE_H
+#include <stdint.h>
+
+// What changed in TimerCore since the display last drew a frame
+enum class ChangeType : uint8_t {
+    STATE,     // TimerState transition
+    TASK,      // Current task or task count
+    STATS,     // Completed / interrupted counters
+    SETTINGS,  // A persisted setting; arg is the MenuItem
+    SECOND,    // Displayed time moved (countdown second, wind-up, blink, idle minute)
+    MENU       // Menu opened, closed, navigated or value edited
+};
+const uint8_t CHANGE_TYPE_COUNT = 6;
+
+struct ChangeEvent {
+    ChangeType type;
+    uint8_t arg;
+};
+
+// Everything drained in one frame, coalesced into bitmasks
+struct ChangeSet {
+    uint8_t types;
+    uint32_t settings;  // One bit per MenuItem
+
+    bool any() const { return types != 0; }
+    bool has(ChangeType type) const { return types & (1U << (uint8_t)type); }
+    bool hasSetting(uint8_t item) const { return settings & (1UL << item); }
+    // True if anything other than the displayed time changed
+    bool structural() const { return types & ~(1U << (uint8_t)ChangeType::SECOND); }
+};
+
+// Fixed-size FIFO of change notifications from TimerCore to the UI.
+// An event that is already queued is dropped, so a burst of identical
+// changes within one frame costs a single entry. If the queue ever fills,
+// the next drain reports every change type.
+class ChangeQueue {
+public:
+    static const uint8_t CAPACITY = 16;
+
+    ChangeQueue() { clear(); markAll(); }
+
+    void publish(ChangeType type, uint8_t arg = 0);
+    bool pop(ChangeEvent& event);
+    ChangeSet drain();
+
+    void markAll() { overflowed = true; }  // Force a full refresh on the next drain
+    void clear();
+    uint8_t size() const { return count; }
+
+private:
+    ChangeEvent events[CAPACITY];
+    uint8_t head;
+    uint8_t count;
+    bool overflowed;
+    uint8_t pendingTypes;      // Coalescing: types currently queued
+    uint32_t pendingSettings;  // Coalescing: SETTINGS args currently queued
+};
+
+#endif
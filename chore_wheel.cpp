@@ -0,0 +1,228 @@
+#include "chore_wheel.h"
+
+namespace {
+
+// Index of the first set bit at or after `start`, wrapping around (64 if none)
+uint8_t firstFrom(uint64_t bits, uint8_t start) {
+    if (bits == 0) return 64;
+    uint64_t rotated = start ? (bits >> start) | (bits << (64 - start)) : bits;
+    return (uint8_t)__builtin_ctzll(rotated);
+}
+
+} // namespace
+
+ChoreWheel::ChoreWheel() {
+    for (uint8_t i = 0; i < MAX_CHORES; i++) {
+        chores[i].name = nullptr;
+        chores[i].fn = nullptr;
+        chores[i].period = 0;
+    }
+    reset(0);
+}
+
+void ChoreWheel::reset(uint32_t nowMs) {
+    for (uint8_t l = 0; l < LEVELS; l++) {
+        occupied[l] = 0;
+        for (uint8_t s = 0; s < SLOTS; s++) heads[l][s] = NONE;
+    }
+    for (uint8_t i = 0; i < MAX_CHORES; i++) {
+        chores[i].due = 0;
+        chores[i].armed = false;
+        chores[i].level = NONE;
+        chores[i].prev = NONE;
+        chores[i].next = NONE;
+    }
+    clearStats();
+    current = nowMs;
+}
+
+void ChoreWheel::add(uint8_t id, const char* name, ChoreFn fn, uint32_t periodMs) {
+    if (id >= MAX_CHORES) return;
+    cancel(id);
+    chores[id].name = name;
+    chores[id].fn = fn;
+    chores[id].period = periodMs;
+}
+
+void ChoreWheel::schedule(uint8_t id, uint32_t dueMs) {
+    if (id >= MAX_CHORES || chores[id].fn == nullptr) return;
+    unlink(id);
+    chores[id].due = dueMs;
+    chores[id].armed = true;
+    link(id);
+}
+
+void ChoreWheel::cancel(uint8_t id) {
+    if (id >= MAX_CHORES) return;
+    unlink(id);
+    chores[id].armed = false;
+}
+
+void ChoreWheel::clearStats() {
+    for (uint8_t i = 0; i < MAX_CHORES; i++) {
+        chores[i].stats.runs = 0;
+        chores[i].stats.lastLateMs = 0;
+        chores[i].stats.maxLateMs = 0;
+        chores[i].stats.totalLateMs = 0;
+    }
+}
+
+// Place a chore by distance to its due tick. Overdue chores land in the
+// next tick; anything beyond the top level waits in its farthest slot and
+// is re-placed when that slot cascades.
+void ChoreWheel::link(uint8_t id) {
+    Chore& c = chores[id];
+    uint32_t due = ((int32_t)(c.due - current) < 0) ? current : c.due;
+    uint32_t delta = due - current;
+
+    uint8_t level = 0;
+    while (level < LEVELS - 1 && delta >= (1UL << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    uint8_t slot;
+    if (delta >= (1UL << (SLOT_BITS * LEVELS))) {
+        slot = (uint8_t)(((current >> (SLOT_BITS * level)) + SLOT_MASK) & SLOT_MASK);
+    } else {
+        slot = (uint8_t)((due >> (SLOT_BITS * level)) & SLOT_MASK);
+    }
+
+    c.level = level;
+    c.slot = slot;
+    c.prev = NONE;
+    c.next = heads[level][slot];
+    if (c.next != NONE) chores[c.next].prev = id;
+    heads[level][slot] = id;
+    occupied[level] |= (1ULL << slot);
+}
+
+void ChoreWheel::unlink(uint8_t id) {
+    Chore& c = chores[id];
+    if (c.level == NONE) return;
+
+    if (c.prev != NONE) {
+        chores[c.prev].next = c.next;
+    } else {
+        heads[c.level][c.slot] = c.next;
+    }
+    if (c.next != NONE) chores[c.next].prev = c.prev;
+    if (heads[c.level][c.slot] == NONE) occupied[c.level] &= ~(1ULL << c.slot);
+
+    c.level = NONE;
+    c.prev = NONE;
+    c.next = NONE;
+}
+
+// Empty a slot into `ids`; callbacks may re-arm or cancel any of them
+uint8_t ChoreWheel::detach(uint8_t level, uint8_t slot, uint8_t* ids) {
+    uint8_t count = 0;
+    uint8_t id = heads[level][slot];
+    while (id != NONE && count < MAX_CHORES) {
+        uint8_t next = chores[id].next;
+        chores[id].level = NONE;
+        chores[id].prev = NONE;
+        chores[id].next = NONE;
+        ids[count++] = id;
+        id = next;
+    }
+    heads[level][slot] = NONE;
+    occupied[level] &= ~(1ULL << slot);
+    return count;
+}
+
+void ChoreWheel::cascade(uint8_t level, uint8_t slot) {
+    if (!(occupied[level] & (1ULL << slot))) return;
+    uint8_t ids[MAX_CHORES];
+    uint8_t count = detach(level, slot, ids);
+    for (uint8_t i = 0; i < count; i++) link(ids[i]);
+}
+
+void ChoreWheel::runSlot(uint8_t slot, uint32_t tick, uint32_t nowMs) {
+    if (!(occupied[0] & (1ULL << slot))) return;
+    uint8_t ids[MAX_CHORES];
+    uint8_t count = detach(0, slot, ids);
+    for (uint8_t i = 0; i < count; i++) {
+        Chore& c = chores[ids[i]];
+        // Skip chores cancelled or re-armed by an earlier callback
+        if (!c.armed || c.level != NONE) continue;
+        if ((int32_t)(c.due - tick) > 0) {
+            link(ids[i]);
+        } else {
+            run(ids[i], nowMs);
+        }
+    }
+}
+
+void ChoreWheel::run(uint8_t id, uint32_t nowMs) {
+    Chore& c = chores[id];
+    int32_t late = (int32_t)(nowMs - c.due);
+    uint32_t late_ms = (late > 0) ? (uint32_t)late : 0;
+
+    c.stats.runs++;
+    c.stats.lastLateMs = late_ms;
+    c.stats.totalLateMs += late_ms;
+    if (late_ms > c.stats.maxLateMs) c.stats.maxLateMs = late_ms;
+
+    if (c.period > 0) {
+        // Keep the original phase; skip periods that were missed entirely
+        c.due += c.period;
+        if ((int32_t)(c.due - nowMs) <= 0) {
+            c.due += ((nowMs - c.due) / c.period + 1) * c.period;
+        }
+        link(id);
+    } else {
+        c.armed = false;
+    }
+    c.fn();
+}
+
+void ChoreWheel::advance(uint32_t nowMs) {
+    const uint32_t level1_mask = (1UL << (SLOT_BITS * 2)) - 1;
+
+    while ((int32_t)(nowMs - current) >= 0) {
+        uint32_t tick = current;
+        if ((tick & SLOT_MASK) == 0) {
+            if ((tick & level1_mask) == 0) {
+                cascade(2, (uint8_t)((tick >> (SLOT_BITS * 2)) & SLOT_MASK));
+            }
+            cascade(1, (uint8_t)((tick >> SLOT_BITS) & SLOT_MASK));
+        }
+        current = tick + 1;
+        runSlot((uint8_t)(tick & SLOT_MASK), tick, nowMs);
+
+        // Jump over empty level-0 slots, stopping at the next cascade boundary
+        uint8_t offset = (uint8_t)(current & SLOT_MASK);
+        if (offset != 0) {
+            uint64_t ahead = occupied[0] >> offset;
+            uint32_t next = ahead ? current + __builtin_ctzll(ahead)
+                                  : (current | SLOT_MASK) + 1;
+            if ((int32_t)(next - nowMs) > 0) next = nowMs + 1;
+            current = next;
+        }
+    }
+}
+
+// Ticks from `current` until the first occupied slot of a level is handled:
+// run for level 0, cascaded for the upper levels
+uint32_t ChoreWheel::nextTickAtLevel(uint8_t level) const {
+    if (occupied[level] == 0) return NO_EXPIRY;
+    if (level == 0) return firstFrom(occupied[0], (uint8_t)(current & SLOT_MASK));
+
+    uint8_t shift = SLOT_BITS * level;
+    uint32_t block = current >> shift;
+    bool aligned = (current & ((1UL << shift) - 1)) == 0;
+    uint8_t start = (uint8_t)((block + (aligned ? 0 : 1)) & SLOT_MASK);
+    uint32_t blocks = firstFrom(occupied[level], start) + (aligned ? 0 : 1);
+    return ((block + blocks) << shift) - current;
+}
+
+uint32_t ChoreWheel::msUntilNext(uint32_t nowMs) const {
+    uint32_t ahead = NO_EXPIRY;
+    for (uint8_t l = 0; l < LEVELS; l++) {
+        uint32_t ticks = nextTickAtLevel(l);
+        if (ticks < ahead) ahead = ticks;
+    }
+    if (ahead == NO_EXPIRY) return NO_EXPIRY;
+
+    int32_t wait = (int32_t)(current + ahead - nowMs);
+    return (wait > 0) ? (uint32_t)wait : 0;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef CHORE_WHEEL_H
+#define CHORE_WHEEL_H
+#include <stdint.h>
+
+// Hierarchical timing wheel for the periodic chores of the main loop.
+//
+// Three levels of 64 slots with a 1 ms tick (64 ms, 4.1 s and 262 s spans).
+// Chores are a fixed set registered once; each sits in at most one slot, so
+// arming, cancelling and running a chore are O(1). Empty slots are skipped
+// through per-level occupancy bitmaps, and every run records how late the
+// callback fired compared to its due time.
+typedef void (*ChoreFn)();
+
+struct ChoreStats {
+    uint32_t runs;
+    uint32_t lastLateMs;
+    uint32_t maxLateMs;
+    uint64_t totalLateMs;
+};
+
+class ChoreWheel {
+public:
+    static const uint8_t MAX_CHORES = 8;
+    static const uint32_t NO_EXPIRY = 0xFFFFFFFF;
+
+    ChoreWheel();
+
+    // Restart the wheel at nowMs with every chore disarmed
+    void reset(uint32_t nowMs);
+
+    // Register chore `id`; periodMs == 0 makes it a one-shot
+    void add(uint8_t id, const char* name, ChoreFn fn, uint32_t periodMs);
+
+    void schedule(uint8_t id, uint32_t dueMs);  // (Re)arm at an absolute time
+    void cancel(uint8_t id);
+    bool isArmed(uint8_t id) const { return id < MAX_CHORES && chores[id].armed; }
+    uint32_t dueAt(uint8_t id) const { return chores[id].due; }
+
+    // Run every chore due at or before nowMs, in due order
+    void advance(uint32_t nowMs);
+
+    // Milliseconds until the wheel next needs advance() (NO_EXPIRY if empty)
+    uint32_t msUntilNext(uint32_t nowMs) const;
+
+    const char* name(uint8_t id) const { return chores[id].name; }
+    const ChoreStats& stats(uint8_t id) const { return chores[id].stats; }
+    void clearStats();
+
+private:
+    static const uint8_t LEVELS = 3;
+    static const uint8_t SLOT_BITS = 6;
+    static const uint8_t SLOTS = 1 << SLOT_BITS;
+    static const uint32_t SLOT_MASK = SLOTS - 1;
+    static const uint8_t NONE = 0xFF;
+
+    struct Chore {
+        const char* name;
+        ChoreFn fn;
+        uint32_t period;
+        uint32_t due;
+        bool armed;
+        uint8_t level;  // NONE while not linked into a slot
+        uint8_t slot;
+        uint8_t prev;
+        uint8_t next;
+        ChoreStats stats;
+    };
+
+    Chore chores[MAX_CHORES];
+    uint8_t heads[LEVELS][SLOTS];
+    uint64_t occupied[LEVELS];
+    uint32_t current;  // Next tick to process
+
+    void link(uint8_t id);
+    void unlink(uint8_t id);
+    uint8_t detach(uint8_t level, uint8_t slot, uint8_t* ids);
+    void cascade(uint8_t level, uint8_t slot);
+    void runSlot(uint8_t slot, uint32_t tick, uint32_t nowMs);
+    void run(uint8_t id, uint32_t nowMs);
+    uint32_t nextTickAtLevel(uint8_t level) const;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#include "core_log.h"
+#include <stdarg.h>
+#include <stdio.h>
+#ifdef ESP_PLATFORM
+#include <Arduino.h>
+#endif
+
+namespace {
+
+const size_t LOG_LINE_MAX = 192;  // Longer lines are cut
+
+#ifdef ESP_PLATFORM
+class SerialLogSink : public LogSink {
+public:
+    void write(const char* text) override { Serial.print(text); }
+};
+
+SerialLogSink serialSink;
+LogSink* activeSink = &serialSink;
+#else
+LogSink* activeSink = nullptr;
+#endif
+
+} // namespace
+
+void setLogSink(LogSink* sink) {
+    activeSink = sink;
+}
+
+void coreLog(const char* format, ...) {
+    if (activeSink == nullptr) return;
+    char line[LOG_LINE_MAX];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    activeSink->write(line);
+}
@@ -0,0 +1,19 @@
+#pragma once
+#ifndef CORE_LOG_H
+#define CORE_LOG_H
+
+// Log output of the timer core modules. On the device it goes to Serial;
+// on the host it is dropped unless a sink is installed, so simulations
+// can run millions of sessions quietly.
+class LogSink {
+public:
+    virtual ~LogSink() {}
+    virtual void write(const char* text) = 0;
+};
+
+void setLogSink(LogSink* sink);  // nullptr silences the log
+
+// printf-style; lines carry their own '\n'
+void coreLog(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+#endif
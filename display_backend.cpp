@@ -0,0 +1,224 @@
+#include "display_backend.h"
+#include <string.h>
+
+namespace {
+
+// ST7789 commands used here (MIPI DCS numbering)
+const uint8_t CMD_NOP = 0x00;
+const uint8_t CMD_SWRESET = 0x01;
+const uint8_t CMD_SLPIN = 0x10;
+const uint8_t CMD_SLPOUT = 0x11;
+const uint8_t CMD_INVON = 0x21;
+const uint8_t CMD_DISPOFF = 0x28;
+const uint8_t CMD_DISPON = 0x29;
+const uint8_t CMD_CASET = 0x2A;
+const uint8_t CMD_RASET = 0x2B;
+const uint8_t CMD_RAMWR = 0x2C;
+const uint8_t CMD_MADCTL = 0x36;
+const uint8_t CMD_RAMWRC = 0x3C;
+
+// MADCTL for TFT_eSPI rotations 1 and 3 (MX|MV and MY|MV, RGB order)
+const uint8_t MADCTL_ROTATION_1 = 0x60;
+const uint8_t MADCTL_ROTATION_3 = 0xA0;
+
+// The 170-pixel side sits 35 rows into the controller's 240-row memory
+const uint16_t ROW_GAP = 35;
+
+struct InitCommand {
+    uint8_t cmd;
+    uint8_t len;
+    uint8_t delayMs;
+    uint8_t params[14];
+};
+
+// Power, porch, voltage and gamma settings from the LilyGO T-Display S3
+// reference init, RGB565 pixels
+const InitCommand INIT_SEQUENCE[] = {
+    {CMD_SWRESET, 0, 120, {0}},
+    {CMD_SLPOUT, 0, 120, {0}},
+    {0x3A, 1, 0, {0x05}},
+    {0xB2, 5, 0, {0x0B, 0x0B, 0x00, 0x33, 0x33}},
+    {0xB7, 1, 0, {0x75}},
+    {0xBB, 1, 0, {0x28}},
+    {0xC0, 1, 0, {0x2C}},
+    {0xC2, 1, 0, {0x01}},
+    {0xC3, 1, 0, {0x1F}},
+    {0xC6, 1, 0, {0x13}},
+    {0xD0, 1, 0, {0xA7}},
+    {0xD0, 2, 0, {0xA4, 0xA1}},
+    {0xD6, 1, 0, {0xA1}},
+    {0xE0, 14, 0, {0xF0, 0x05, 0x0A, 0x06, 0x06, 0x03, 0x2B, 0x32, 0x43, 0x36, 0x11, 0x10, 0x2B, 0x32}},
+    {0xE1, 14, 0, {0xF0, 0x08, 0x0C, 0x0B, 0x09, 0x24, 0x2B, 0x22, 0x43, 0x38, 0x15, 0x16, 0x2F, 0x37}},
+    {CMD_INVON, 0, 0, {0}},
+};
+
+// Black rows for clear(); in RAM so the bus DMA can read them
+const uint16_t CLEAR_ROWS = 10;
+uint16_t clearRows[St7789Display::WIDTH * CLEAR_ROWS];
+
+} // namespace
+
+bool St7789Display::begin(uint8_t rot) {
+    for (size_t i = 0; i < sizeof(INIT_SEQUENCE) / sizeof(INIT_SEQUENCE[0]); i++) {
+        const InitCommand& c = INIT_SEQUENCE[i];
+        if (!io.sendCommand(c.cmd, c.len ? c.params : nullptr, c.len)) return false;
+        if (c.delayMs) io.delayMs(c.delayMs);
+    }
+    // Clear before switching on so the first frame never shows stale RAM
+    if (!setRotation(rot) || !clear()) return false;
+    return io.sendCommand(CMD_DISPON, nullptr, 0);
+}
+
+bool St7789Display::setRotation(uint8_t rot) {
+    rotation = rot;
+    uint8_t madctl = (rot == 1) ? MADCTL_ROTATION_1 : MADCTL_ROTATION_3;
+    return io.sendCommand(CMD_MADCTL, &madctl, 1);
+}
+
+// Queued as one RAMWR and continuation writes of the same black rows; the
+// trailing NOP waits for them, so no done callback is left pending
+bool St7789Display::clear() {
+    if (!setWindow(0, 0, WIDTH - 1, HEIGHT - 1)) return false;
+    for (uint16_t row = 0; row < HEIGHT; row += CLEAR_ROWS) {
+        uint16_t rows = (HEIGHT - row < CLEAR_ROWS) ? HEIGHT - row : CLEAR_ROWS;
+        uint8_t cmd = (row == 0) ? CMD_RAMWR : CMD_RAMWRC;
+        if (!io.sendColor(cmd, clearRows, (size_t)rows * WIDTH * sizeof(uint16_t))) return false;
+    }
+    return io.sendCommand(CMD_NOP, nullptr, 0);
+}
+
+bool St7789Display::sleep() {
+    if (!io.sendCommand(CMD_DISPOFF, nullptr, 0)) return false;
+    io.delayMs(20);
+    bool ok = io.sendCommand(CMD_SLPIN, nullptr, 0);
+    io.delayMs(120);
+    return ok;
+}
+
+bool St7789Display::draw(int16_t x1, int16_t y1, int16_t x2, int16_t y2, const uint16_t* pixels) {
+    if (x1 < 0 || y1 < 0 || x2 >= WIDTH || y2 >= HEIGHT || x2 < x1 || y2 < y1) return false;
+    if (!setWindow(x1, y1, x2, y2)) return false;
+    size_t bytes = (size_t)(x2 - x1 + 1) * (y2 - y1 + 1) * sizeof(uint16_t);
+    return io.sendColor(CMD_RAMWR, pixels, bytes);
+}
+
+bool St7789Display::setWindow(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    uint16_t top = y1 + ROW_GAP;
+    uint16_t bottom = y2 + ROW_GAP;
+    uint8_t cols[4] = {(uint8_t)(x1 >> 8), (uint8_t)x1, (uint8_t)(x2 >> 8), (uint8_t)x2};
+    uint8_t rows[4] = {(uint8_t)(top >> 8), (uint8_t)top, (uint8_t)(bottom >> 8), (uint8_t)bottom};
+    return io.sendCommand(CMD_CASET, cols, 4) && io.sendCommand(CMD_RASET, rows, 4);
+}
+
+#ifdef ESP_PLATFORM
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+bool EspLcdI80Io::begin(const I80Pins& pins, uint32_t pclkHz, size_t maxTransferBytes) {
+    // RD is never used; RST gets one hardware reset pulse
+    gpio_set_direction((gpio_num_t)pins.rd, GPIO_MODE_OUTPUT);
+    gpio_set_level((gpio_num_t)pins.rd, 1);
+    if (pins.rst >= 0) {
+        gpio_set_direction((gpio_num_t)pins.rst, GPIO_MODE_OUTPUT);
+        gpio_set_level((gpio_num_t)pins.rst, 0);
+        delayMs(10);
+        gpio_set_level((gpio_num_t)pins.rst, 1);
+        delayMs(120);
+    }
+
+    esp_lcd_i80_bus_config_t bus_config;
+    memset(&bus_config, 0, sizeof(bus_config));
+    bus_config.dc_gpio_num = pins.dc;
+    bus_config.wr_gpio_num = pins.wr;
+    bus_config.clk_src = LCD_CLK_SRC_PLL160M;
+    for (uint8_t i = 0; i < 8; i++) bus_config.data_gpio_nums[i] = pins.data[i];
+    bus_config.bus_width = 8;
+    bus_config.max_transfer_bytes = maxTransferBytes;
+    if (esp_lcd_new_i80_bus(&bus_config, &bus) != ESP_OK) return false;
+
+    esp_lcd_panel_io_i80_config_t io_config;
+    memset(&io_config, 0, sizeof(io_config));
+    io_config.cs_gpio_num = pins.cs;
+    io_config.pclk_hz = pclkHz;
+    io_config.trans_queue_depth = 10;
+    io_config.on_color_trans_done = transferDone;
+    io_config.user_ctx = this;
+    io_config.lcd_cmd_bits = 8;
+    io_config.lcd_param_bits = 8;
+    io_config.dc_levels.dc_data_level = 1;
+    io_config.flags.swap_color_bytes = 1;  // RGB565 goes out high byte first
+    return esp_lcd_new_panel_io_i80(bus, &io_config, &io) == ESP_OK;
+}
+
+bool EspLcdI80Io::sendCommand(uint8_t cmd, const uint8_t* params, size_t len) {
+    return io && esp_lcd_panel_io_tx_param(io, cmd, params, len) == ESP_OK;
+}
+
+bool EspLcdI80Io::sendColor(uint8_t cmd, const void* pixels, size_t bytes) {
+    return io && esp_lcd_panel_io_tx_color(io, cmd, pixels, bytes) == ESP_OK;
+}
+
+void EspLcdI80Io::delayMs(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+bool EspLcdI80Io::transferDone(esp_lcd_panel_io_handle_t,
+                               esp_lcd_panel_io_event_data_t*, void* ctx) {
+    static_cast<EspLcdI80Io*>(ctx)->colorDone();
+    return false;  // No task woken
+}
+#endif
+
+PanelRecorder::Op* PanelRecorder::append(OpType type, uint8_t cmd) {
+    if (ops >= MAX_OPS) return nullptr;
+    Op& op = log[ops++];
+    memset(&op, 0, sizeof(op));
+    op.type = type;
+    op.cmd = cmd;
+    return &op;
+}
+
+bool PanelRecorder::sendCommand(uint8_t cmd, const uint8_t* params, size_t len) {
+    // A real bus would block here until the in-flight transfers finish
+    if (pending > 0) busy++;
+    Op* op = append(COMMAND, cmd);
+    if (op == nullptr) return false;
+    op->paramLen = (uint8_t)(len < MAX_PARAMS ? len : MAX_PARAMS);
+    if (params != nullptr) memcpy(op->params, params, op->paramLen);
+    op->value = (uint32_t)len;
+    return true;
+}
+
+bool PanelRecorder::sendColor(uint8_t cmd, const void* pixels, size_t len) {
+    Op* op = append(COLOR, cmd);
+    if (op == nullptr) return false;
+    op->value = (uint32_t)len;
+    op->pixels = pixels;
+    bytes += (uint32_t)len;
+    if (autoComplete) {
+        colorDone();
+    } else {
+        pending++;
+    }
+    return true;
+}
+
+void PanelRecorder::delayMs(uint32_t ms) {
+    Op* op = append(DELAY, 0);
+    if (op != nullptr) op->value = ms;
+}
+
+bool PanelRecorder::complete() {
+    if (pending == 0) return false;
+    pending--;
+    colorDone();
+    return true;
+}
+
+void PanelRecorder::clear() {
+    ops = 0;
+    pending = 0;
+    busy = 0;
+    bytes = 0;
+}
@@ -0,0 +1,133 @@
+#pragma once
+#ifndef DISPLAY_BACKEND_H
+#define DISPLAY_BACKEND_H
+#include <stddef.h>
+#include <stdint.h>
+
+// Command-level link to a MIPI DCS panel controller. sendColor() may return
+// while the pixels are still being sent; the done callback then fires, from
+// an interrupt on the device, once the buffer can be reused. Commands are
+// only issued after every queued color transfer has finished.
+typedef void (*PanelDoneFn)(void* ctx);
+
+class PanelIo {
+public:
+    virtual ~PanelIo() {}
+    virtual bool sendCommand(uint8_t cmd, const uint8_t* params, size_t len) = 0;
+    virtual bool sendColor(uint8_t cmd, const void* pixels, size_t bytes) = 0;
+    virtual void delayMs(uint32_t ms) = 0;
+
+    void onColorDone(PanelDoneFn fn, void* ctx) { doneFn = fn; doneCtx = ctx; }
+
+protected:
+    PanelIo() : doneFn(nullptr), doneCtx(nullptr) {}
+    void colorDone() { if (doneFn) doneFn(doneCtx); }
+
+private:
+    PanelDoneFn doneFn;
+    void* doneCtx;
+};
+
+// The T-Display S3's ST7789 (170x320, shown landscape) driven through a
+// PanelIo: init sequence, rotation, address window and pixel writes.
+// Pixels are RGB565 in CPU byte order; swapping them is left to the bus.
+class St7789Display {
+public:
+    static const uint16_t WIDTH = 320;
+    static const uint16_t HEIGHT = 170;
+
+    explicit St7789Display(PanelIo& io) : io(io), rotation(3) {}
+
+    bool begin(uint8_t rotation);
+    bool setRotation(uint8_t rotation);  // TFT_eSPI numbering, 1 or 3
+    bool clear();                        // Whole screen black
+    bool sleep();                        // Display off, then sleep in
+
+    // Queue pixels for the inclusive window; see PanelIo for completion
+    bool draw(int16_t x1, int16_t y1, int16_t x2, int16_t y2, const uint16_t* pixels);
+
+private:
+    PanelIo& io;
+    uint8_t rotation;
+
+    bool setWindow(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+};
+
+#ifdef ESP_PLATFORM
+#include "esp_lcd_panel_io.h"
+
+// Intel 8080 8-bit bus pins of the panel (-1 for an unused line)
+struct I80Pins {
+    int8_t data[8];
+    int8_t wr;
+    int8_t rd;
+    int8_t dc;
+    int8_t cs;
+    int8_t rst;
+};
+
+// esp_lcd i80 bus: DMA color transfers, bytes swapped by the LCD peripheral
+class EspLcdI80Io : public PanelIo {
+public:
+    EspLcdI80Io() : bus(nullptr), io(nullptr) {}
+    bool begin(const I80Pins& pins, uint32_t pclkHz, size_t maxTransferBytes);
+    bool sendCommand(uint8_t cmd, const uint8_t* params, size_t len) override;
+    bool sendColor(uint8_t cmd, const void* pixels, size_t bytes) override;
+    void delayMs(uint32_t ms) override;
+
+private:
+    esp_lcd_i80_bus_handle_t bus;
+    esp_lcd_panel_io_handle_t io;
+
+    static bool transferDone(esp_lcd_panel_io_handle_t panel,
+                             esp_lcd_panel_io_event_data_t* event, void* ctx);
+};
+#endif
+
+// Stand-in panel for host-side checks: records every command, color write
+// and delay instead of driving a bus. Color transfers stay in flight until
+// complete() unless autoComplete is set.
+class PanelRecorder : public PanelIo {
+public:
+    static const uint16_t MAX_OPS = 64;
+    static const uint8_t MAX_PARAMS = 16;
+
+    enum OpType : uint8_t { COMMAND, COLOR, DELAY };
+
+    struct Op {
+        OpType type;
+        uint8_t cmd;
+        uint8_t paramLen;
+        uint8_t params[MAX_PARAMS];  // First MAX_PARAMS bytes only
+        uint32_t value;              // COLOR: bytes, DELAY: ms
+        const void* pixels;
+    };
+
+    PanelRecorder() : autoComplete(true) { clear(); }
+
+    bool sendCommand(uint8_t cmd, const uint8_t* params, size_t len) override;
+    bool sendColor(uint8_t cmd, const void* pixels, size_t bytes) override;
+    void delayMs(uint32_t ms) override;
+
+    bool complete();  // Finish the oldest in-flight color transfer
+    void clear();
+
+    uint16_t count() const { return ops; }
+    const Op& op(uint16_t i) const { return log[i]; }
+    uint16_t inFlight() const { return pending; }
+    uint16_t busyCommands() const { return busy; }  // Sent while a transfer was in flight
+    uint32_t colorBytes() const { return bytes; }
+
+    bool autoComplete;
+
+private:
+    Op log[MAX_OPS];
+    uint16_t ops;
+    uint16_t pending;
+    uint16_t busy;
+    uint32_t bytes;
+
+    Op* append(OpType type, uint8_t cmd);
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include "flash_device.h"
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+bool EspPartitionFlash::begin(const char* label) {
+    part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    return part != nullptr;
+}
+
+uint32_t EspPartitionFlash::size() const {
+    return part ? part->size : 0;
+}
+
+bool EspPartitionFlash::read(uint32_t addr, void* dst, size_t len) {
+    return part && esp_partition_read(part, addr, dst, len) == ESP_OK;
+}
+
+bool EspPartitionFlash::write(uint32_t addr, const void* src, size_t len) {
+    return part && esp_partition_write(part, addr, src, len) == ESP_OK;
+}
+
+bool EspPartitionFlash::erase(uint32_t sectorAddr) {
+    return part && esp_partition_erase_range(part, sectorAddr, SECTOR_SIZE) == ESP_OK;
+}
+#endif
+
+namespace {
+
+// Typical SPI NOR timings (W25Q128 class part on an 80 MHz QIO bus)
+const uint32_t READ_OP_NS = 2000;
+const uint32_t READ_BYTE_NS = 25;
+const uint32_t PROGRAM_OP_NS = 10000;
+const uint32_t PROGRAM_BYTE_NS = 2700;  // ~0.7 ms per 256-byte page
+const uint32_t ERASE_NS = 45000000;
+
+} // namespace
+
+SimFlash::SimFlash(uint8_t* storage, uint32_t size)
+  : mem(storage),
+    bytes(size),
+    cutArmed(false),
+    powerLost(false),
+    cutCountdown(0),
+    cutKeep(0)
+{
+    eraseAll();
+    resetCounters();
+}
+
+void SimFlash::eraseAll() {
+    memset(mem, 0xFF, bytes);
+    memset(erasesPerSector, 0, sizeof(erasesPerSector));
+}
+
+void SimFlash::resetCounters() {
+    memset(&count, 0, sizeof(count));
+}
+
+void SimFlash::cutPowerAt(uint32_t writesAhead, size_t keepBytes) {
+    cutArmed = true;
+    cutCountdown = writesAhead;
+    cutKeep = keepBytes;
+}
+
+void SimFlash::powerOn() {
+    cutArmed = false;
+    powerLost = false;
+}
+
+bool SimFlash::read(uint32_t addr, void* dst, size_t len) {
+    if (addr + len > bytes) return false;
+    memcpy(dst, mem + addr, len);
+    count.reads++;
+    count.bytesRead += len;
+    count.busyNs += READ_OP_NS + (uint64_t)READ_BYTE_NS * len;
+    return true;
+}
+
+bool SimFlash::write(uint32_t addr, const void* src, size_t len) {
+    if (addr + len > bytes || powerLost) return false;
+    size_t n = len;
+    if (cutArmed) {
+        if (cutCountdown == 0) {
+            n = (cutKeep < len) ? cutKeep : len;
+            cutArmed = false;
+            powerLost = true;
+        } else {
+            cutCountdown--;
+        }
+    }
+    const uint8_t* p = static_cast<const uint8_t*>(src);
+    for (size_t i = 0; i < n; i++) mem[addr + i] &= p[i];  // NOR: bits only clear
+    count.programs++;
+    count.bytesProgrammed += n;
+    count.busyNs += PROGRAM_OP_NS + (uint64_t)PROGRAM_BYTE_NS * n;
+    return n == len;
+}
+
+bool SimFlash::erase(uint32_t sectorAddr) {
+    if (sectorAddr % SECTOR_SIZE != 0 || sectorAddr + SECTOR_SIZE > bytes || powerLost) return false;
+    memset(mem + sectorAddr, 0xFF, SECTOR_SIZE);
+    uint32_t sector = sectorAddr / SECTOR_SIZE;
+    if (sector < MAX_SECTORS) erasesPerSector[sector]++;
+    count.erases++;
+    count.busyNs += ERASE_NS;
+    return true;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#ifndef FLASH_DEVICE_H
+#define FLASH_DEVICE_H
+#include <stddef.h>
+#include <stdint.h>
+
+// Raw NOR flash region with sector erase. Programming can only clear bits
+// (1 -> 0); erase() sets a whole sector back to 0xFF. Addresses are
+// relative to the start of the region.
+class FlashDevice {
+public:
+    static const uint32_t SECTOR_SIZE = 4096;
+
+    virtual ~FlashDevice() {}
+    virtual uint32_t size() const = 0;
+    virtual bool read(uint32_t addr, void* dst, size_t len) = 0;
+    virtual bool write(uint32_t addr, const void* src, size_t len) = 0;
+    virtual bool erase(uint32_t sectorAddr) = 0;  // One SECTOR_SIZE sector
+};
+
+#ifdef ESP_PLATFORM
+#include "esp_partition.h"
+
+// Data partition from the partition table, found by label
+class EspPartitionFlash : public FlashDevice {
+public:
+    EspPartitionFlash() : part(nullptr) {}
+    bool begin(const char* label);
+    uint32_t size() const override;
+    bool read(uint32_t addr, void* dst, size_t len) override;
+    bool write(uint32_t addr, const void* src, size_t len) override;
+    bool erase(uint32_t sectorAddr) override;
+
+private:
+    const esp_partition_t* part;
+};
+#endif
+
+// RAM-backed flash with NOR semantics for host-side simulation.
+// Counts operations and accumulates a simulated busy time from typical
+// SPI NOR figures (QIO read, ~0.7 ms page program, ~45 ms sector erase),
+// and can cut the power partway through a program to test recovery.
+class SimFlash : public FlashDevice {
+public:
+    static const uint16_t MAX_SECTORS = 256;
+
+    struct Counters {
+        uint32_t reads;
+        uint32_t bytesRead;
+        uint32_t programs;
+        uint32_t bytesProgrammed;
+        uint32_t erases;
+        uint64_t busyNs;  // Simulated device time
+    };
+
+    // storage must hold `size` bytes (a multiple of SECTOR_SIZE)
+    SimFlash(uint8_t* storage, uint32_t size);
+
+    uint32_t size() const override { return bytes; }
+    bool read(uint32_t addr, void* dst, size_t len) override;
+    bool write(uint32_t addr, const void* src, size_t len) override;
+    bool erase(uint32_t sectorAddr) override;
+
+    void eraseAll();                            // Factory-fresh, not counted
+
+    // Power fails during the program `writesAhead` programs from now (0 is
+    // the next one) after keepBytes of it; every later program and erase
+    // is lost until powerOn()
+    void cutPowerAt(uint32_t writesAhead, size_t keepBytes);
+    void powerOn();
+    bool powered() const { return !powerLost; }
+    const Counters& counters() const { return count; }
+    void resetCounters();
+    uint32_t sectorErases(uint16_t sector) const { return erasesPerSector[sector]; }
+
+private:
+    uint8_t* mem;
+    uint32_t bytes;
+    Counters count;
+    uint32_t erasesPerSector[MAX_SECTORS];
+    bool cutArmed;
+    bool powerLost;
+    uint32_t cutCountdown;
+    size_t cutKeep;
+};
+
+#endif
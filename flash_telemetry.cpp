@@ -0,0 +1,101 @@
+#include "flash_telemetry.h"
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#define TELEMETRY_LOCK() portENTER_CRITICAL(&lock)
+#define TELEMETRY_UNLOCK() portEXIT_CRITICAL(&lock)
+#else
+#define TELEMETRY_LOCK() do {} while (0)
+#define TELEMETRY_UNLOCK() do {} while (0)
+#endif
+
+FlashTelemetry::FlashTelemetry() {
+    memset(base, 0, sizeof(base));
+    memset(boot, 0, sizeof(boot));
+    memset(totalUs, 0, sizeof(totalUs));
+#ifdef ESP_PLATFORM
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    lock = unlocked;
+#endif
+}
+
+void FlashTelemetry::record(FlashTarget target, uint32_t bytes, uint32_t erases, uint32_t us) {
+    uint8_t t = (uint8_t)target;
+    if (t >= FLASH_TARGET_COUNT) return;
+    TELEMETRY_LOCK();
+    FlashCounters& c = boot[t];
+    c.writes++;
+    c.bytes += bytes;
+    c.erases += erases;
+    if (us > c.maxUs) c.maxUs = us;
+    totalUs[t] += us;
+    TELEMETRY_UNLOCK();
+}
+
+void FlashTelemetry::recordErase(FlashTarget target) {
+    uint8_t t = (uint8_t)target;
+    if (t >= FLASH_TARGET_COUNT) return;
+    TELEMETRY_LOCK();
+    boot[t].erases++;
+    TELEMETRY_UNLOCK();
+}
+
+FlashCounters FlashTelemetry::sinceBoot(FlashTarget target) const {
+    uint8_t t = (uint8_t)target;
+    TELEMETRY_LOCK();
+    FlashCounters c = boot[t];
+    TELEMETRY_UNLOCK();
+    return c;
+}
+
+// Caller holds the lock
+FlashCounters FlashTelemetry::lifetimeLocked(uint8_t t) const {
+    FlashCounters c = base[t];
+    c.writes += boot[t].writes;
+    c.bytes += boot[t].bytes;
+    c.erases += boot[t].erases;
+    if (boot[t].maxUs > c.maxUs) c.maxUs = boot[t].maxUs;
+    return c;
+}
+
+FlashCounters FlashTelemetry::lifetime(FlashTarget target) const {
+    TELEMETRY_LOCK();
+    FlashCounters c = lifetimeLocked((uint8_t)target);
+    TELEMETRY_UNLOCK();
+    return c;
+}
+
+uint32_t FlashTelemetry::averageUs(FlashTarget target) const {
+    uint8_t t = (uint8_t)target;
+    TELEMETRY_LOCK();
+    uint32_t writes = boot[t].writes;
+    uint64_t total = totalUs[t];
+    TELEMETRY_UNLOCK();
+    return writes ? (uint32_t)(total / writes) : 0;
+}
+
+const char* FlashTelemetry::name(FlashTarget target) {
+    switch (target) {
+        case FlashTarget::STATE_SLOTS: return "state";
+        case FlashTarget::STATE_NVS:   return "state-nvs";
+        case FlashTarget::JOURNAL:     return "journal";
+        default:                       return "?";
+    }
+}
+
+void FlashTelemetry::save(Snapshot& out) const {
+    TELEMETRY_LOCK();
+    for (uint8_t t = 0; t < FLASH_TARGET_COUNT; t++) out.lifetime[t] = lifetimeLocked(t);
+    TELEMETRY_UNLOCK();
+}
+
+void FlashTelemetry::restore(const Snapshot& in) {
+    TELEMETRY_LOCK();
+    memcpy(base, in.lifetime, sizeof(base));
+    TELEMETRY_UNLOCK();
+}
+
+FlashTelemetry& flashTelemetry() {
+    static FlashTelemetry telemetry;
+    return telemetry;
+}
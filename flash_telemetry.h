@@ -0,0 +1,67 @@
+#pragma once
+#ifndef FLASH_TELEMETRY_H
+#define FLASH_TELEMETRY_H
+#include <stdint.h>
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#endif
+
+// Counts what the persistence code writes to flash and how long it takes.
+//
+// Every write path reports to record(): the state record (A/B slots or
+// the NVS blob) and the session journal. Counters since boot are kept in
+// RAM; lifetime counters ride along in the state record, so they cost no
+// extra flash writes and lag the real values by at most one save.
+//
+// The state writer task records from core 0 while the loop saves and
+// prints from core 1, so every access takes a spinlock on the device.
+enum class FlashTarget : uint8_t {
+    STATE_SLOTS,
+    STATE_NVS,
+    JOURNAL,
+    TARGET_COUNT
+};
+
+const uint8_t FLASH_TARGET_COUNT = (uint8_t)FlashTarget::TARGET_COUNT;
+
+struct FlashCounters {
+    uint32_t writes;
+    uint32_t bytes;
+    uint32_t erases;  // Sector erases (not visible for NVS)
+    uint32_t maxUs;   // Worst write latency
+};
+
+class FlashTelemetry {
+public:
+    // Persisted part: lifetime totals per target
+    struct Snapshot {
+        FlashCounters lifetime[FLASH_TARGET_COUNT];
+    };
+
+    FlashTelemetry();
+
+    void record(FlashTarget target, uint32_t bytes, uint32_t erases, uint32_t us);
+    void recordErase(FlashTarget target);  // Erase done outside a write (compaction)
+
+    FlashCounters sinceBoot(FlashTarget target) const;
+    FlashCounters lifetime(FlashTarget target) const;
+    uint32_t averageUs(FlashTarget target) const;  // Since boot
+    static const char* name(FlashTarget target);
+
+    void save(Snapshot& out) const;
+    void restore(const Snapshot& in);
+
+private:
+    FlashCounters base[FLASH_TARGET_COUNT];  // Lifetime totals at boot
+    FlashCounters boot[FLASH_TARGET_COUNT];
+    uint64_t totalUs[FLASH_TARGET_COUNT];
+#ifdef ESP_PLATFORM
+    mutable portMUX_TYPE lock;
+#endif
+
+    FlashCounters lifetimeLocked(uint8_t t) const;
+};
+
+FlashTelemetry& flashTelemetry();
+
+#endif
@@ -0,0 +1,121 @@
+#include "history_codec.h"
+#include <string.h>
+
+namespace {
+
+const uint8_t TASK_LITERAL = 15;
+
+uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+size_t putVarint(uint32_t v, uint8_t* out) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+// Returns bytes read, 0 if truncated or longer than maxBytes
+size_t getVarint(const uint8_t* in, size_t len, size_t maxBytes, uint32_t& v) {
+    v = 0;
+    for (size_t i = 0; i < len && i < maxBytes; i++) {
+        v |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+        if (!(in[i] & 0x80)) return i + 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+void HistoryCodecContext::reset() {
+    prevEnd = 0;
+    memset(prevDuration, 0, sizeof(prevDuration));
+    for (uint8_t i = 0; i < DICT_SIZE; i++) dict[i] = i;
+}
+
+uint8_t HistoryCodecContext::lookup(uint8_t taskId) const {
+    for (uint8_t i = 0; i < DICT_SIZE; i++) {
+        if (dict[i] == taskId) return i;
+    }
+    return DICT_SIZE;
+}
+
+// Move (or insert) taskId to the front; an absent id drops the last entry
+void HistoryCodecContext::promote(uint8_t index, uint8_t taskId) {
+    if (index >= DICT_SIZE) index = DICT_SIZE - 1;
+    memmove(dict + 1, dict, index);
+    dict[0] = taskId;
+}
+
+void HistoryCodecContext::advance(const SessionRecord& record) {
+    prevEnd = record.startEpoch + record.durationSec + record.pausedSec;
+    uint8_t kind = (uint8_t)record.kind;
+    if (kind < 3) prevDuration[kind] = record.durationSec;
+}
+
+size_t HistoryEncoder::encode(const SessionRecord& record, uint8_t* out) {
+    uint8_t kind = (uint8_t)record.kind & 0x03;
+    uint8_t index = lookup(record.taskId);
+    uint8_t code = (index < DICT_SIZE) ? index : TASK_LITERAL;
+
+    size_t n = 0;
+    out[n++] = (uint8_t)(kind | (((uint8_t)record.outcome & 0x03) << 2) | (code << 4));
+    if (code == TASK_LITERAL) out[n++] = record.taskId;
+    n += putVarint(zigzag((int32_t)(record.startEpoch - prevEnd)), out + n);
+    n += putVarint(zigzag((int32_t)record.durationSec - (kind < 3 ? prevDuration[kind] : 0)), out + n);
+    n += putVarint(record.pausedSec, out + n);
+
+    promote(index, record.taskId);
+    advance(record);
+    return n;
+}
+
+size_t HistoryDecoder::decode(const uint8_t* in, size_t len, SessionRecord& out) {
+    if (len == 0) return 0;
+    size_t n = 0;
+    uint8_t tag = in[n++];
+    uint8_t kind = tag & 0x03;
+    uint8_t outcome = (tag >> 2) & 0x03;
+    uint8_t code = tag >> 4;
+    if (kind > (uint8_t)SessionKind::LONG_BREAK || outcome > (uint8_t)SessionOutcome::RESET) return 0;
+
+    uint8_t task;
+    if (code == TASK_LITERAL) {
+        if (n >= len) return 0;
+        task = in[n++];
+    } else {
+        task = dict[code];
+    }
+
+    uint32_t start, duration, paused;
+    size_t used;
+    if (!(used = getVarint(in + n, len - n, 5, start))) return 0;
+    n += used;
+    if (!(used = getVarint(in + n, len - n, 3, duration))) return 0;
+    n += used;
+    if (!(used = getVarint(in + n, len - n, 3, paused))) return 0;
+    n += used;
+
+    int32_t dur = (int32_t)prevDuration[kind] + unzigzag(duration);
+    if (dur < 0 || dur > 0xFFFF || paused > 0xFFFF) return 0;
+
+    out.startEpoch = prevEnd + (uint32_t)unzigzag(start);
+    out.durationSec = (uint16_t)dur;
+    out.pausedSec = (uint16_t)paused;
+    out.taskId = task;
+    out.kind = (SessionKind)kind;
+    out.outcome = (SessionOutcome)outcome;
+    out.reserved = 0;
+
+    promote(code == TASK_LITERAL ? lookup(task) : code, task);
+    advance(out);
+    return n;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#ifndef HISTORY_CODEC_H
+#define HISTORY_CODEC_H
+#include <stddef.h>
+#include <stdint.h>
+#include "session_history.h"
+
+// Compact streaming encoding of SessionRecords.
+//
+// Each record starts with a tag byte: kind (2 bits), outcome (2 bits) and
+// a task code (4 bits). Task ids go through a move-to-front dictionary, so
+// the task worked on most recently is code 0; code 15 is followed by the
+// literal id. Then come zig-zag varints of
+//   - the start time relative to the previous session's end,
+//   - the duration relative to the previous duration of the same kind,
+//   - the pause total (plain varint).
+// A typical record takes 4-5 bytes instead of 12. Encoder and decoder
+// carry the same context and must start from the same reset() point.
+class HistoryCodecContext {
+public:
+    static const uint8_t DICT_SIZE = 15;
+
+    HistoryCodecContext() { reset(); }
+    void reset();
+
+protected:
+    uint32_t prevEnd;
+    uint16_t prevDuration[3];  // Per SessionKind
+    uint8_t dict[DICT_SIZE];   // Task ids, most recent first
+
+    uint8_t lookup(uint8_t taskId) const;  // DICT_SIZE if absent
+    void promote(uint8_t index, uint8_t taskId);
+    void advance(const SessionRecord& record);
+};
+
+class HistoryEncoder : public HistoryCodecContext {
+public:
+    static const size_t MAX_RECORD_SIZE = 1 + 5 + 3 + 3 + 1;
+
+    // Append one record to out (room for MAX_RECORD_SIZE); returns bytes written
+    size_t encode(const SessionRecord& record, uint8_t* out);
+};
+
+class HistoryDecoder : public HistoryCodecContext {
+public:
+    // Decode one record; returns bytes consumed, 0 if the input is
+    // truncated or malformed
+    size_t decode(const uint8_t* in, size_t len, SessionRecord& out);
+};
+
+#endif
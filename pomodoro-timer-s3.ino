@@ -18,9 +18,15 @@
 #include <RotaryEncoder.h>
 #include "lvgl.h"
 #include "timer_core.h"
+#include "chore_wheel.h"
+#include "session_journal.h"
+#include "history_codec.h"
+#include "display_backend.h"
+#include "tick_ring.h"
 #include "esp_sleep.h"
 #include "driver/gpio.h"
 #include "esp_task_wdt.h"
+#include <time.h>
 
 LV_FONT_DECLARE(pomodoro_symbols);
 
@@ -47,6 +53,27 @@ LV_FONT_DECLARE(pomodoro_symbols);
 #define PIN_ENC_B 21
 #define PIN_ENC_BTN 16
 
+// Display backend: TFT_eSPI unless DISPLAY_ESP_LCD_I80 is defined, which
+// drives the panel through esp_lcd's i80 driver (DMA, byte swap in the LCD
+// peripheral, flush completion from the transfer-done interrupt)
+// #define DISPLAY_ESP_LCD_I80
+
+// Panel 8-bit parallel bus (used by the esp_lcd backend)
+#define PIN_LCD_D0 39
+#define PIN_LCD_D1 40
+#define PIN_LCD_D2 41
+#define PIN_LCD_D3 42
+#define PIN_LCD_D4 45
+#define PIN_LCD_D5 46
+#define PIN_LCD_D6 47
+#define PIN_LCD_D7 48
+#define PIN_LCD_WR 8
+#define PIN_LCD_RD 9
+#define PIN_LCD_DC 7
+#define PIN_LCD_CS 6
+#define PIN_LCD_RST 5
+#define LCD_PIXEL_CLOCK_HZ 6528000  // As in the LilyGO esp_lcd example
+
 // ============================================================================
 // LAYOUT CONSTANTS
 // ============================================================================
@@ -67,7 +94,16 @@ const int TASK_LIST_HEIGHT = 170;
 const int TASK_LIST_ITEM_HEIGHT = 20;
 const int TASK_LIST_PAD = 5;
 const int TASK_NUMBER_OFFSET_SINGLE = 15;  // For tasks 1-9
-const int TASK_NUMBER_OFFSET_DOUBLE = 18;  // For tasks 10+
+const int TASK_NUMBER_OFFSET_DOUBLE = 18;  // For tasks 10-99
+const int TASK_NUMBER_OFFSET_TRIPLE = 26;  // For tasks 100+
+// Rows that fit in the sidebar; the row labels are rebound to whichever
+// tasks are in view instead of creating labels per task
+const uint8_t TASK_LIST_ROWS = (TASK_LIST_HEIGHT - TASK_LIST_PAD) / TASK_LIST_ITEM_HEIGHT;
+// Tasks drawn as pomodoro clusters on the break screen
+const uint8_t TASK_CLUSTERS = 7;
+const int TREE_LAYER_WIDTH = 132;   // Background (120) plus sprites overhanging its right edge
+const int TREE_LAYER_HEIGHT = 170;
+const int TREE_ORIGIN = 3;          // main_container padding; sprite positions are in its content area
 
 
 // Tick configuration - CHANGE THESE TO CUSTOMIZE
@@ -82,6 +118,7 @@ const uint32_t TICK_MINOR_COLOR = 0x505050;  // Dim gray for minor ticks
 
 // Work display
 const int WORK_ARC_SIZE = 160;
+const int WORK_ARC_RANGE = 1000;  // Arc steps per session (smoother than whole percent)
 const int WORK_ARC_WIDTH = 12;
 const int PERCENT_CONTAINER_WIDTH = 70;
 const int PERCENT_CONTAINER_HEIGHT = 160;
@@ -101,11 +138,28 @@ const int MENU_CONTAINER_HEIGHT = 160;
 // Timing constants
 const uint32_t BATTERY_CHECK_INTERVAL_MS = 2000;
 const uint32_t ENCODER_DEBOUNCE_MS = 50;
-const uint32_t LVGL_TICK_MS = 20;
 const uint32_t DISPLAY_UPDATE_MS = 20;
 
+// Main loop scheduling (loop sleeps until a deadline or an input interrupt)
+const uint32_t INPUT_POLL_MS = 10;          // Loop period while inputs are in use
+const uint32_t INPUT_SETTLE_MS = 600;       // Keep polling after last input (covers Button2 double-click window)
+const uint32_t UI_INTERVAL_INPUT_MS = 50;   // UI refresh rate limit during interaction
+const uint32_t MAX_LOOP_SLEEP_MS = 5000;    // Upper bound so the watchdog is always fed
+const uint32_t IDLE_CHECK_INTERVAL_MS = 1000;
+const uint32_t IDLE_LOG_INTERVAL_MS = 10000;
+const uint32_t CHORE_STATS_INTERVAL_MS = 60000;
+// Boot
+const uint32_t SERIAL_SETTLE_MS = 100;      // Cold boot only, lets the USB serial monitor attach
+const uint32_t WAKE_PIN_SETTLE_MS = 2;      // Pull-ups after gpio_reset_pin() before reading buttons
+const uint8_t BOOT_PHASES_MAX = 12;
+const uint32_t JOURNAL_COMPACT_INTERVAL_MS = 15000;  // One sector erase (~45 ms) per run
+const uint32_t CONSOLE_POLL_MS = 200;       // Serial console line polling
+
+// Flash budget estimate printed by the "flash" command
+const uint32_t FLASH_ENDURANCE_CYCLES = 100000;  // Rated erase cycles per sector
+const uint32_t BUDGET_SESSIONS_PER_DAY = 40;     // 20 pomodoros and their breaks
+
 // Alert timing
-const uint32_t ALERT_BLINK_INTERVAL_MS = 400;
 const uint16_t WINDUP_START_VIBRATION_MS = 80;
 
 // Colors
@@ -138,12 +192,29 @@ const int BRIGHTNESS_VALUES[8] = {20, 40, 80, 120, 160, 200, 230, 255};
 RotaryEncoder *encoder = nullptr;
 static volatile bool encoder_changed = false;
 static bool encoder_interrupts_enabled = false;
-static bool encoder_interrupts_suspended = false;
 
-// Interrupt handler - ONLY call tick(), nothing else
+// Main loop task, woken from input interrupts
+static TaskHandle_t loop_task = nullptr;
+static volatile bool input_event_pending = false;
+
+void IRAM_ATTR notify_loop_from_isr() {
+  input_event_pending = true;
+  if (loop_task == nullptr) return;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(loop_task, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+// Interrupt handler - ONLY call tick() and wake the loop, nothing else
 void IRAM_ATTR checkPosition() {
   encoder->tick();
   encoder_changed = true;
+  notify_loop_from_isr();
+}
+
+// Button edges only wake the loop; Button2 still does the debouncing
+void IRAM_ATTR on_button_edge() {
+  notify_loop_from_isr();
 }
 
 // ============================================================================
@@ -152,28 +223,30 @@ void IRAM_ATTR checkPosition() {
 #define LVGL_LCD_BUF_SIZE (320 * 40)
 static lv_disp_draw_buf_t disp_buf;
 static lv_color_t *lv_disp_buf;
+static lv_color_t *lv_disp_buf2;  // Second band, esp_lcd backend only
 static lv_disp_drv_t disp_drv;
+static bool display_dma = false;  // Flushes queue on the esp_lcd i80 DMA
 
 // ============================================================================
 // UI Objects
 // ============================================================================
 static lv_obj_t *main_container = nullptr;
 static lv_obj_t *sidebar_container = nullptr;
-static lv_obj_t *bg_img = nullptr;
+static lv_obj_t *tree_layer = nullptr;
 static lv_obj_t *time_label = nullptr;
 static lv_obj_t *state_label = nullptr;
 static lv_obj_t *session_label = nullptr;
 static lv_obj_t *battery_label = nullptr;
 
-// Task list
+// Task list (one set of labels per visible row)
 static lv_obj_t *task_list = nullptr;
-static lv_obj_t *task_numbers[MAX_TASKS] = {nullptr};
-static lv_obj_t *task_symbols[MAX_TASKS] = {nullptr};
-static lv_obj_t *task_counts[MAX_TASKS] = {nullptr};
-static lv_obj_t *count_labels[MAX_TASKS] = {nullptr};
-static lv_obj_t *interrupt_symbols[MAX_TASKS] = {nullptr};
-static lv_obj_t *interrupt_counts[MAX_TASKS] = {nullptr};
-static uint8_t visible_tasks = 0;
+static lv_obj_t *task_numbers[TASK_LIST_ROWS] = {nullptr};
+static lv_obj_t *task_symbols[TASK_LIST_ROWS] = {nullptr};
+static lv_obj_t *count_labels[TASK_LIST_ROWS] = {nullptr};
+static lv_obj_t *interrupt_symbols[TASK_LIST_ROWS] = {nullptr};
+static lv_obj_t *interrupt_counts[TASK_LIST_ROWS] = {nullptr};
+static uint8_t visible_tasks = 0;  // Rows in use
+static uint8_t first_visible_task = 0;
 
 // Work timer
 static lv_obj_t *work_arc = nullptr;
@@ -190,7 +263,6 @@ static lv_obj_t *pomo_container = nullptr;
 static lv_obj_t *starting_container = nullptr;
 static lv_obj_t *starting_label = nullptr;
 static lv_obj_t *starting_sub_label = nullptr;
-static bool task_reset_pending = false;
 static bool wake_button2_pending = false;
 static uint32_t wake_button2_start = 0;
 
@@ -199,8 +271,15 @@ static lv_obj_t *progress_pomodoros[10] = {nullptr};
 static lv_obj_t *progress_container = nullptr;
 static const uint8_t PROGRESS_POMO_SIZE = 20;
 
-// Pomodoro images
-static lv_obj_t *pomodoro_images[MAX_TASKS][8] = {{nullptr}};
+// Tree layer: background plus pomodoro, bud and flower sprites composed
+// into one opaque canvas, so the idle screen redraws it as a single blit.
+// It is rendered over both alert backdrops at once; the flash swaps the
+// canvas between them without a re-render.
+static lv_color_t *tree_layer_bufs[2] = {nullptr};  // Normal, inverted
+static bool tree_inverted = false;
+static uint32_t tree_renders = 0;
+static uint32_t tree_render_us = 0;
+static lv_obj_t *tree_count_labels[TASK_CLUSTERS] = {nullptr};  // "n" over clusters of more than 5
 
 static const lv_img_dsc_t *theme_background = &background_theme1;
 static const lv_img_dsc_t *theme_pomodoro = &pomodoro_19_theme1;
@@ -208,9 +287,8 @@ static const lv_img_dsc_t *theme_flower = &flower_theme1;
 static const lv_img_dsc_t *theme_bud = &bud_theme1;
 
 // Arc tick marks
-static lv_obj_t *arc_ticks[60] = {nullptr};  // Support up to 60 ticks
-static lv_point_t tick_points[60][2];        // Each tick needs its own point array
-static uint8_t current_tick_count = 0;
+static lv_obj_t *arc_ticks = nullptr;        // One object draws every tick
+static TickRing tick_ring(TICK_INNER_RADIUS, TICK_OUTER_RADIUS);
 
 // idle time
 static lv_obj_t *idle_info_label = nullptr;       // For idle time warning
@@ -220,7 +298,7 @@ static lv_obj_t *summary_completed_num = nullptr; // "3" (number)
 static lv_obj_t *summary_completed_sym = nullptr; // "⚫︎" (symbol)
 static lv_obj_t *summary_interrupted_num = nullptr; // "0" (number)
 static lv_obj_t *summary_interrupted_sym = nullptr; // "⚪︎" (symbol)
-static lv_obj_t *summary_total_label = nullptr;   // "Total: 1h 15m"
+static lv_obj_t *summary_total_label = nullptr;   // "Focus: 1h 15m" or "1h 15m  3d streak"
 static lv_obj_t *summary_pomo_label = nullptr;   
 static lv_obj_t *summary_numbers_label = nullptr;
 static lv_obj_t *summary_separator = nullptr;  // Add this
@@ -238,15 +316,56 @@ static bool encoderButtonLongPressHandled = false;
 
 
 // Initialize objects
+#ifdef DISPLAY_ESP_LCD_I80
+EspLcdI80Io lcd_io;
+St7789Display lcd_panel(lcd_io);
+#else
 TFT_eSPI tft = TFT_eSPI();
+#endif
 Button2 btn1(PIN_BUTTON_1);
 Button2 btn2(PIN_BUTTON_2);
 TimerCore timer;
+EspPartitionFlash journal_flash;
+SessionJournal journal(journal_flash);
+
+// Boot timing: micros() at the end of each setup() phase, reported once
+// the first frame has been flushed
+struct BootPhase {
+  const char *name;
+  uint32_t end_us;
+};
+BootPhase boot_phases[BOOT_PHASES_MAX];
+uint8_t boot_phase_count = 0;
+bool boot_resumed = false;
+bool boot_reported = false;
+
+// Redraw cost from LVGL's monitor callback, one sample per refreshed frame,
+// kept apart for the screens that draw very differently
+enum FrameScreen : uint8_t {
+  FRAME_IDLE,   // Idle, break and paused screens
+  FRAME_WORK,   // Work arc, wind-up and starting splash
+  FRAME_MENU,
+  FRAME_SCREENS
+};
+const char *const FRAME_SCREEN_NAMES[FRAME_SCREENS] = {"idle", "work", "menu"};
+
+struct FrameStats {
+  uint32_t frames;
+  uint64_t pixels;        // Invalidated pixels over all frames
+  uint32_t max_pixels;
+  uint32_t last_pixels;
+  uint32_t render_ms;     // Render + flush time over all frames
+  uint32_t max_ms;
+  uint64_t flush_us;      // CPU time spent inside my_disp_flush()
+};
+FrameStats frame_stats[FRAME_SCREENS] = {};
+uint32_t frame_flush_us = 0;  // Flush time of the refresh in progress
 
 // Forward declarations
 void enter_deep_sleep();
 void display_sleep_message();
 void update_display();
+void request_ui_refresh(uint32_t now);
 void update_task_display();
 void handle_button1_click();
 void handle_button1_longpress();
@@ -257,27 +376,103 @@ void update_battery_display();
 void update_brightness();
 void apply_theme_assets();
 void apply_display_orientation();
-void suspend_encoder_interrupts();
-void resume_encoder_interrupts();
 void enable_encoder_interrupts();
 void disable_encoder_interrupts();
+void enable_button_interrupts();
+void disable_button_interrupts();
 void disable_scrolling(lv_obj_t *obj);
 void set_alert_colors(bool inverted);
+void show_tree_variant(bool inverted);
+void invalidate_main_view();
+void update_tree_layer();
+void set_obj_visible(lv_obj_t *obj, bool visible);
+void set_label_text(lv_obj_t *label, const char *text);
 void update_cpu_frequency();
 
+void boot_mark(const char *name) {
+  if (boot_phase_count < BOOT_PHASES_MAX) {
+    boot_phases[boot_phase_count].name = name;
+    boot_phases[boot_phase_count].end_us = micros();
+    boot_phase_count++;
+  }
+}
+
+void report_boot_phases() {
+  boot_reported = true;
+  Serial.printf("Boot phases (%s):\n", boot_resumed ? "resumed from RTC snapshot" : "cold");
+  uint32_t prev_us = 0;
+  for (uint8_t i = 0; i < boot_phase_count; i++) {
+    Serial.printf("  %-12s %7lu us\n", boot_phases[i].name,
+                  (unsigned long)(boot_phases[i].end_us - prev_us));
+    prev_us = boot_phases[i].end_us;
+  }
+  Serial.printf("  %-12s %7lu us\n", "total", (unsigned long)prev_us);
+}
+
 // Display flush callback
 static void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p) {
   uint32_t w = (area->x2 - area->x1 + 1);
   uint32_t h = (area->y2 - area->y1 + 1);
-
+  uint32_t start_us = micros();
+  bool last = lv_disp_flush_is_last(disp);  // Read before the band can complete
+
+#ifdef DISPLAY_ESP_LCD_I80
+  // Queued behind the previous band; lcd_flush_done() releases the buffer
+  // from the transfer-done interrupt
+  if (!lcd_panel.draw(area->x1, area->y1, area->x2, area->y2, (const uint16_t *)&color_p->full)) {
+    lv_disp_flush_ready(disp);
+  }
+  frame_flush_us += micros() - start_us;
+  (void)w;
+  (void)h;
+#else
+  // TFT_eSPI has no DMA on the 8-bit parallel bus; the band is sent here
   tft.startWrite();
   tft.setAddrWindow(area->x1, area->y1, w, h);
   tft.pushColors((uint16_t *)&color_p->full, w * h, true);
   tft.endWrite();
+  frame_flush_us += micros() - start_us;
 
   lv_disp_flush_ready(disp);
+#endif
+
+  if (!boot_reported && last) {
+    boot_mark("first frame");
+    report_boot_phases();
+  }
 }
 
+FrameScreen frame_screen() {
+  if (timer.getMenuState() != MenuState::CLOSED) return FRAME_MENU;
+  switch (timer.getState()) {
+    case TimerState::WORK:
+    case TimerState::WIND_UP:
+    case TimerState::STARTING:
+      return FRAME_WORK;
+    default:
+      return FRAME_IDLE;
+  }
+}
+
+static void my_disp_monitor(lv_disp_drv_t *disp, uint32_t time_ms, uint32_t px) {
+  FrameStats &stats = frame_stats[frame_screen()];
+  stats.frames++;
+  stats.pixels += px;
+  stats.last_pixels = px;
+  if (px > stats.max_pixels) stats.max_pixels = px;
+  stats.render_ms += time_ms;
+  if (time_ms > stats.max_ms) stats.max_ms = time_ms;
+  stats.flush_us += frame_flush_us;
+  frame_flush_us = 0;
+}
+
+#ifdef DISPLAY_ESP_LCD_I80
+// Transfer-done interrupt of the i80 bus
+void lcd_flush_done(void *ctx) {
+  lv_disp_flush_ready((lv_disp_drv_t *)ctx);
+}
+#endif
+
 void display_sleep_message() {
   lv_obj_clean(lv_scr_act());
   lv_obj_t *sleep_label = lv_label_create(lv_scr_act());
@@ -302,16 +497,22 @@ void dim_backlight_for_sleep() {
 
 
 void enter_deep_sleep() {
+  timer.suspend();  // Deferred saves would be lost in deep sleep; the snapshot speeds up the wake
+  disable_button_interrupts();
   dim_backlight_for_sleep();
 
   // Disable watchdog before sleep
   esp_task_wdt_delete(NULL);  // Remove current task from WDT
   esp_task_wdt_deinit();       // Deinitialize WDT completely
 
+#ifdef DISPLAY_ESP_LCD_I80
+  lcd_panel.sleep();
+#else
   tft.writecommand(0x28);
   delay(20);
   tft.writecommand(0x10);
   delay(120);
+#endif
   
   digitalWrite(PIN_LCD_BL, LOW);
   
@@ -335,36 +536,29 @@ void enter_deep_sleep() {
 }
 
 // Button handlers
+// Button 1 event per TimerState (indexed by state, in enum order)
+const TimerEvent BUTTON1_EVENTS[TIMER_STATE_COUNT] = {
+  TimerEvent::START_WORK,      // IDLE (START_WINDUP when wind-up is enabled)
+  TimerEvent::INTERRUPT,       // WORK
+  TimerEvent::CONFIRM_WINDUP,  // WIND_UP
+  TimerEvent::NONE,            // STARTING
+  TimerEvent::PAUSE,           // SHORT_BREAK
+  TimerEvent::PAUSE,           // LONG_BREAK
+  TimerEvent::RESUME,          // PAUSED_WORK
+  TimerEvent::RESUME,          // PAUSED_SHORT_BREAK
+  TimerEvent::RESUME,          // PAUSED_LONG_BREAK
+  TimerEvent::NONE,            // ALERT
+};
+
 void handle_button1_click() {
   Serial.println("\n--- Button 1 clicked ---");
   timer.resetIdleTimer();
 
-  switch (timer.getState()) {
-    case TimerState::IDLE:
-      if (timer.getWindupEnabled()) {
-        timer.startWindup();
-      } else {
-        timer.startWork();
-      }
-      break;
-    case TimerState::WIND_UP:
-      timer.startWorkFromWindup();
-      break;
-    case TimerState::STARTING:
-      break;
-    case TimerState::WORK:
-      timer.interrupt();
-      break;
-    case TimerState::SHORT_BREAK:
-    case TimerState::LONG_BREAK:
-      timer.pause();
-      break;
-    case TimerState::PAUSED_WORK:
-    case TimerState::PAUSED_SHORT_BREAK:
-    case TimerState::PAUSED_LONG_BREAK:
-      timer.resume();
-      break;
+  TimerEvent event = BUTTON1_EVENTS[(uint8_t)timer.getState()];
+  if (event == TimerEvent::START_WORK && timer.getWindupEnabled()) {
+    event = TimerEvent::START_WINDUP;
   }
+  timer.dispatch(event);
 }
 
 void handle_button1_longpress() {
@@ -386,13 +580,8 @@ void handle_button2_click() {
   Serial.println("\n--- Button 2 clicked (Reset) ---");
   timer.resetIdleTimer();
   
-  if (timer.getState() == TimerState::WIND_UP) {
-    timer.cancelWindup();
-    Serial.println("Reset complete");
-    return;
-  }
-  
-  timer.reset();
+  timer.dispatch(timer.getState() == TimerState::WIND_UP ? TimerEvent::CANCEL_WINDUP
+                                                         : TimerEvent::RESET);
   Serial.println("Reset complete");
 }
 
@@ -400,36 +589,29 @@ void handle_button2_longpress() {
   Serial.println("Long press Button 2 - Reset save state");
   timer.resetIdleTimer();
   timer.resetSaveState();
-
-  task_reset_pending = true;
 }
 
 
 void update_battery_display() {
-  static uint32_t last_voltage_check = 0;
-  
-  if (millis() - last_voltage_check > BATTERY_CHECK_INTERVAL_MS) {
-    current_battery_voltage = analogRead(PIN_BAT_VOLT) * 3.3 / 4095.0 * 2.0;
-    last_voltage_check = millis();
+  current_battery_voltage = analogRead(PIN_BAT_VOLT) * 3.3 / 4095.0 * 2.0;
+
+  if (battery_label != nullptr) {
+    char voltage_str[16];
     
-    if (battery_label != nullptr) {
-      char voltage_str[16];
+    if (current_battery_voltage > 5.0) {
+      snprintf(voltage_str, sizeof(voltage_str), "USB");
+      lv_label_set_text(battery_label, voltage_str);
+      lv_obj_set_style_text_color(battery_label, lv_color_hex(0x00AAFF), 0);
+    } else {
+      snprintf(voltage_str, sizeof(voltage_str), "%.2fV", current_battery_voltage);
+      lv_label_set_text(battery_label, voltage_str);
       
-      if (current_battery_voltage > 5.0) {
-        snprintf(voltage_str, sizeof(voltage_str), "USB");
-        lv_label_set_text(battery_label, voltage_str);
-        lv_obj_set_style_text_color(battery_label, lv_color_hex(0x00AAFF), 0);
+      if (current_battery_voltage > 3.8) {
+        lv_obj_set_style_text_color(battery_label, lv_color_hex(0x00FF00), 0);
+      } else if (current_battery_voltage > 3.4) {
+        lv_obj_set_style_text_color(battery_label, lv_color_hex(0xFFFF00), 0);
       } else {
-        snprintf(voltage_str, sizeof(voltage_str), "%.2fV", current_battery_voltage);
-        lv_label_set_text(battery_label, voltage_str);
-        
-        if (current_battery_voltage > 3.8) {
-          lv_obj_set_style_text_color(battery_label, lv_color_hex(0x00FF00), 0);
-        } else if (current_battery_voltage > 3.4) {
-          lv_obj_set_style_text_color(battery_label, lv_color_hex(0xFFFF00), 0);
-        } else {
-          lv_obj_set_style_text_color(battery_label, lv_color_hex(0xFF0000), 0);
-        }
+        lv_obj_set_style_text_color(battery_label, lv_color_hex(0xFF0000), 0);
       }
     }
   }
@@ -471,28 +653,16 @@ void apply_theme_assets() {
     theme_bud = &bud_theme1;
   }
 
-  if (bg_img != nullptr) {
-    lv_img_set_src(bg_img, theme_background);
-  }
+  update_tree_layer();
 }
 
 void apply_display_orientation() {
   uint8_t rotation = timer.getScreenFlipped() ? 1 : 3;
+#ifdef DISPLAY_ESP_LCD_I80
+  lcd_panel.setRotation(rotation);
+#else
   tft.setRotation(rotation);
-}
-
-void suspend_encoder_interrupts() {
-  if (encoder_interrupts_enabled) {
-    disable_encoder_interrupts();
-    encoder_interrupts_suspended = true;
-  }
-}
-
-void resume_encoder_interrupts() {
-  if (encoder_interrupts_suspended) {
-    enable_encoder_interrupts();
-    encoder_interrupts_suspended = false;
-  }
+#endif
 }
 
 void enable_encoder_interrupts() {
@@ -511,6 +681,25 @@ void disable_encoder_interrupts() {
   }
 }
 
+void enable_button_interrupts() {
+  attachInterrupt(digitalPinToInterrupt(PIN_BUTTON_1), on_button_edge, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(PIN_BUTTON_2), on_button_edge, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(PIN_ENC_BTN), on_button_edge, CHANGE);
+}
+
+void disable_button_interrupts() {
+  detachInterrupt(digitalPinToInterrupt(PIN_BUTTON_1));
+  detachInterrupt(digitalPinToInterrupt(PIN_BUTTON_2));
+  detachInterrupt(digitalPinToInterrupt(PIN_ENC_BTN));
+}
+
+// True while any button is held down (long-press detection needs polling)
+bool any_button_down() {
+  return digitalRead(PIN_BUTTON_1) == LOW ||
+         digitalRead(PIN_BUTTON_2) == LOW ||
+         digitalRead(PIN_ENC_BTN) == LOW;
+}
+
 
 
 void update_task_display() {
@@ -523,163 +712,104 @@ void update_task_display() {
     task_list = lv_obj_create(sidebar_container);
     lv_obj_set_size(task_list, TASK_LIST_WIDTH, TASK_LIST_HEIGHT);
     lv_obj_set_style_pad_all(task_list, TASK_LIST_PAD, 0);
-    lv_obj_set_style_pad_bottom(task_list, TASK_LIST_ITEM_HEIGHT, 0);
     lv_obj_set_style_bg_color(task_list, lv_color_hex(0x1a1a1a), 0);
     lv_obj_set_style_border_width(task_list, 0, 0);
     lv_obj_clear_flag(task_list, LV_OBJ_FLAG_CLICK_FOCUSABLE);
 
-    // Enable scrolling
-    lv_obj_add_flag(task_list, LV_OBJ_FLAG_SCROLLABLE);
-    lv_obj_set_scrollbar_mode(task_list, LV_SCROLLBAR_MODE_OFF);
+    // Rows are rebound to tasks, the list itself never scrolls
+    disable_scrolling(task_list);
 
-    for (int i = 0; i < MAX_TASKS; i++) {
-      task_numbers[i] = nullptr;
-      task_symbols[i] = nullptr;
-      task_counts[i] = nullptr;
-      count_labels[i] = nullptr;           
-      interrupt_symbols[i] = nullptr;      
-      interrupt_counts[i] = nullptr;       
+    for (int row = 0; row < TASK_LIST_ROWS; row++) {
+      task_numbers[row] = lv_label_create(task_list);
+      lv_obj_align(task_numbers[row], LV_ALIGN_TOP_LEFT, 0, row * TASK_LIST_ITEM_HEIGHT);
+      lv_obj_set_style_text_font(task_numbers[row], &lv_font_montserrat_14, 0);
 
-    }
-  }
+      task_symbols[row] = lv_label_create(task_list);
+      lv_obj_set_style_text_font(task_symbols[row], &pomodoro_symbols, 0);
 
+      count_labels[row] = lv_label_create(task_list);
+      lv_obj_set_style_text_font(count_labels[row], &lv_font_montserrat_14, 0);
+      lv_label_set_text(count_labels[row], "");
 
-  // This ensures the scroll state is clean
-  lv_obj_scroll_to_y(task_list, 0, LV_ANIM_OFF);
+      interrupt_symbols[row] = lv_label_create(task_list);
+      lv_obj_set_style_text_font(interrupt_symbols[row], &pomodoro_symbols, 0);
+      lv_label_set_text(interrupt_symbols[row], SYMBOL_INTERRUPTED_POMODORO);
 
+      interrupt_counts[row] = lv_label_create(task_list);
+      lv_obj_set_style_text_font(interrupt_counts[row], &lv_font_montserrat_14, 0);
+      lv_label_set_text(interrupt_counts[row], "");
+    }
+  }
 
   uint8_t total_tasks = timer.getTotalTasks();
   uint8_t current_task = timer.getCurrentTaskId();
 
-  // First, hide all existing task labels
-  for (int i = 0; i < MAX_TASKS; i++) {
-    if (task_numbers[i] != nullptr) {
-      if (i < total_tasks) {
-        lv_obj_clear_flag(task_numbers[i], LV_OBJ_FLAG_HIDDEN);
-      } else {
-        lv_obj_add_flag(task_numbers[i], LV_OBJ_FLAG_HIDDEN);
-      }
-    }
-    if (task_symbols[i] != nullptr) {
-      if (i < total_tasks) {
-        lv_obj_clear_flag(task_symbols[i], LV_OBJ_FLAG_HIDDEN);
-      } else {
-        lv_obj_add_flag(task_symbols[i], LV_OBJ_FLAG_HIDDEN);
-      }
-    }
-    if (task_counts[i] != nullptr) {
-      if (i < total_tasks) {
-        lv_obj_clear_flag(task_counts[i], LV_OBJ_FLAG_HIDDEN);
-      } else {
-        lv_obj_add_flag(task_counts[i], LV_OBJ_FLAG_HIDDEN);
-      }
-    }
-
-    // HIDE ALL ADDITIONAL LABELS BY DEFAULT
-    if (count_labels[i] != nullptr) {
-      lv_obj_add_flag(count_labels[i], LV_OBJ_FLAG_HIDDEN);
-    }
-    if (interrupt_symbols[i] != nullptr) {
-      lv_obj_add_flag(interrupt_symbols[i], LV_OBJ_FLAG_HIDDEN);
-    }
-    if (interrupt_counts[i] != nullptr) {
-      lv_obj_add_flag(interrupt_counts[i], LV_OBJ_FLAG_HIDDEN);
-    }
-
-
+  // Slide the window just enough to keep the current task in view
+  if (current_task < first_visible_task) {
+    first_visible_task = current_task;
+  } else if (current_task >= first_visible_task + TASK_LIST_ROWS) {
+    first_visible_task = current_task - TASK_LIST_ROWS + 1;
+  }
+  if (total_tasks <= TASK_LIST_ROWS) {
+    first_visible_task = 0;
+  } else if (first_visible_task > total_tasks - TASK_LIST_ROWS) {
+    first_visible_task = total_tasks - TASK_LIST_ROWS;
   }
 
-  for (int i = 0; i < total_tasks; i++) {
-    // Create task number label
-    if (task_numbers[i] == nullptr) {
-      task_numbers[i] = lv_label_create(task_list);
-      lv_obj_align(task_numbers[i], LV_ALIGN_TOP_LEFT, 0, i * TASK_LIST_ITEM_HEIGHT);
-      lv_obj_set_style_text_font(task_numbers[i], &lv_font_montserrat_14, 0);
-    }
+  visible_tasks = (total_tasks < TASK_LIST_ROWS) ? total_tasks : TASK_LIST_ROWS;
 
-    // Create symbols/counts labels
-    if (task_symbols[i] == nullptr) {
-      task_symbols[i] = lv_label_create(task_list);
-      lv_obj_set_style_text_font(task_symbols[i], &pomodoro_symbols, 0);
-    }
-    if (task_counts[i] == nullptr) {
-      task_counts[i] = lv_label_create(task_list);
-      lv_obj_set_style_text_font(task_counts[i], &lv_font_montserrat_14, 0);
-      lv_label_set_text(task_counts[i], "");
+  for (int row = 0; row < TASK_LIST_ROWS; row++) {
+    if (row >= visible_tasks) {
+      lv_obj_add_flag(task_numbers[row], LV_OBJ_FLAG_HIDDEN);
+      lv_obj_add_flag(task_symbols[row], LV_OBJ_FLAG_HIDDEN);
+      lv_obj_add_flag(count_labels[row], LV_OBJ_FLAG_HIDDEN);
+      lv_obj_add_flag(interrupt_symbols[row], LV_OBJ_FLAG_HIDDEN);
+      lv_obj_add_flag(interrupt_counts[row], LV_OBJ_FLAG_HIDDEN);
+      continue;
     }
 
+    int task = first_visible_task + row;
+    int y = row * TASK_LIST_ITEM_HEIGHT;
+
     // Task number
     char number_str[8];
-    snprintf(number_str, sizeof(number_str), "%d:", i + 1);
-    lv_label_set_text(task_numbers[i], number_str);
+    snprintf(number_str, sizeof(number_str), "%d:", task + 1);
+    lv_label_set_text(task_numbers[row], number_str);
+    lv_obj_clear_flag(task_numbers[row], LV_OBJ_FLAG_HIDDEN);
 
     // Position based on task number
-    int x_offset = (i + 1) < 10 ? TASK_NUMBER_OFFSET_SINGLE : TASK_NUMBER_OFFSET_DOUBLE;
+    int x_offset = (task + 1) < 10 ? TASK_NUMBER_OFFSET_SINGLE :
+                   (task + 1) < 100 ? TASK_NUMBER_OFFSET_DOUBLE : TASK_NUMBER_OFFSET_TRIPLE;
 
-    uint8_t completed = timer.getTaskCompletedPomodoros(i);
-    uint8_t interrupted = timer.getTaskInterruptedPomodoros(i);
+    uint8_t completed = timer.getTaskCompletedPomodoros(task);
+    uint8_t interrupted = timer.getTaskInterruptedPomodoros(task);
 
+    lv_color_t color = (task == current_task) ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x808080);
+    lv_obj_align(task_symbols[row], LV_ALIGN_TOP_LEFT, x_offset, y + 3);
+    lv_obj_clear_flag(task_symbols[row], LV_OBJ_FLAG_HIDDEN);
 
     if (completed + interrupted > 6) {
-      // Show counts instead of individual circles
-      lv_obj_align(task_symbols[i], LV_ALIGN_TOP_LEFT, x_offset, i * 20 + 3);
-
-      // First label: Filled circle with its count
-      char symbol_str[16] = "";
-      snprintf(symbol_str, sizeof(symbol_str), "%s", SYMBOL_COMPLETED_POMODORO);
-      lv_obj_set_style_text_font(task_symbols[i], &pomodoro_symbols, 0);
-      lv_label_set_text(task_symbols[i], symbol_str);
-      lv_obj_clear_flag(task_symbols[i], LV_OBJ_FLAG_HIDDEN);
-
-      // Second label: "xN" with regular font
-      if (count_labels[i] == nullptr) {
-        count_labels[i] = lv_label_create(task_list);
-        lv_obj_set_style_text_font(count_labels[i], &lv_font_montserrat_14, 0);
-        lv_label_set_text(count_labels[i], "");  // Initialize with empty string
-        
-      }
+      // Show counts instead of individual circles: "(filled) xN (empty) xM"
+      lv_label_set_text(task_symbols[row], SYMBOL_COMPLETED_POMODORO);
 
-      // Set the actual text content
-      char count_str[32];
+      char count_str[8];
       snprintf(count_str, sizeof(count_str), "x%d", completed);
-      lv_label_set_text(count_labels[i], count_str);
-      lv_obj_align_to(count_labels[i], task_symbols[i], LV_ALIGN_OUT_RIGHT_MID, 0, 0);
-      lv_obj_clear_flag(count_labels[i], LV_OBJ_FLAG_HIDDEN);  // Make sure it's visible
-
-      // Third label: Empty circle with pomodoro_symbols font
-      if (interrupt_symbols[i] == nullptr) {
-        interrupt_symbols[i] = lv_label_create(task_list);
-        lv_obj_set_style_text_font(interrupt_symbols[i], &pomodoro_symbols, 0);
-        lv_label_set_text(interrupt_symbols[i], "");  
-      }
+      lv_label_set_text(count_labels[row], count_str);
+      lv_obj_align_to(count_labels[row], task_symbols[row], LV_ALIGN_OUT_RIGHT_MID, 0, 0);
+      lv_obj_clear_flag(count_labels[row], LV_OBJ_FLAG_HIDDEN);
 
-      char interrupt_symbol[16] = "";
-      snprintf(interrupt_symbol, sizeof(interrupt_symbol), "%s", SYMBOL_INTERRUPTED_POMODORO);  // Removed space
-      lv_label_set_text(interrupt_symbols[i], interrupt_symbol);
-      lv_obj_align_to(interrupt_symbols[i], count_labels[i], LV_ALIGN_OUT_RIGHT_MID, 4, 0);  // Added small gap
-      lv_obj_clear_flag(interrupt_symbols[i], LV_OBJ_FLAG_HIDDEN);
-
-      // Fourth label: interrupt count with regular font
-      if (interrupt_counts[i] == nullptr) {
-        interrupt_counts[i] = lv_label_create(task_list);
-        lv_obj_set_style_text_font(interrupt_counts[i], &lv_font_montserrat_14, 0);
-        lv_label_set_text(interrupt_counts[i], "");
-      }
+      lv_obj_align_to(interrupt_symbols[row], count_labels[row], LV_ALIGN_OUT_RIGHT_MID, 4, 0);
+      lv_obj_clear_flag(interrupt_symbols[row], LV_OBJ_FLAG_HIDDEN);
 
-      char interrupt_count[32];
+      char interrupt_count[8];
       snprintf(interrupt_count, sizeof(interrupt_count), "x%d", interrupted);
-      lv_label_set_text(interrupt_counts[i], interrupt_count);
-      lv_obj_align_to(interrupt_counts[i], interrupt_symbols[i], LV_ALIGN_OUT_RIGHT_MID, 0, 0);
-      lv_obj_clear_flag(interrupt_counts[i], LV_OBJ_FLAG_HIDDEN);
-
-      lv_obj_add_flag(task_counts[i], LV_OBJ_FLAG_HIDDEN);
-
-      // Set colors for all labels
-      lv_color_t color = (i == current_task) ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x808080);
-      lv_obj_set_style_text_color(task_symbols[i], color, 0);
-      lv_obj_set_style_text_color(count_labels[i], color, 0);
-      lv_obj_set_style_text_color(interrupt_symbols[i], color, 0);
-      lv_obj_set_style_text_color(interrupt_counts[i], color, 0);
+      lv_label_set_text(interrupt_counts[row], interrupt_count);
+      lv_obj_align_to(interrupt_counts[row], interrupt_symbols[row], LV_ALIGN_OUT_RIGHT_MID, 0, 0);
+      lv_obj_clear_flag(interrupt_counts[row], LV_OBJ_FLAG_HIDDEN);
+
+      lv_obj_set_style_text_color(count_labels[row], color, 0);
+      lv_obj_set_style_text_color(interrupt_symbols[row], color, 0);
+      lv_obj_set_style_text_color(interrupt_counts[row], color, 0);
     } else {
       // Show individual circles
       char symbols_str[32] = "";
@@ -689,31 +819,16 @@ void update_task_display() {
       for (int j = 0; j < interrupted; j++) {
         strcat(symbols_str, SYMBOL_INTERRUPTED_POMODORO);
       }
+      lv_label_set_text(task_symbols[row], symbols_str);
 
-      lv_obj_align(task_symbols[i], LV_ALIGN_TOP_LEFT, x_offset, i * 20 + 3);
-      lv_label_set_text(task_symbols[i], symbols_str);
-      lv_obj_clear_flag(task_symbols[i], LV_OBJ_FLAG_HIDDEN);
-
-
-      // Hide counts label when showing individual circles
-      if (count_labels[i] != nullptr) lv_obj_add_flag(count_labels[i], LV_OBJ_FLAG_HIDDEN);
-      if (interrupt_symbols[i] != nullptr) lv_obj_add_flag(interrupt_symbols[i], LV_OBJ_FLAG_HIDDEN);
-      if (interrupt_counts[i] != nullptr) lv_obj_add_flag(interrupt_counts[i], LV_OBJ_FLAG_HIDDEN);
-      lv_obj_add_flag(task_counts[i], LV_OBJ_FLAG_HIDDEN);
+      lv_obj_add_flag(count_labels[row], LV_OBJ_FLAG_HIDDEN);
+      lv_obj_add_flag(interrupt_symbols[row], LV_OBJ_FLAG_HIDDEN);
+      lv_obj_add_flag(interrupt_counts[row], LV_OBJ_FLAG_HIDDEN);
     }
 
     // Set colors based on current task
-    lv_color_t color = (i == current_task) ? lv_color_hex(0xFFFFFF) : lv_color_hex(0x808080);
-    lv_obj_set_style_text_color(task_numbers[i], color, 0);
-    lv_obj_set_style_text_color(task_symbols[i], color, 0);
-    lv_obj_set_style_text_color(task_counts[i], color, 0);
-  }
-
-  visible_tasks = total_tasks;
-
-  // Make current task visible when scrolling needed
-  if (timer.getCurrentTaskId() * 20 > lv_obj_get_height(task_list)) {
-    lv_obj_scroll_to_y(task_list, timer.getCurrentTaskId() * 20, LV_ANIM_OFF);  // ← NO ANIMATION
+    lv_obj_set_style_text_color(task_numbers[row], color, 0);
+    lv_obj_set_style_text_color(task_symbols[row], color, 0);
   }
 }
 
@@ -753,6 +868,7 @@ void set_alert_colors(bool inverted) {
   }
   
   lv_obj_set_style_bg_color(lv_scr_act(), bg_main, 0);
+  show_tree_variant(inverted);
   
   // Set main label text colors
   if (time_label != nullptr) {
@@ -764,9 +880,10 @@ void set_alert_colors(bool inverted) {
   if (session_label != nullptr) {
     lv_obj_set_style_text_color(session_label, text_main, 0);
   }
+  invalidate_main_view();
   
   // Set sidebar task label colors
-  for (int i = 0; i < visible_tasks && i < MAX_TASKS; i++) {
+  for (int i = 0; i < visible_tasks; i++) {
     if (task_numbers[i] != nullptr && !lv_obj_has_flag(task_numbers[i], LV_OBJ_FLAG_HIDDEN)) {
       lv_obj_set_style_text_color(task_numbers[i], text_main, 0);
     }
@@ -826,80 +943,71 @@ uint8_t calculate_tick_count(uint8_t duration_minutes) {
 }
 
 
+// Draw every tick of tick_ring around the centre of the arc_ticks object
+static void arc_ticks_draw_cb(lv_event_t *e) {
+  lv_obj_t *obj = lv_event_get_target(e);
+  lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+  lv_area_t coords;
+  lv_obj_get_coords(obj, &coords);
+  lv_coord_t cx = coords.x1 + lv_area_get_width(&coords) / 2;
+  lv_coord_t cy = coords.y1 + lv_area_get_height(&coords) / 2;
+
+  lv_draw_line_dsc_t major;
+  lv_draw_line_dsc_init(&major);
+  major.width = TICK_MAJOR_WIDTH;
+  major.color = lv_color_hex(TICK_MAJOR_COLOR);
+  lv_draw_line_dsc_t minor;
+  lv_draw_line_dsc_init(&minor);
+  minor.width = TICK_MINOR_WIDTH;
+  minor.color = lv_color_hex(TICK_MINOR_COLOR);
+
+  for (uint8_t i = 0; i < tick_ring.count(); i++) {
+    const TickSegment &t = tick_ring.tick(i);
+    lv_point_t p1 = {(lv_coord_t)(cx + t.x1), (lv_coord_t)(cy + t.y1)};
+    lv_point_t p2 = {(lv_coord_t)(cx + t.x2), (lv_coord_t)(cy + t.y2)};
+    lv_draw_line(draw_ctx, t.major ? &major : &minor, &p1, &p2);
+  }
+}
+
 /**
- * Create tick marks around the arc
- * @param tick_count Number of evenly-spaced ticks to create
- * @param arc_center_x X coordinate of arc center (160 for centered 320px display)
- * @param arc_center_y Y coordinate of arc center (85 for centered 170px display)
+ * Create the tick mark widget around the arc
+ * @param arc_center_x X coordinate of arc center within main_container
+ * @param arc_center_y Y coordinate of arc center within main_container
  */
-void create_arc_ticks(uint8_t tick_count, int arc_center_x = 157, int arc_center_y = 82) {
-  if (main_container == nullptr || tick_count == 0 || tick_count > 60) return;
-  
-  Serial.printf("Creating %d arc ticks\n", tick_count);
-  
-  // Clean up existing ticks
-  for (int i = 0; i < 60; i++) {
-    if (arc_ticks[i] != nullptr) {
-      lv_obj_del(arc_ticks[i]);
-      arc_ticks[i] = nullptr;
-    }
-  }
-  
-  current_tick_count = tick_count;
-  
-  // Create new ticks
-  for (int i = 0; i < tick_count; i++) {
-    // Calculate angle (starting at 270° = top, going clockwise)
-    float angle_deg = 270.0f + (i * 360.0f / tick_count);
-    float angle_rad = angle_deg * PI / 180.0f;
-    
-    // Calculate start point (inner radius)
-    int x1 = arc_center_x + (int)(TICK_INNER_RADIUS * cos(angle_rad));
-    int y1 = arc_center_y + (int)(TICK_INNER_RADIUS * sin(angle_rad));
-    
-    // Calculate end point (outer radius)
-    int x2 = arc_center_x + (int)(TICK_OUTER_RADIUS * cos(angle_rad));
-    int y2 = arc_center_y + (int)(TICK_OUTER_RADIUS * sin(angle_rad));
-    
-    // Store points for this tick
-    tick_points[i][0].x = x1;
-    tick_points[i][0].y = y1;
-    tick_points[i][1].x = x2;
-    tick_points[i][1].y = y2;
-    
-    // Create line object
-    arc_ticks[i] = lv_line_create(main_container);
-    lv_line_set_points(arc_ticks[i], tick_points[i], 2);
-    
-    // Style: make every 5th tick more prominent
-    bool is_major = (i % 5 == 0);
-    lv_obj_set_style_line_width(arc_ticks[i], is_major ? TICK_MAJOR_WIDTH : TICK_MINOR_WIDTH, 0);
-    lv_obj_set_style_line_color(arc_ticks[i], 
-                                 lv_color_hex(is_major ? TICK_MAJOR_COLOR : TICK_MINOR_COLOR), 0);
-    
-    Serial.printf("Tick %d: angle=%.1f° pos=(%d,%d)->(%d,%d)\n", 
-                  i, angle_deg, x1, y1, x2, y2);
-  }
+void create_arc_ticks(int arc_center_x = 157, int arc_center_y = 82) {
+  if (main_container == nullptr || arc_ticks != nullptr) return;
+
+  // Odd size so the centre falls on a pixel; margin for the major width
+  const lv_coord_t size = 2 * (TICK_OUTER_RADIUS + TICK_MAJOR_WIDTH) + 1;
+  arc_ticks = lv_obj_create(main_container);
+  lv_obj_remove_style_all(arc_ticks);
+  lv_obj_set_size(arc_ticks, size, size);
+  lv_obj_set_pos(arc_ticks, arc_center_x - size / 2, arc_center_y - size / 2);
+  lv_obj_clear_flag(arc_ticks, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_clear_flag(arc_ticks, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_add_event_cb(arc_ticks, arc_ticks_draw_cb, LV_EVENT_DRAW_MAIN, nullptr);
 }
 
+// Follow the work duration setting; geometry is rebuilt only when the
+// tick count changes
+void update_arc_ticks() {
+  if (arc_ticks == nullptr) return;
+  if (tick_ring.setCount(calculate_tick_count(timer.getWorkDuration()))) {
+    Serial.printf("Arc ticks: %d\n", tick_ring.count());
+    lv_obj_invalidate(arc_ticks);
+  }
+}
 
 // show all ticks
 void show_arc_ticks() {
-  for (int i = 0; i < current_tick_count; i++) {
-    if (arc_ticks[i] != nullptr) {
-      lv_obj_clear_flag(arc_ticks[i], LV_OBJ_FLAG_HIDDEN);
-    }
-  }
+  update_arc_ticks();
+  set_obj_visible(arc_ticks, true);
 }
 
 
 // Hide all tick marks
 void hide_arc_ticks() {
-  for (int i = 0; i < current_tick_count; i++) {
-    if (arc_ticks[i] != nullptr) {
-      lv_obj_add_flag(arc_ticks[i], LV_OBJ_FLAG_HIDDEN);
-    }
-  }
+  set_obj_visible(arc_ticks, false);
 }
 
 // create UI elements for work and windup
@@ -911,6 +1019,7 @@ void create_work_ui_elements() {
   lv_obj_set_size(work_arc, WORK_ARC_SIZE, WORK_ARC_SIZE);
   lv_arc_set_bg_angles(work_arc, 0, 360);
   lv_arc_set_rotation(work_arc, 270);
+  lv_arc_set_range(work_arc, 0, WORK_ARC_RANGE);
   lv_obj_set_style_arc_color(work_arc, lv_color_hex(0x303030), LV_PART_MAIN);
   lv_obj_set_style_arc_color(work_arc, lv_color_hex(0x00E676), LV_PART_INDICATOR);
     lv_obj_set_style_arc_width(work_arc, WORK_ARC_WIDTH, LV_PART_MAIN);
@@ -977,120 +1086,125 @@ void create_work_ui_elements() {
 
   lv_obj_move_foreground(work_arc);
   
-  // Create tick marks based on work duration
-  uint8_t tick_count = calculate_tick_count(timer.getWorkDuration());
-  create_arc_ticks(tick_count);
+  // Tick marks; their count follows the work duration when shown
+  create_arc_ticks();
   
   Serial.println("Work UI elements created with tick marks");
 }
 
 
-void update_work_display() {
-  // Create UI elements if needed
-  create_work_ui_elements();
+// Pomodoro symbols of the current task, rebuilt in pomo_container
+void rebuild_pomodoro_symbols() {
+  if (pomo_container == nullptr) return;
+  lv_obj_clean(pomo_container);
+
+  uint8_t current_task = timer.getCurrentTaskId();
+  uint8_t completed = timer.getTaskCompletedPomodoros(current_task);
+  uint8_t interrupted = timer.getTaskInterruptedPomodoros(current_task);
+
+  lv_obj_t *pomodoro_label = lv_label_create(pomo_container);
+  lv_obj_set_style_text_font(pomodoro_label, &pomodoro_symbols, 0);
+  lv_obj_set_style_text_color(pomodoro_label, lv_color_hex(0xFFFFFF), 0);
+  lv_obj_set_width(pomodoro_label, lv_pct(100));  // Make label full width
+  lv_obj_set_style_text_align(pomodoro_label, LV_TEXT_ALIGN_CENTER, 0);  
+  lv_obj_align(pomodoro_label, LV_ALIGN_TOP_MID, 0, 0);  // CHANGE FROM LV_ALIGN_TOP_LEFT
 
-  // Show work display elements
-  if (work_arc != nullptr) lv_obj_clear_flag(work_arc, LV_OBJ_FLAG_HIDDEN);
-  if (percent_container != nullptr) lv_obj_clear_flag(percent_container, LV_OBJ_FLAG_HIDDEN);
-  if (time_container != nullptr) lv_obj_clear_flag(time_container, LV_OBJ_FLAG_HIDDEN);
-  if (work_percentage_label != nullptr) lv_obj_clear_flag(work_percentage_label, LV_OBJ_FLAG_HIDDEN);
-  if (work_minutes_label != nullptr) lv_obj_clear_flag(work_minutes_label, LV_OBJ_FLAG_HIDDEN);
-  if (work_seconds_label != nullptr) lv_obj_clear_flag(work_seconds_label, LV_OBJ_FLAG_HIDDEN);
-  if (percent_symbol != nullptr) lv_obj_clear_flag(percent_symbol, LV_OBJ_FLAG_HIDDEN);
-
-  // Hide standard display elements
-  if (time_label != nullptr) lv_obj_add_flag(time_label, LV_OBJ_FLAG_HIDDEN);
-  if (session_label != nullptr) lv_obj_add_flag(session_label, LV_OBJ_FLAG_HIDDEN);
-  if (state_label != nullptr) lv_obj_add_flag(state_label, LV_OBJ_FLAG_HIDDEN);
-  // HIDE all summary labels
-  if (summary_today_label != nullptr) lv_obj_add_flag(summary_today_label, LV_OBJ_FLAG_HIDDEN);
-  if (summary_completed_num != nullptr) lv_obj_add_flag(summary_completed_num, LV_OBJ_FLAG_HIDDEN);
-  if (summary_completed_sym != nullptr) lv_obj_add_flag(summary_completed_sym, LV_OBJ_FLAG_HIDDEN);
-  if (summary_separator != nullptr) lv_obj_add_flag(summary_separator, LV_OBJ_FLAG_HIDDEN);
-  if (summary_interrupted_num != nullptr) lv_obj_add_flag(summary_interrupted_num, LV_OBJ_FLAG_HIDDEN);
-  if (summary_interrupted_sym != nullptr) lv_obj_add_flag(summary_interrupted_sym, LV_OBJ_FLAG_HIDDEN);
-  if (summary_total_label != nullptr) lv_obj_add_flag(summary_total_label, LV_OBJ_FLAG_HIDDEN);
-  if (idle_info_label != nullptr) lv_obj_add_flag(idle_info_label, LV_OBJ_FLAG_HIDDEN);
-
-  show_arc_ticks();
-
-  // CONFIGURE for WORK mode
-  // Task title: "TASK" (small)
-  if (task_title_label != nullptr) {
-    lv_label_set_text(task_title_label, "TASK");
-    lv_obj_set_style_text_font(task_title_label, &lv_font_montserrat_12, 0);
-    lv_obj_set_style_text_color(task_title_label, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_align(task_title_label, LV_ALIGN_TOP_MID, 0, 15);
-    lv_obj_clear_flag(task_title_label, LV_OBJ_FLAG_HIDDEN);
+  char symbols_str[128] = "";
+  for (int i = 0; i < completed; i++) {
+    strcat(symbols_str, SYMBOL_COMPLETED_POMODORO);
+    if ((i + 1) % 4 == 0) strcat(symbols_str, "\n");
   }
-  
-  // Task number: "3" (large)
-  if (task_num_label != nullptr) {
-    char task_str[8];
-    snprintf(task_str, sizeof(task_str), "%d", timer.getCurrentTaskId() + 1);
-    lv_label_set_text(task_num_label, task_str);
-    lv_obj_set_style_text_font(task_num_label, &lv_font_montserrat_40, 0);
-    lv_obj_set_style_text_color(task_num_label, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_align(task_num_label, LV_ALIGN_CENTER, 0, -5);
-    lv_obj_clear_flag(task_num_label, LV_OBJ_FLAG_HIDDEN);
+  for (int i = 0; i < interrupted; i++) {
+    strcat(symbols_str, SYMBOL_INTERRUPTED_POMODORO);
+    if ((completed + i + 1) % 4 == 0) strcat(symbols_str, "\n");
   }
-  
-  // Update pomodoro symbols
-  if (pomo_container != nullptr) {
-    lv_obj_clean(pomo_container);
-    
-    uint8_t completed = timer.getTaskCompletedPomodoros(timer.getCurrentTaskId());
-    uint8_t interrupted = timer.getTaskInterruptedPomodoros(timer.getCurrentTaskId());
-    
-    lv_obj_t *pomodoro_label = lv_label_create(pomo_container);
-    lv_obj_set_style_text_font(pomodoro_label, &pomodoro_symbols, 0);
-    lv_obj_set_style_text_color(pomodoro_label, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_width(pomodoro_label, lv_pct(100));  // Make label full width
-    lv_obj_set_style_text_align(pomodoro_label, LV_TEXT_ALIGN_CENTER, 0);  
-    lv_obj_align(pomodoro_label, LV_ALIGN_TOP_MID, 0, 0);  // CHANGE FROM LV_ALIGN_TOP_LEFT
-    
-    char symbols_str[128] = "";
-    for (int i = 0; i < completed; i++) {
-      strcat(symbols_str, SYMBOL_COMPLETED_POMODORO);
-      if ((i + 1) % 4 == 0) strcat(symbols_str, "\n");
+
+  lv_label_set_text(pomodoro_label, symbols_str);
+}
+
+// Arc, percentage and time change every second; the layout, task labels
+// and pomodoro symbols only when `changes` says so
+void update_work_display(const ChangeSet &changes) {
+  // Create UI elements if needed
+  create_work_ui_elements();
+
+  if (changes.structural()) {
+    // Show work display elements
+    set_obj_visible(work_arc, true);
+    set_obj_visible(percent_container, true);
+    set_obj_visible(time_container, true);
+    set_obj_visible(work_percentage_label, true);
+    set_obj_visible(work_minutes_label, true);
+    set_obj_visible(work_seconds_label, true);
+    set_obj_visible(percent_symbol, true);
+
+    // Hide standard display elements
+    set_obj_visible(time_label, false);
+    set_obj_visible(session_label, false);
+    set_obj_visible(state_label, false);
+    // HIDE all summary labels
+    set_obj_visible(summary_today_label, false);
+    set_obj_visible(summary_completed_num, false);
+    set_obj_visible(summary_completed_sym, false);
+    set_obj_visible(summary_separator, false);
+    set_obj_visible(summary_interrupted_num, false);
+    set_obj_visible(summary_interrupted_sym, false);
+    set_obj_visible(summary_total_label, false);
+    set_obj_visible(idle_info_label, false);
+
+    show_arc_ticks();
+  }
+
+  if (changes.has(ChangeType::STATE) ||
+      changes.has(ChangeType::TASK) ||
+      changes.has(ChangeType::STATS)) {
+    // CONFIGURE for WORK mode
+    // Task title: "TASK" (small)
+    if (task_title_label != nullptr) {
+      lv_label_set_text(task_title_label, "TASK");
+      lv_obj_set_style_text_font(task_title_label, &lv_font_montserrat_12, 0);
+      lv_obj_set_style_text_color(task_title_label, lv_color_hex(0xFFFFFF), 0);
+      lv_obj_align(task_title_label, LV_ALIGN_TOP_MID, 0, 15);
+      set_obj_visible(task_title_label, true);
     }
-    for (int i = 0; i < interrupted; i++) {
-      strcat(symbols_str, SYMBOL_INTERRUPTED_POMODORO);
-      if ((completed + i + 1) % 4 == 0) strcat(symbols_str, "\n");
+
+    // Task number: "3" (large)
+    if (task_num_label != nullptr) {
+      char task_str[8];
+      snprintf(task_str, sizeof(task_str), "%d", timer.getCurrentTaskId() + 1);
+      lv_label_set_text(task_num_label, task_str);
+      lv_obj_set_style_text_font(task_num_label, &lv_font_montserrat_40, 0);
+      lv_obj_set_style_text_color(task_num_label, lv_color_hex(0xFFFFFF), 0);
+      lv_obj_align(task_num_label, LV_ALIGN_CENTER, 0, -5);
+      set_obj_visible(task_num_label, true);
     }
-    
-    lv_label_set_text(pomodoro_label, symbols_str);
+
+    rebuild_pomodoro_symbols();
   }
 
-  // Calculate and update progress
-  uint32_t total = timer.getWorkDuration() * 60;
-  if (total == 0) total = 1;
-  uint32_t remaining = timer.getRemainingSeconds();
-  uint32_t elapsed = (remaining <= total) ? (total - remaining) : 0;
-  int percentage = (total > 0) ? ((elapsed * 100) / total) : 0;
-  percentage = constrain(percentage, 0, 100);
+  // Progress of the actual session (wind-up sessions are shorter than workDuration)
+  uint32_t progress_q16 = timer.getProgressQ16();
+  int percentage = (progress_q16 * 100) >> 16;
   
   if (work_arc != nullptr) {
-    lv_arc_set_value(work_arc, percentage);
+    lv_arc_set_value(work_arc, (progress_q16 * WORK_ARC_RANGE) >> 16);
   }
   
   char percent_str[8];
   snprintf(percent_str, sizeof(percent_str), "%d", percentage);
-  if (work_percentage_label != nullptr) {
-    lv_label_set_text(work_percentage_label, percent_str);
-  }
+  set_label_text(work_percentage_label, percent_str);
 
   // Update time display
   if (timer.getRemainingMinutes() >= 1) {
     char min_str[4];
     snprintf(min_str, sizeof(min_str), "%lu", timer.getRemainingMinutes());
-    if (work_minutes_label != nullptr) lv_label_set_text(work_minutes_label, min_str);
-    if (work_seconds_label != nullptr) lv_label_set_text(work_seconds_label, "min");
+    set_label_text(work_minutes_label, min_str);
+    set_label_text(work_seconds_label, "min");
   } else {
     char sec_str[4];
     snprintf(sec_str, sizeof(sec_str), "%lu", timer.getRemainingSecondsInMinute());
-    if (work_minutes_label != nullptr) lv_label_set_text(work_minutes_label, sec_str);
-    if (work_seconds_label != nullptr) lv_label_set_text(work_seconds_label, "sec");
+    set_label_text(work_minutes_label, sec_str);
+    set_label_text(work_seconds_label, "sec");
   }
   
   lv_color_t progress_color = color_from_gradient(percentage);
@@ -1100,43 +1214,38 @@ void update_work_display() {
 }
 
 // Modified update_windup_display - now just configures existing elements
-void update_windup_display() {
-  static uint8_t last_task_id = 255;
-  static uint8_t last_completed = 255;
-  static uint8_t last_interrupted = 255;
+void update_windup_display(const ChangeSet &changes) {
 
   // Create UI elements if needed (don't call update_work_display!)
   create_work_ui_elements();
 
-  // Show display elements
-  if (work_arc != nullptr) {
-    lv_obj_clear_flag(work_arc, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_align(work_arc, LV_ALIGN_CENTER, 0, 0);
-  }
-  if (percent_container != nullptr) lv_obj_clear_flag(percent_container, LV_OBJ_FLAG_HIDDEN);
-  if (time_container != nullptr) lv_obj_clear_flag(time_container, LV_OBJ_FLAG_HIDDEN);
-  if (work_percentage_label != nullptr) lv_obj_clear_flag(work_percentage_label, LV_OBJ_FLAG_HIDDEN);
-  if (work_minutes_label != nullptr) lv_obj_clear_flag(work_minutes_label, LV_OBJ_FLAG_HIDDEN);
-  if (work_seconds_label != nullptr) lv_obj_clear_flag(work_seconds_label, LV_OBJ_FLAG_HIDDEN);
-  if (percent_symbol != nullptr) lv_obj_clear_flag(percent_symbol, LV_OBJ_FLAG_HIDDEN);
-
-  // Hide standard display elements
-  if (time_label != nullptr) lv_obj_add_flag(time_label, LV_OBJ_FLAG_HIDDEN);
-  if (session_label != nullptr) lv_obj_add_flag(session_label, LV_OBJ_FLAG_HIDDEN);
-  if (state_label != nullptr) lv_obj_add_flag(state_label, LV_OBJ_FLAG_HIDDEN);
-  if (bg_img != nullptr) lv_obj_add_flag(bg_img, LV_OBJ_FLAG_HIDDEN);
-  if (sidebar_container != nullptr) lv_obj_add_flag(sidebar_container, LV_OBJ_FLAG_HIDDEN);
-  // HIDE all summary labels
-  if (summary_today_label != nullptr) lv_obj_add_flag(summary_today_label, LV_OBJ_FLAG_HIDDEN);
-  if (summary_completed_num != nullptr) lv_obj_add_flag(summary_completed_num, LV_OBJ_FLAG_HIDDEN);
-  if (summary_completed_sym != nullptr) lv_obj_add_flag(summary_completed_sym, LV_OBJ_FLAG_HIDDEN);
-  if (summary_separator != nullptr) lv_obj_add_flag(summary_separator, LV_OBJ_FLAG_HIDDEN);
-  if (summary_interrupted_num != nullptr) lv_obj_add_flag(summary_interrupted_num, LV_OBJ_FLAG_HIDDEN);
-  if (summary_interrupted_sym != nullptr) lv_obj_add_flag(summary_interrupted_sym, LV_OBJ_FLAG_HIDDEN);
-  if (summary_total_label != nullptr) lv_obj_add_flag(summary_total_label, LV_OBJ_FLAG_HIDDEN);
-  if (idle_info_label != nullptr) lv_obj_add_flag(idle_info_label, LV_OBJ_FLAG_HIDDEN);
-
-  show_arc_ticks();
+  if (changes.structural()) {
+    // Show display elements
+    if (work_arc != nullptr) lv_obj_align(work_arc, LV_ALIGN_CENTER, 0, 0);
+    set_obj_visible(work_arc, true);
+    set_obj_visible(percent_container, true);
+    set_obj_visible(time_container, true);
+    set_obj_visible(work_percentage_label, true);
+    set_obj_visible(work_minutes_label, true);
+    set_obj_visible(work_seconds_label, true);
+    set_obj_visible(percent_symbol, true);
+
+    // Hide standard display elements
+    set_obj_visible(time_label, false);
+    set_obj_visible(session_label, false);
+    set_obj_visible(state_label, false);
+    // HIDE all summary labels
+    set_obj_visible(summary_today_label, false);
+    set_obj_visible(summary_completed_num, false);
+    set_obj_visible(summary_completed_sym, false);
+    set_obj_visible(summary_separator, false);
+    set_obj_visible(summary_interrupted_num, false);
+    set_obj_visible(summary_interrupted_sym, false);
+    set_obj_visible(summary_total_label, false);
+    set_obj_visible(idle_info_label, false);
+
+    show_arc_ticks();
+  }
 
 
   // Get wind-up progress
@@ -1145,7 +1254,7 @@ void update_windup_display() {
   
   // Update arc progress
   if (work_arc != nullptr) {
-    lv_arc_set_value(work_arc, percentage);
+    lv_arc_set_value(work_arc, percentage * WORK_ARC_RANGE / 100);
     lv_color_t progress_color = color_from_gradient(percentage);
     lv_obj_set_style_arc_color(work_arc, progress_color, LV_PART_INDICATOR);
   }
@@ -1153,9 +1262,7 @@ void update_windup_display() {
   // Update percentage text
   char percent_str[8];
   snprintf(percent_str, sizeof(percent_str), "%lu", percentage);
-  if (work_percentage_label != nullptr) {
-    lv_label_set_text(work_percentage_label, percent_str);
-  }
+  set_label_text(work_percentage_label, percent_str);
 
   // Update time display
   uint32_t minutes = windupSeconds / 60;
@@ -1164,301 +1271,269 @@ void update_windup_display() {
   if (minutes >= 1) {
     char min_str[4];
     snprintf(min_str, sizeof(min_str), "%lu", minutes);
-    if (work_minutes_label != nullptr) lv_label_set_text(work_minutes_label, min_str);
-    if (work_seconds_label != nullptr) lv_label_set_text(work_seconds_label, "min");
+    set_label_text(work_minutes_label, min_str);
+    set_label_text(work_seconds_label, "min");
   } else {
     char sec_str[4];
     snprintf(sec_str, sizeof(sec_str), "%lu", seconds);
-    if (work_minutes_label != nullptr) lv_label_set_text(work_minutes_label, sec_str);
-    if (work_seconds_label != nullptr) lv_label_set_text(work_seconds_label, "sec");
-  }
-  
+    set_label_text(work_minutes_label, sec_str);
+    set_label_text(work_seconds_label, "sec");
+  }
+
+  // Task labels and pomodoro symbols on entry and when stats or task change
+  if (changes.has(ChangeType::STATE) ||
+      changes.has(ChangeType::TASK) ||
+      changes.has(ChangeType::STATS)) {
+    // HIDE the large task number label (only used in work mode)
+    set_obj_visible(task_num_label, false);
+
+    // Configure task_title_label for wind-up (combined text)
+    if (task_title_label != nullptr) {
+      char title_str[32];
+      snprintf(title_str, sizeof(title_str), "WIND UP\nTASK %d", timer.getCurrentTaskId() + 1);
+      lv_label_set_text(task_title_label, title_str);
+      lv_obj_set_style_text_color(task_title_label, lv_color_hex(0x00AAFF), 0); // Blue
+      lv_obj_set_style_text_font(task_title_label, &lv_font_montserrat_14, 0);
+      lv_obj_set_style_text_align(task_title_label, LV_TEXT_ALIGN_CENTER, 0);
+      lv_obj_align(task_title_label, LV_ALIGN_TOP_MID, 0, 20);
+      set_obj_visible(task_title_label, true);
+    }
 
-  // HIDE the large task number label (only used in work mode)
-  if (task_num_label != nullptr) {
-    lv_obj_add_flag(task_num_label, LV_OBJ_FLAG_HIDDEN);
+    rebuild_pomodoro_symbols();
   }
-  
-  // Configure task_title_label for wind-up (combined text)
-  if (task_title_label != nullptr) {
-    char title_str[32];
-    snprintf(title_str, sizeof(title_str), "WIND UP\nTASK %d", timer.getCurrentTaskId() + 1);
-    lv_label_set_text(task_title_label, title_str);
-    lv_obj_set_style_text_color(task_title_label, lv_color_hex(0x00AAFF), 0); // Blue
-    lv_obj_set_style_text_font(task_title_label, &lv_font_montserrat_14, 0);
-    lv_obj_set_style_text_align(task_title_label, LV_TEXT_ALIGN_CENTER, 0);
-    lv_obj_align(task_title_label, LV_ALIGN_TOP_MID, 0, 20);
-    lv_obj_clear_flag(task_title_label, LV_OBJ_FLAG_HIDDEN);
+}
+
+
+
+// Cluster position for each task (up to 7 tasks)
+const int TREE_CLUSTER_POSITIONS[TASK_CLUSTERS][2] = {
+    {92, 77},   // Task 1
+    {15, 72},   // Task 2
+    {89, 37},   // Task 3
+    {15, 115},  // Task 4
+    {88, 119},  // Task 5
+    {20, 35},   // Task 6
+    {57, 0}     // Task 7
+};
+
+// Pomodoro offsets within each cluster
+const int TREE_POMODORO_OFFSETS[5][2] = {
+    {0, 0},     // Pomodoro 1 (center)
+    {-20, 0},   // Pomodoro 2
+    {13, -12},  // Pomodoro 3
+    {-10, -13}, // Pomodoro 4
+    {2, -24}    // Pomodoro 5
+};
+
+// Inputs of the tree layer; it is re-rendered only when one changes
+struct TreeKey {
+  const lv_img_dsc_t *background;  // Theme
+  uint8_t tasks;
+  uint8_t current_task;
+  uint8_t since_long_break;        // Seeds the bud and flower placement
+  uint8_t completed[TASK_CLUSTERS];
+};
+
+static TreeKey tree_key;
+static bool tree_key_valid = false;
+
+void create_tree_layer() {
+  tree_layer = lv_canvas_create(main_container);
+  size_t pixels = TREE_LAYER_WIDTH * TREE_LAYER_HEIGHT;
+  size_t bytes = 2 * pixels * sizeof(lv_color_t);
+  lv_color_t *buf = (lv_color_t *)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+  if (buf == nullptr) {
+    buf = (lv_color_t *)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+  }
+  if (buf == nullptr) {
+    Serial.printf("Tree layer: no memory for %u bytes\n", (unsigned)bytes);
+    return;
   }
-  
-  // Update pomodoro display only when stats or task changes
-  uint8_t current_task = timer.getCurrentTaskId();
-  uint8_t completed = timer.getTaskCompletedPomodoros(current_task);
-  uint8_t interrupted = timer.getTaskInterruptedPomodoros(current_task);
-  if (pomo_container != nullptr &&
-      (current_task != last_task_id ||
-       completed != last_completed ||
-       interrupted != last_interrupted)) {
-    lv_obj_clean(pomo_container);
-    
-    lv_obj_t *pomodoro_label = lv_label_create(pomo_container);
-    lv_obj_set_style_text_font(pomodoro_label, &pomodoro_symbols, 0);
-    lv_obj_set_style_text_color(pomodoro_label, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_width(pomodoro_label, lv_pct(100));  // Make label full width
-    lv_obj_set_style_text_align(pomodoro_label, LV_TEXT_ALIGN_CENTER, 0);  
-    lv_obj_align(pomodoro_label, LV_ALIGN_TOP_MID, 0, 0);  // CHANGE FROM LV_ALIGN_TOP_LEFT
-    
-    char symbols_str[128] = "";
-    for (int i = 0; i < completed; i++) {
-      strcat(symbols_str, SYMBOL_COMPLETED_POMODORO);
-      if ((i + 1) % 4 == 0) strcat(symbols_str, "\n");
+  tree_layer_bufs[0] = buf;
+  tree_layer_bufs[1] = buf + pixels;
+  tree_inverted = false;
+  lv_canvas_set_buffer(tree_layer, tree_layer_bufs[0], TREE_LAYER_WIDTH, TREE_LAYER_HEIGHT,
+                       LV_IMG_CF_TRUE_COLOR);
+  // Top-left of main_container, outside its padding like the sprites were
+  lv_obj_set_pos(tree_layer, -TREE_ORIGIN, -TREE_ORIGIN);
+  tree_key_valid = false;
+}
+
+// Point the canvas at the variant rendered over the given alert backdrop
+void show_tree_variant(bool inverted) {
+  if (tree_layer == nullptr || tree_layer_bufs[0] == nullptr || inverted == tree_inverted) return;
+  tree_inverted = inverted;
+  lv_canvas_set_buffer(tree_layer, tree_layer_bufs[inverted ? 1 : 0], TREE_LAYER_WIDTH,
+                       TREE_LAYER_HEIGHT, LV_IMG_CF_TRUE_COLOR);
+}
+
+// Blend one sprite; x/y in main_container content coordinates
+void draw_tree_sprite(const lv_img_dsc_t *src, lv_opa_t opa, int x, int y) {
+  lv_draw_img_dsc_t dsc;
+  lv_draw_img_dsc_init(&dsc);
+  dsc.opa = opa;
+  lv_canvas_draw_img(tree_layer, x + TREE_ORIGIN, y + TREE_ORIGIN, src, &dsc);
+}
+
+// Slots of a cluster after the completed pomodoros, shuffled from a seed
+// that only changes with the long-break cycle
+uint8_t shuffle_free_slots(uint8_t completed, uint32_t seed, int slots[5]) {
+  uint8_t count = 0;
+  for (int p = completed; p < 5; p++) {
+    slots[count++] = p;
+  }
+  for (int i = count - 1; i > 0; i--) {
+    seed = seed * 1103515245u + 12345u;
+    int j = seed % (i + 1);
+    int tmp = slots[i];
+    slots[i] = slots[j];
+    slots[j] = tmp;
+  }
+  return count;
+}
+
+// Compose the tree over one backdrop into whichever buffer the canvas has
+void render_tree_variant(uint32_t backdrop) {
+  // Background sits on the bottom-left of main_container, 5px low
+  lv_canvas_fill_bg(tree_layer, lv_color_hex(backdrop), LV_OPA_COVER);
+  lv_draw_img_dsc_t bg_dsc;
+  lv_draw_img_dsc_init(&bg_dsc);
+  lv_canvas_draw_img(tree_layer, TREE_ORIGIN,
+                     TREE_LAYER_HEIGHT - TREE_ORIGIN - theme_background->header.h + 5,
+                     theme_background, &bg_dsc);
+
+  int current_task = tree_key.current_task;
+  int next_task = current_task + 1;
+
+  for (int task = 0; task < tree_key.tasks; task++) {
+    uint8_t completed = tree_key.completed[task];
+
+    bool is_current = (task == current_task);
+    bool is_next = (task == next_task);
+    bool show_random_flower = (!is_current && !is_next && completed == 0);
+
+    int cluster_x = TREE_CLUSTER_POSITIONS[task][0];
+    int cluster_y = TREE_CLUSTER_POSITIONS[task][1];
+
+    // mirror offsets for odd tasks, pomodoros on left side
+    int mirror = (task % 2 == 1) ? -1 : 1;
+
+    if (completed > 5) {
+      // More than 5 pomodoros: 5 pomodoros, the count goes on a label
+      for (int p = 4; p >= 0; p--) {
+        draw_tree_sprite(theme_pomodoro, LV_OPA_100,
+                         cluster_x + TREE_POMODORO_OFFSETS[p][0], cluster_y + TREE_POMODORO_OFFSETS[p][1]);
+      }
+      continue;
     }
-    for (int i = 0; i < interrupted; i++) {
-      strcat(symbols_str, SYMBOL_INTERRUPTED_POMODORO);
-      if ((completed + i + 1) % 4 == 0) strcat(symbols_str, "\n");
+
+    for (int p = 0; p < completed; p++) {
+      draw_tree_sprite(theme_pomodoro, LV_OPA_100,
+                       cluster_x + mirror * TREE_POMODORO_OFFSETS[p][0], cluster_y + TREE_POMODORO_OFFSETS[p][1]);
+    }
+
+    // Current task: up to 3 random buds in the remaining slots; next task:
+    // up to 3 random flowers
+    if (is_current || is_next) {
+      int slots[5];
+      uint32_t seed = (uint32_t)(tree_key.since_long_break * 31u + task * 17u + (is_current ? current_task : next_task) * 7u);
+      uint8_t available = shuffle_free_slots(completed, seed, slots);
+      uint8_t show_count = (available > 3) ? 3 : available;
+      for (uint8_t i = 0; i < show_count; i++) {
+        int p = slots[i];
+        draw_tree_sprite(is_current ? theme_bud : theme_flower, LV_OPA_70,
+                         cluster_x + mirror * TREE_POMODORO_OFFSETS[p][0], cluster_y + TREE_POMODORO_OFFSETS[p][1]);
+      }
+    }
+
+    // Other empty tasks: single flower at a pseudo-random slot
+    if (show_random_flower) {
+      int p = (tree_key.since_long_break + task) % 5;
+      draw_tree_sprite(theme_flower, LV_OPA_70,
+                       cluster_x + mirror * TREE_POMODORO_OFFSETS[p][0], cluster_y + TREE_POMODORO_OFFSETS[p][1]);
     }
-    
-    lv_label_set_text(pomodoro_label, symbols_str);
-    last_task_id = current_task;
-    last_completed = completed;
-    last_interrupted = interrupted;
   }
 }
 
+// Render both variants, then show the one matching the alert state
+void render_tree_layer() {
+  uint32_t start_us = micros();
+  for (uint8_t v = 0; v < 2; v++) {
+    lv_canvas_set_buffer(tree_layer, tree_layer_bufs[v], TREE_LAYER_WIDTH, TREE_LAYER_HEIGHT,
+                         LV_IMG_CF_TRUE_COLOR);
+    render_tree_variant(v ? COLOR_WHITE : COLOR_BLACK);
+  }
+  lv_canvas_set_buffer(tree_layer, tree_layer_bufs[tree_inverted ? 1 : 0], TREE_LAYER_WIDTH,
+                       TREE_LAYER_HEIGHT, LV_IMG_CF_TRUE_COLOR);
+
+  tree_renders++;
+  tree_render_us = micros() - start_us;
+}
 
+// Re-render the tree layer if stats, the current task or the theme
+// changed since the last render
+void update_tree_layer() {
+  if (tree_layer == nullptr || tree_layer_bufs[0] == nullptr) return;
+
+  TreeKey key;
+  memset(&key, 0, sizeof(key));
+  uint8_t total_tasks = timer.getTotalTasks();
+  key.background = theme_background;
+  key.tasks = (total_tasks > TASK_CLUSTERS) ? TASK_CLUSTERS : total_tasks;
+  key.current_task = timer.getCurrentTaskId();
+  key.since_long_break = timer.getPomodorosSinceLastLongBreak();
+  for (uint8_t task = 0; task < key.tasks; task++) {
+    key.completed[task] = timer.getTaskCompletedPomodoros(task);
+  }
+
+  if (tree_key_valid && memcmp(&key, &tree_key, sizeof(key)) == 0) return;
+  tree_key = key;
+  tree_key_valid = true;
+  render_tree_layer();
+}
 
 void update_pomodoro_display() {
     if (main_container == nullptr) {
         return;
     }
 
-    // Define cluster positions for each task (up to 7 tasks)
-    const int cluster_positions[7][2] = {
-        {92, 77},   // Task 1
-        {15, 72},   // Task 2
-        {89, 37},   // Task 3
-        {15, 115},  // Task 4
-        {88, 119},  // Task 5
-        {20, 35},   // Task 6
-        {57, 0}    // Task 7
-    };
-    
-    // Define pomodoro offsets within each cluster
-    const int pomodoro_offsets[5][2] = {
-        {0, 0},     // Pomodoro 1 (center, drawn last - on top)
-        {-20, 0},   // Pomodoro 2
-        {13, -12},    // Pomodoro 3
-        {-10, -13},   // Pomodoro 4
-        {2, -24}    // Pomodoro 5
-    };
-
-    // Hide all pomodoro images during work mode
-    if (timer.getState() == TimerState::WORK || 
-        timer.getState() == TimerState::WIND_UP || 
-        timer.getState() == TimerState::STARTING) {
-        for (int task = 0; task < MAX_TASKS; task++) {
-            for (int p = 0; p < 8; p++) {
-                if (pomodoro_images[task][p] != nullptr) {
-                    lv_obj_add_flag(pomodoro_images[task][p], LV_OBJ_FLAG_HIDDEN);
-                }
-            }
-        }
-        return;
-    }
-
-    // First, hide all existing pomodoro images
-    for (int task = 0; task < MAX_TASKS; task++) {
-        for (int p = 0; p < 8; p++) {
-            if (pomodoro_images[task][p] != nullptr) {
-                lv_obj_add_flag(pomodoro_images[task][p], LV_OBJ_FLAG_HIDDEN);
-            }
-        }
+    // Hide the count labels during work mode; the tree layer itself is
+    // hidden with the rest of the idle screen
+    bool working = timer.getState() == TimerState::WORK ||
+                   timer.getState() == TimerState::WIND_UP ||
+                   timer.getState() == TimerState::STARTING;
+    if (!working) {
+        update_tree_layer();
     }
 
-    // Display pomodoros for each task (up to 7 tasks)
     uint8_t total_tasks = timer.getTotalTasks();
-    uint8_t max_display_tasks = (total_tasks > 7) ? 7 : total_tasks;
+    uint8_t max_display_tasks = (total_tasks > TASK_CLUSTERS) ? TASK_CLUSTERS : total_tasks;
 
-    int current_task = timer.getCurrentTaskId();
-    int next_task = current_task + 1;
-
-    for (int task = 0; task < max_display_tasks; task++) {
-        uint8_t completed = timer.getTaskCompletedPomodoros(task);
-        
-        bool is_current = (task == current_task);
-        bool is_next = (task == next_task);
-        bool show_random_flower = (!is_current && !is_next && completed == 0);
+    for (int task = 0; task < TASK_CLUSTERS; task++) {
+        uint8_t completed = (task < max_display_tasks) ? timer.getTaskCompletedPomodoros(task) : 0;
+        if (working || completed <= 5) {
+            set_obj_visible(tree_count_labels[task], false);
+            continue;
+        }
 
-        int cluster_x = cluster_positions[task][0];
-        int cluster_y = cluster_positions[task][1];
-        
-        // mirror offsets for odd tasks, pomodoros on left side 
-        bool mirror = (task % 2 == 1);  // Tasks 1, 3, 5, ... are even (0-indexed)
-
-        if (completed <= 5) {
-            // Draw individual pomodoros (reverse order so #1 is on top)
-            // for (int p = completed - 1; p >= 0; p--) { // reverse order
-            for (int p = 0; p < completed; p++) {  // forward order
-
-                // Create pomodoro image if it doesn't exist
-                if (pomodoro_images[task][p] == nullptr) {
-                    pomodoro_images[task][p] = lv_img_create(main_container);
-                }
-                lv_img_set_src(pomodoro_images[task][p], theme_pomodoro);
-                lv_obj_set_style_img_opa(pomodoro_images[task][p], LV_OPA_100, 0);
-                
-                // Calculate position: cluster center + offset (mirrored for even tasks)
-                int offset_x = pomodoro_offsets[p][0];
-                int offset_y = pomodoro_offsets[p][1];
-                
-                // Mirror x-offset for even tasks
-                if (mirror) {
-                    offset_x = -offset_x;
-                }
-
-                // Calculate position: cluster center + offset
-                int pomodoro_x = cluster_x + offset_x;
-                int pomodoro_y = cluster_y + offset_y;
-                
-                lv_obj_set_pos(pomodoro_images[task][p], pomodoro_x, pomodoro_y);
-                lv_obj_clear_flag(pomodoro_images[task][p], LV_OBJ_FLAG_HIDDEN);
-            }
-
-            // Remaining slots for current task: up to 3 random buds
-            if (is_current) {
-                int available_slots[5];
-                int available_count = 0;
-                for (int p = completed; p < 5; p++) {
-                    available_slots[available_count++] = p;
-                }
-                if (available_count > 0) {
-                    uint32_t seed = (uint32_t)(timer.getPomodorosSinceLastLongBreak() * 31u + task * 17u + current_task * 7u);
-                    for (int i = available_count - 1; i > 0; i--) {
-                        seed = seed * 1103515245u + 12345u;
-                        int j = seed % (i + 1);
-                        int tmp = available_slots[i];
-                        available_slots[i] = available_slots[j];
-                        available_slots[j] = tmp;
-                    }
-                    int show_count = (available_count > 3) ? 3 : available_count;
-                    for (int i = 0; i < show_count; i++) {
-                        int p = available_slots[i];
-                        if (pomodoro_images[task][p] == nullptr) {
-                            pomodoro_images[task][p] = lv_img_create(main_container);
-                        }
-                        lv_img_set_src(pomodoro_images[task][p], theme_bud);
-                        lv_obj_set_style_img_opa(pomodoro_images[task][p], LV_OPA_70, 0);
-
-                        int offset_x = pomodoro_offsets[p][0];
-                        int offset_y = pomodoro_offsets[p][1];
-                        if (mirror) {
-                            offset_x = -offset_x;
-                        }
-
-                        int bud_x = cluster_x + offset_x;
-                        int bud_y = cluster_y + offset_y;
-                        lv_obj_set_pos(pomodoro_images[task][p], bud_x, bud_y);
-                        lv_obj_clear_flag(pomodoro_images[task][p], LV_OBJ_FLAG_HIDDEN);
-                    }
-                }
-            }
-
-            // Next task: up to 3 random flowers for remaining slots
-            if (is_next) {
-                int available_slots[5];
-                int available_count = 0;
-                for (int p = completed; p < 5; p++) {
-                    available_slots[available_count++] = p;
-                }
-                if (available_count > 0) {
-                    uint32_t seed = (uint32_t)(timer.getPomodorosSinceLastLongBreak() * 31u + task * 17u + (current_task + 1) * 7u);
-                    for (int i = available_count - 1; i > 0; i--) {
-                        seed = seed * 1103515245u + 12345u;
-                        int j = seed % (i + 1);
-                        int tmp = available_slots[i];
-                        available_slots[i] = available_slots[j];
-                        available_slots[j] = tmp;
-                    }
-                    int show_count = (available_count > 3) ? 3 : available_count;
-                    for (int i = 0; i < show_count; i++) {
-                        int p = available_slots[i];
-                        if (pomodoro_images[task][p] == nullptr) {
-                            pomodoro_images[task][p] = lv_img_create(main_container);
-                        }
-                        lv_img_set_src(pomodoro_images[task][p], theme_flower);
-                        lv_obj_set_style_img_opa(pomodoro_images[task][p], LV_OPA_70, 0);
-
-                        int offset_x = pomodoro_offsets[p][0];
-                        int offset_y = pomodoro_offsets[p][1];
-                        if (mirror) {
-                            offset_x = -offset_x;
-                        }
-
-                        int flower_x = cluster_x + offset_x;
-                        int flower_y = cluster_y + offset_y;
-                        lv_obj_set_pos(pomodoro_images[task][p], flower_x, flower_y);
-                        lv_obj_clear_flag(pomodoro_images[task][p], LV_OBJ_FLAG_HIDDEN);
-                    }
-                }
-            }
-
-            // Other empty tasks: single flower at a pseudo-random slot
-            if (show_random_flower) {
-                int flower_slot = (timer.getPomodorosSinceLastLongBreak() + task) % 5;
-                if (pomodoro_images[task][flower_slot] == nullptr) {
-                    pomodoro_images[task][flower_slot] = lv_img_create(main_container);
-                }
-                lv_img_set_src(pomodoro_images[task][flower_slot], theme_flower);
-                lv_obj_set_style_img_opa(pomodoro_images[task][flower_slot], LV_OPA_70, 0);
-
-                int offset_x = pomodoro_offsets[flower_slot][0];
-                int offset_y = pomodoro_offsets[flower_slot][1];
-                if (mirror) {
-                    offset_x = -offset_x;
-                }
-
-                int flower_x = cluster_x + offset_x;
-                int flower_y = cluster_y + offset_y;
-                lv_obj_set_pos(pomodoro_images[task][flower_slot], flower_x, flower_y);
-                lv_obj_clear_flag(pomodoro_images[task][flower_slot], LV_OBJ_FLAG_HIDDEN);
-            }
-        } else {
-            // More than 5 pomodoros: draw 5 pomodoros + count overlay
-            
-            // Draw the 5 base pomodoros (reverse order)
-            for (int p = 4; p >= 0; p--) {
-                if (pomodoro_images[task][p] == nullptr) {
-                    pomodoro_images[task][p] = lv_img_create(main_container);
-                }
-                lv_img_set_src(pomodoro_images[task][p], theme_pomodoro);
-                lv_obj_set_style_img_opa(pomodoro_images[task][p], LV_OPA_100, 0);
-                
-                int pomodoro_x = cluster_x + pomodoro_offsets[p][0];
-                int pomodoro_y = cluster_y + pomodoro_offsets[p][1];
-                
-                lv_obj_set_pos(pomodoro_images[task][p], pomodoro_x, pomodoro_y);
-                lv_obj_clear_flag(pomodoro_images[task][p], LV_OBJ_FLAG_HIDDEN);
-            }
-            
-            // Create/update count overlay label (use slot 5 for the count label)
-            if (pomodoro_images[task][5] == nullptr) {
-                // Create label instead of image for the count
-                pomodoro_images[task][5] = lv_label_create(main_container);
-                lv_obj_set_style_text_font(pomodoro_images[task][5], &lv_font_montserrat_14, 0);
-                lv_obj_set_style_text_color(pomodoro_images[task][5], lv_color_hex(0xFFFFFF), 0);
-                lv_obj_set_style_bg_color(pomodoro_images[task][5], lv_color_hex(0x000000), 0);
-                lv_obj_set_style_bg_opa(pomodoro_images[task][5], LV_OPA_70, 0);
-                lv_obj_set_style_pad_all(pomodoro_images[task][5], 2, 0);
-                lv_obj_set_style_radius(pomodoro_images[task][5], 8, 0);
-            }
-            
-            // Set count text and position at cluster center
-            char count_str[8];
-            snprintf(count_str, sizeof(count_str), "%d", completed);
-            lv_label_set_text((lv_obj_t*)pomodoro_images[task][5], count_str);
-            lv_obj_set_pos(pomodoro_images[task][5], cluster_x - 5, cluster_y - 8); // Centered
-            lv_obj_clear_flag(pomodoro_images[task][5], LV_OBJ_FLAG_HIDDEN);
+        // Count overlay at the cluster center
+        if (tree_count_labels[task] == nullptr) {
+            tree_count_labels[task] = lv_label_create(main_container);
+            lv_obj_set_style_text_font(tree_count_labels[task], &lv_font_montserrat_14, 0);
+            lv_obj_set_style_text_color(tree_count_labels[task], lv_color_hex(0xFFFFFF), 0);
+            lv_obj_set_style_bg_color(tree_count_labels[task], lv_color_hex(0x000000), 0);
+            lv_obj_set_style_bg_opa(tree_count_labels[task], LV_OPA_70, 0);
+            lv_obj_set_style_pad_all(tree_count_labels[task], 2, 0);
+            lv_obj_set_style_radius(tree_count_labels[task], 8, 0);
+        }
+        char count_str[8];
+        snprintf(count_str, sizeof(count_str), "%d", completed);
+        if (strcmp(lv_label_get_text(tree_count_labels[task]), count_str) != 0) {
+            lv_label_set_text(tree_count_labels[task], count_str);
         }
+        lv_obj_set_pos(tree_count_labels[task], TREE_CLUSTER_POSITIONS[task][0] - 5,
+                       TREE_CLUSTER_POSITIONS[task][1] - 8);
+        set_obj_visible(tree_count_labels[task], true);
     }
 }
 
@@ -1520,32 +1595,6 @@ void update_long_break_progress() {
     }
 }
 
-// Calculate total completed pomodoros across all tasks
-uint8_t get_total_completed_pomodoros() {
-  uint8_t total = 0;
-  for (int i = 0; i < timer.getTotalTasks(); i++) {
-    total += timer.getTaskCompletedPomodoros(i);
-  }
-  return total;
-}
-
-
-// Calculate total interrupted pomodoros across all tasks
-uint8_t get_total_interrupted_pomodoros() {
-  uint8_t total = 0;
-  for (int i = 0; i < timer.getTotalTasks(); i++) {
-    total += timer.getTaskInterruptedPomodoros(i);
-  }
-  return total;
-}
-
-// Calculate total work time in minutes (completed pomodoros only)
-uint16_t get_total_work_minutes() {
-  uint8_t completed = get_total_completed_pomodoros();
-  return completed * timer.getWorkDuration();
-}
-
-
 // Format time duration into hours and minutes string
 // Examples: "1h 25m", "45m", "3h 0m"
 void format_duration(uint16_t total_minutes, char* buffer, size_t buffer_size) {
@@ -1559,16 +1608,178 @@ void format_duration(uint16_t total_minutes, char* buffer, size_t buffer_size) {
   }
 }
 
+// ============================================================================
+// MAIN VIEW MODEL - idle and break screen contents
+// ============================================================================
+// update_display() formats what the idle and break screens show into a
+// MainView every frame; apply_main_view() then only touches the labels whose
+// field differs from the view it applied last. LVGL invalidates a label on
+// every set_text, text color or clear_flag call, even when nothing changes.
+struct MainView {
+  bool show_timer;      // time_label + state_label
+  bool show_summary;    // Today's completed | interrupted counters, focus and streak
+  bool show_idle;
+  bool keep_state;      // Leave state_label as it is (alert)
+  char time[8];
+  char state[16];
+  uint32_t state_color;
+  char completed[8];
+  char interrupted[8];
+  char total[32];
+  char idle[24];
+};
+
+MainView shown_view;
+bool shown_view_valid = false;
+
+// Force the next apply_main_view() to push every field, e.g. after another
+// path recolored the labels
+void invalidate_main_view() {
+  shown_view_valid = false;
+}
 
-// Updated display function
-void update_display() {
+// Show or hide an object, skipping the redraw if it already is
+void set_obj_visible(lv_obj_t *obj, bool visible) {
+  if (obj == nullptr || lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN) != visible) return;
+  if (visible) {
+    lv_obj_clear_flag(obj, LV_OBJ_FLAG_HIDDEN);
+  } else {
+    lv_obj_add_flag(obj, LV_OBJ_FLAG_HIDDEN);
+  }
+}
 
+// Set a label's text only if it differs; LVGL redraws on every set
+void set_label_text(lv_obj_t *label, const char *text) {
+  if (label == nullptr || strcmp(lv_label_get_text(label), text) == 0) return;
+  lv_label_set_text(label, text);
+}
 
-  static uint8_t last_theme = 0;
-  static TimerState last_state = TimerState::IDLE;
-  static bool last_flipped = false;
+// Set a label's text if it differs from `shown`, which then records it
+bool apply_view_text(lv_obj_t *label, const char *text, char *shown, size_t shown_size, bool force) {
+  if (label == nullptr || (!force && strcmp(text, shown) == 0)) return false;
+  lv_label_set_text(label, text);
+  snprintf(shown, shown_size, "%s", text);
+  return true;
+}
+
+void build_main_view(MainView &view) {
+  memset(&view, 0, sizeof(view));
+  TimerState state = timer.getState();
+
+  if (state == TimerState::IDLE) {
+    // Show today's sessions instead of 00:00. The streak needs real dates,
+    // so it waits until the wall clock is set
+    const SessionStats &stats = timer.getStats();
+    const Clock &clock = timer.getClock();
+    uint32_t now = clock.epochSeconds();
+    const DayStats *today = stats.day(now);
+    if (today != nullptr && (today->completed > 0 || today->interrupted > 0)) {
+      char duration_str[16];
+      format_duration((uint16_t)(today->focusedSec / 60), duration_str, sizeof(duration_str));
+      view.show_summary = true;
+      snprintf(view.completed, sizeof(view.completed), "%d:", today->completed);
+      snprintf(view.interrupted, sizeof(view.interrupted), "%d:", today->interrupted);
+      uint16_t streak = clock.hasWallTime() ? stats.streakDays(now) : 0;
+      if (streak > 1) {
+        snprintf(view.total, sizeof(view.total), "%s  %ud streak", duration_str, streak);
+      } else {
+        snprintf(view.total, sizeof(view.total), "Focus: %s", duration_str);
+      }
+    } else {
+      view.show_timer = true;
+      snprintf(view.time, sizeof(view.time), "00:00");
+      snprintf(view.state, sizeof(view.state), "Ready to start");
+      view.state_color = 0x808080;
+    }
+
+    uint32_t idle_minutes = timer.getIdleElapsedMs() / 60000;
+    if (idle_minutes > 1) {
+      view.show_idle = true;
+      snprintf(view.idle, sizeof(view.idle), "Idle: %lumin", idle_minutes);
+    }
+    return;
+  }
+
+  view.show_timer = true;
+  snprintf(view.time, sizeof(view.time), "%02lu:%02lu",
+           timer.getRemainingMinutes(), timer.getRemainingSecondsInMinute());
+  switch (state) {
+    case TimerState::SHORT_BREAK:
+      snprintf(view.state, sizeof(view.state), "Short Break");
+      view.state_color = 0x00AAFF;
+      break;
+    case TimerState::LONG_BREAK:
+      snprintf(view.state, sizeof(view.state), "Long Break!");
+      view.state_color = 0x0055FF;
+      break;
+    case TimerState::PAUSED_SHORT_BREAK:
+    case TimerState::PAUSED_LONG_BREAK:
+      snprintf(view.state, sizeof(view.state), "Break Paused");
+      view.state_color = 0xFFAA00;
+      break;
+    case TimerState::PAUSED_WORK:
+      snprintf(view.state, sizeof(view.state), "Focus Paused");
+      view.state_color = 0xFFAA00;
+      break;
+    default:
+      view.keep_state = true;
+      break;
+  }
+}
+
+void apply_main_view(const MainView &view) {
+  bool force = !shown_view_valid;
+  MainView &shown = shown_view;
+
+  set_obj_visible(time_label, view.show_timer);
+  set_obj_visible(state_label, view.show_timer);
+  set_obj_visible(summary_today_label, view.show_summary);
+  set_obj_visible(summary_completed_num, view.show_summary);
+  set_obj_visible(summary_completed_sym, view.show_summary);
+  set_obj_visible(summary_separator, view.show_summary);
+  set_obj_visible(summary_interrupted_num, view.show_summary);
+  set_obj_visible(summary_interrupted_sym, view.show_summary);
+  set_obj_visible(summary_total_label, view.show_summary);
+  set_obj_visible(idle_info_label, view.show_idle);
+
+  if (view.show_timer) {
+    apply_view_text(time_label, view.time, shown.time, sizeof(shown.time), force);
+    if (!view.keep_state && state_label != nullptr) {
+      apply_view_text(state_label, view.state, shown.state, sizeof(shown.state), force);
+      if (force || view.state_color != shown.state_color) {
+        lv_obj_set_style_text_color(state_label, lv_color_hex(view.state_color), 0);
+        shown.state_color = view.state_color;
+      }
+    }
+  }
+
+  if (view.show_summary) {
+    // The symbols and separator are laid out after the numbers, so they only
+    // move when a number's width may have changed
+    bool completed_moved = apply_view_text(summary_completed_num, view.completed,
+                                           shown.completed, sizeof(shown.completed), force);
+    if (completed_moved) {
+      lv_obj_align_to(summary_completed_sym, summary_completed_num, LV_ALIGN_OUT_RIGHT_MID, 3, 0);
+      lv_obj_align_to(summary_separator, summary_completed_sym, LV_ALIGN_OUT_RIGHT_MID, 8, 0);
+    }
+    if (apply_view_text(summary_interrupted_num, view.interrupted, shown.interrupted,
+                        sizeof(shown.interrupted), force) || completed_moved) {
+      lv_obj_align_to(summary_interrupted_num, summary_separator, LV_ALIGN_OUT_RIGHT_MID, 8, 0);
+      lv_obj_align_to(summary_interrupted_sym, summary_interrupted_num, LV_ALIGN_OUT_RIGHT_MID, 3, 0);
+    }
+    apply_view_text(summary_total_label, view.total, shown.total, sizeof(shown.total), force);
+  }
+
+  if (view.show_idle) {
+    apply_view_text(idle_info_label, view.idle, shown.idle, sizeof(shown.idle), force);
+  }
 
+  // Text of hidden labels was not pushed and stays recorded as it was
+  shown_view_valid = true;
+}
 
+// Updated display function
+void update_display() {
   // First time setup of containers
   if (main_container == nullptr) {
     // Create main container for timer
@@ -1582,10 +1793,8 @@ void update_display() {
     // DISABLE SCROLLING ON MAIN CONTAINER:
     disable_scrolling(main_container);
 
-    // Add background image
-    bg_img = lv_img_create(main_container);
-    lv_img_set_src(bg_img, theme_background);
-    lv_obj_align(bg_img, LV_ALIGN_BOTTOM_LEFT, 0, 5);  // Center in main container
+    // Background and tomato tree, composed offscreen
+    create_tree_layer();
 
     // CREATE BATTERY LABEL (add this after main_container creation)
     battery_label = lv_label_create(lv_scr_act());  // Create on screen, not container
@@ -1619,6 +1828,7 @@ void update_display() {
     lv_obj_set_style_text_font(summary_today_label, &lv_font_montserrat_12, 0);
     lv_obj_set_style_text_color(summary_today_label, lv_color_hex(0xFFFFFF), 0);
     lv_obj_align(summary_today_label, LV_ALIGN_CENTER, 45, -10);
+    lv_label_set_text(summary_today_label, "Today:");
     lv_obj_add_flag(summary_today_label, LV_OBJ_FLAG_HIDDEN);
 
     // Completed count (number with montserrat)
@@ -1671,23 +1881,25 @@ void update_display() {
 
   }
 
+  // Coalesced TimerCore changes since the last frame; no change, no redraw
+  ChangeSet changes = timer.getChanges().drain();
+  if (!changes.any()) return;
+
   update_menu_display();
-  if (timer.getScreenFlipped() != last_flipped) {
+  if (changes.hasSetting((uint8_t)MenuItem::SCREEN_ORIENTATION)) {
     apply_display_orientation();
     lv_obj_invalidate(lv_scr_act());
-    last_flipped = timer.getScreenFlipped();
   }
-  if (timer.getTheme() != last_theme) {
+  if (changes.hasSetting((uint8_t)MenuItem::THEME)) {
     apply_theme_assets();
     update_pomodoro_display();
     update_long_break_progress();
-    last_theme = timer.getTheme();
   }
 
-  if (task_reset_pending && sidebar_container != nullptr) {
+  if ((changes.has(ChangeType::TASK) || changes.has(ChangeType::STATS)) &&
+      sidebar_container != nullptr) {
     update_task_display();
     update_pomodoro_display();
-    task_reset_pending = false;
   }
 
   if (timer.getMenuState() != MenuState::CLOSED) {
@@ -1695,7 +1907,7 @@ void update_display() {
       return;
   }
 
-  if (timer.getState() != last_state) {
+  if (changes.has(ChangeType::STATE)) {
     if (timer.getState() == TimerState::WIND_UP || timer.getState() == TimerState::STARTING) {
       update_pomodoro_display();
       update_long_break_progress();
@@ -1729,250 +1941,76 @@ void update_display() {
     if (sidebar_container != nullptr) lv_obj_add_flag(sidebar_container, LV_OBJ_FLAG_HIDDEN);
     if (progress_container != nullptr) lv_obj_add_flag(progress_container, LV_OBJ_FLAG_HIDDEN);
 
-    if (last_state != TimerState::STARTING && timer.getAlarmVibration()) {
+    if (changes.has(ChangeType::STATE) && timer.getAlarmVibration()) {
       digitalWrite(PIN_VIBRATION, HIGH);
       delay(WINDUP_START_VIBRATION_MS);
       digitalWrite(PIN_VIBRATION, LOW);
     }
-
-    last_state = TimerState::STARTING;
     return;
   }
 
   if (starting_container != nullptr) {
     lv_obj_add_flag(starting_container, LV_OBJ_FLAG_HIDDEN);
   }
-  if (main_container != nullptr) lv_obj_clear_flag(main_container, LV_OBJ_FLAG_HIDDEN);
+  set_obj_visible(main_container, true);
 
 
   // Show/hide based on timer state
   if (timer.getState() == TimerState::WORK) {
-    //hide during work
-    lv_obj_add_flag(bg_img, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_add_flag(sidebar_container, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_set_size(main_container, 320, 170);
-    update_work_display();  // Call work-specific display update
-
-    // HIDE timer labels during work mode
-    if (time_label != nullptr) lv_obj_add_flag(time_label, LV_OBJ_FLAG_HIDDEN);
-    if (state_label != nullptr) lv_obj_add_flag(state_label, LV_OBJ_FLAG_HIDDEN);
+    //hide during work; the layout only changes with a structural change
+    if (changes.structural()) {
+      set_obj_visible(tree_layer, false);
+      set_obj_visible(sidebar_container, false);
+      lv_obj_set_size(main_container, 320, 170);
+    }
+    update_work_display(changes);  // Call work-specific display update
 
   } else if (timer.getState() == TimerState::WIND_UP) {
     // Hide during wind-up (similar to work)
-    lv_obj_add_flag(bg_img, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_add_flag(sidebar_container, LV_OBJ_FLAG_HIDDEN);
-    if (progress_container != nullptr) lv_obj_add_flag(progress_container, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_set_size(main_container, 320, 170);
-    update_windup_display();  // Call wind-up display
-
-    // HIDE timer labels during wind-up mode
-    if (time_label != nullptr) lv_obj_add_flag(time_label, LV_OBJ_FLAG_HIDDEN);
-    if (state_label != nullptr) lv_obj_add_flag(state_label, LV_OBJ_FLAG_HIDDEN);
-    
+    if (changes.structural()) {
+      set_obj_visible(tree_layer, false);
+      set_obj_visible(sidebar_container, false);
+      set_obj_visible(progress_container, false);
+      lv_obj_set_size(main_container, 320, 170);
+    }
+    update_windup_display(changes);  // Call wind-up display
 
   } else {
-    // === IDLE STATE DISPLAY ===
-    
-
-    // Show standard display elements when not WORK or WIND_UP
-    lv_obj_clear_flag(bg_img, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_clear_flag(sidebar_container, LV_OBJ_FLAG_HIDDEN);
-    lv_obj_set_size(main_container, 240, 170);
-
-   // Show standard display elements
-    if (time_label != nullptr) lv_obj_clear_flag(time_label, LV_OBJ_FLAG_HIDDEN);
-    if (state_label != nullptr) lv_obj_clear_flag(state_label, LV_OBJ_FLAG_HIDDEN);
-
-
-
-    // Hide work display elements if they exist
-    if (work_arc != nullptr) lv_obj_add_flag(work_arc, LV_OBJ_FLAG_HIDDEN);
-    if (work_percentage_label != nullptr) lv_obj_add_flag(work_percentage_label, LV_OBJ_FLAG_HIDDEN);
-    if (work_minutes_label != nullptr) lv_obj_add_flag(work_minutes_label, LV_OBJ_FLAG_HIDDEN);
-    if (work_seconds_label != nullptr) lv_obj_add_flag(work_seconds_label, LV_OBJ_FLAG_HIDDEN);
-    if (percent_container != nullptr) lv_obj_add_flag(percent_container, LV_OBJ_FLAG_HIDDEN);
-    if (time_container != nullptr) lv_obj_add_flag(time_container, LV_OBJ_FLAG_HIDDEN);
-    if (status_label != nullptr) lv_obj_add_flag(status_label, LV_OBJ_FLAG_HIDDEN);
-    if (percent_symbol != nullptr)lv_obj_add_flag(percent_symbol, LV_OBJ_FLAG_HIDDEN);  // Add this line
-  
-
-    hide_arc_ticks();
-    update_task_display();
+    // === IDLE / BREAK DISPLAY ===
+    set_obj_visible(tree_layer, true);
+    set_obj_visible(sidebar_container, true);
+
+    // Layout and sidebar only change with state, task, stats, settings or
+    // menu; a plain countdown second goes straight to the view model
+    if (changes.structural()) {
+      lv_obj_set_size(main_container, 240, 170);
+
+      // Hide work display elements if they exist
+      if (work_arc != nullptr) lv_obj_add_flag(work_arc, LV_OBJ_FLAG_HIDDEN);
+      if (work_percentage_label != nullptr) lv_obj_add_flag(work_percentage_label, LV_OBJ_FLAG_HIDDEN);
+      if (work_minutes_label != nullptr) lv_obj_add_flag(work_minutes_label, LV_OBJ_FLAG_HIDDEN);
+      if (work_seconds_label != nullptr) lv_obj_add_flag(work_seconds_label, LV_OBJ_FLAG_HIDDEN);
+      if (percent_container != nullptr) lv_obj_add_flag(percent_container, LV_OBJ_FLAG_HIDDEN);
+      if (time_container != nullptr) lv_obj_add_flag(time_container, LV_OBJ_FLAG_HIDDEN);
+      if (status_label != nullptr) lv_obj_add_flag(status_label, LV_OBJ_FLAG_HIDDEN);
+      if (percent_symbol != nullptr)lv_obj_add_flag(percent_symbol, LV_OBJ_FLAG_HIDDEN);
+
+      hide_arc_ticks();
+      update_task_display();
+    }
 
+    MainView view;
+    build_main_view(view);
+    apply_main_view(view);
   }
 
-  if (timer.getState() != TimerState::WIND_UP && timer.getState() != TimerState::STARTING) {
+  if (changes.structural() &&
+      timer.getState() != TimerState::WIND_UP && timer.getState() != TimerState::STARTING) {
     update_pomodoro_display();
     update_long_break_progress();
   }
 
 
-  // === UPDATE TIME DISPLAY ===
-  char time_str[32];
-
-  if (timer.getState() != TimerState::WORK && 
-      timer.getState() != TimerState::WIND_UP && 
-      timer.getState() != TimerState::STARTING) {
-    if (timer.getState() == TimerState::IDLE) {
-        // Show session summary instead of 00:00
-        uint8_t completed = get_total_completed_pomodoros();
-        uint8_t interrupted = get_total_interrupted_pomodoros();
-        uint16_t total_minutes = get_total_work_minutes();
-
-        // Calculate idle time
-        uint32_t idle_seconds = (millis() - timer.getIdleStartTime()) / 1000;
-        uint32_t idle_minutes = idle_seconds / 60;
-        
-    if (completed > 0 || interrupted > 0) {
-      // === SHOW SUMMARY STATS ===
-      
-      // HIDE timer labels
-      if (time_label != nullptr) lv_obj_add_flag(time_label, LV_OBJ_FLAG_HIDDEN);
-      if (state_label != nullptr) lv_obj_add_flag(state_label, LV_OBJ_FLAG_HIDDEN);
-      
-      // "Today:" label
-      if (summary_today_label != nullptr) {
-        lv_label_set_text(summary_today_label, "Today:");
-        lv_obj_clear_flag(summary_today_label, LV_OBJ_FLAG_HIDDEN);
-      }
-      
-      // Completed number
-      if (summary_completed_num != nullptr) {
-        char num_str[8];
-        snprintf(num_str, sizeof(num_str), "%d:", completed);
-        lv_label_set_text(summary_completed_num, num_str);
-        lv_obj_clear_flag(summary_completed_num, LV_OBJ_FLAG_HIDDEN);
-      }
-      
-      // Completed symbol (positioned relative to number)
-      if (summary_completed_sym != nullptr) {
-        lv_obj_align_to(summary_completed_sym, summary_completed_num, LV_ALIGN_OUT_RIGHT_MID, 3, 0);
-        lv_obj_clear_flag(summary_completed_sym, LV_OBJ_FLAG_HIDDEN);
-      }
-      
-      // Separator
-      if (summary_separator != nullptr) {
-        lv_obj_align_to(summary_separator, summary_completed_sym, LV_ALIGN_OUT_RIGHT_MID, 8, 0);
-        lv_obj_clear_flag(summary_separator, LV_OBJ_FLAG_HIDDEN);
-      }
-      
-      // Interrupted number
-      if (summary_interrupted_num != nullptr) {
-        char num_str[8];
-        snprintf(num_str, sizeof(num_str), "%d:", interrupted);
-        lv_label_set_text(summary_interrupted_num, num_str);
-        lv_obj_align_to(summary_interrupted_num, summary_separator, LV_ALIGN_OUT_RIGHT_MID, 8, 0);
-        lv_obj_clear_flag(summary_interrupted_num, LV_OBJ_FLAG_HIDDEN);
-      }
-      
-      // Interrupted symbol
-      if (summary_interrupted_sym != nullptr) {
-        lv_obj_align_to(summary_interrupted_sym, summary_interrupted_num, LV_ALIGN_OUT_RIGHT_MID, 3, 0);
-        lv_obj_clear_flag(summary_interrupted_sym, LV_OBJ_FLAG_HIDDEN);
-      }
-      
-      // Total time
-      if (summary_total_label != nullptr) {
-        char duration_str[16];
-        format_duration(total_minutes, duration_str, sizeof(duration_str));
-        char total_str[32];
-        snprintf(total_str, sizeof(total_str), "Total: %s", duration_str);
-        lv_label_set_text(summary_total_label, total_str);
-        lv_obj_clear_flag(summary_total_label, LV_OBJ_FLAG_HIDDEN);
-      }
-      
-    } else {
-      // === SHOW READY MESSAGE ===
-      
-      // HIDE all summary labels
-      if (summary_today_label != nullptr) lv_obj_add_flag(summary_today_label, LV_OBJ_FLAG_HIDDEN);
-      if (summary_completed_num != nullptr) lv_obj_add_flag(summary_completed_num, LV_OBJ_FLAG_HIDDEN);
-      if (summary_completed_sym != nullptr) lv_obj_add_flag(summary_completed_sym, LV_OBJ_FLAG_HIDDEN);
-      if (summary_separator != nullptr) lv_obj_add_flag(summary_separator, LV_OBJ_FLAG_HIDDEN);
-      if (summary_interrupted_num != nullptr) lv_obj_add_flag(summary_interrupted_num, LV_OBJ_FLAG_HIDDEN);
-      if (summary_interrupted_sym != nullptr) lv_obj_add_flag(summary_interrupted_sym, LV_OBJ_FLAG_HIDDEN);
-      if (summary_total_label != nullptr) lv_obj_add_flag(summary_total_label, LV_OBJ_FLAG_HIDDEN);
-      
-      // SHOW timer labels
-      if (time_label != nullptr) {
-        lv_label_set_text(time_label, "00:00");
-        lv_obj_clear_flag(time_label, LV_OBJ_FLAG_HIDDEN);
-      }
-      
-      if (state_label != nullptr) {
-        lv_label_set_text(state_label, "Ready to start");
-        lv_obj_set_style_text_color(state_label, lv_color_hex(0x808080), 0);
-        lv_obj_clear_flag(state_label, LV_OBJ_FLAG_HIDDEN);
-      }
-    }
-      
-      // === IDLE TIME WARNING ===
-      if (idle_info_label != nullptr) {
-        if (idle_minutes > 1) {
-          char idle_str[32];
-          snprintf(idle_str, sizeof(idle_str), "Idle: %lumin", idle_minutes);
-          lv_label_set_text(idle_info_label, idle_str);
-          lv_obj_clear_flag(idle_info_label, LV_OBJ_FLAG_HIDDEN);
-        } else {
-          lv_obj_add_flag(idle_info_label, LV_OBJ_FLAG_HIDDEN);
-        }
-      }
-      
-    } else {
-      // === ACTIVE TIMER (Work/Break) ===
-      
-      // HIDE summary labels
-      if (summary_today_label != nullptr) lv_obj_add_flag(summary_today_label, LV_OBJ_FLAG_HIDDEN);
-      if (summary_completed_num != nullptr) lv_obj_add_flag(summary_completed_num, LV_OBJ_FLAG_HIDDEN);
-      if (summary_completed_sym != nullptr) lv_obj_add_flag(summary_completed_sym, LV_OBJ_FLAG_HIDDEN);
-      if (summary_separator != nullptr) lv_obj_add_flag(summary_separator, LV_OBJ_FLAG_HIDDEN);
-      if (summary_interrupted_num != nullptr) lv_obj_add_flag(summary_interrupted_num, LV_OBJ_FLAG_HIDDEN);
-      if (summary_interrupted_sym != nullptr) lv_obj_add_flag(summary_interrupted_sym, LV_OBJ_FLAG_HIDDEN);
-      if (summary_total_label != nullptr) lv_obj_add_flag(summary_total_label, LV_OBJ_FLAG_HIDDEN);
-      if (idle_info_label != nullptr) lv_obj_add_flag(idle_info_label, LV_OBJ_FLAG_HIDDEN);
-
-      
-      // SHOW and update timer labels
-      if (time_label != nullptr) {
-        char time_str[10];
-        snprintf(time_str, sizeof(time_str), "%02lu:%02lu",
-                 timer.getRemainingMinutes(),
-                 timer.getRemainingSecondsInMinute());
-        lv_label_set_text(time_label, time_str);
-        lv_obj_clear_flag(time_label, LV_OBJ_FLAG_HIDDEN);
-      }
-      
-      if (state_label != nullptr) {
-        lv_obj_clear_flag(state_label, LV_OBJ_FLAG_HIDDEN);
-              
-        // Update state display
-        switch (timer.getState()) {
-          case TimerState::SHORT_BREAK:
-            lv_label_set_text(state_label, "Short Break");
-            lv_obj_set_style_text_color(state_label, lv_color_hex(0x00AAFF), 0);
-            break;
-          case TimerState::LONG_BREAK:
-            lv_label_set_text(state_label, "Long Break!");
-            lv_obj_set_style_text_color(state_label, lv_color_hex(0x0055FF), 0);
-            break;
-          case TimerState::PAUSED_SHORT_BREAK:
-          case TimerState::PAUSED_LONG_BREAK:
-            lv_label_set_text(state_label, "Break Paused");
-            lv_obj_set_style_text_color(state_label, lv_color_hex(0xFFAA00), 0);
-            break;
-          case TimerState::PAUSED_WORK:
-            lv_label_set_text(state_label, "Focus Paused");
-            lv_obj_set_style_text_color(state_label, lv_color_hex(0xFFAA00), 0);
-            break;
-          default:
-            break;
-        }
-      }
-    }
-  }
-    update_battery_display();
-
-
     // Handle alert state
     static bool was_alert_active = false;  // Track previous alert state
     
@@ -2006,8 +2044,6 @@ void update_display() {
             update_task_display();
         }
     }
-
-    last_state = timer.getState();
 }
 
 
@@ -2019,15 +2055,17 @@ void update_menu_display() {
     
     // ADD THIS CHECK AT THE VERY START:
     if (timer.getMenuState() == MenuState::CLOSED) {
-        // Hide menu when closed
-        if (menu_container != nullptr) {
-            lv_obj_add_flag(menu_container, LV_OBJ_FLAG_HIDDEN);
+        // Restore once when the menu closes; update_display() owns these
+        // objects afterwards and re-showing them every frame redraws them
+        if (menu_container == nullptr || lv_obj_has_flag(menu_container, LV_OBJ_FLAG_HIDDEN)) {
+            return;
         }
+        lv_obj_add_flag(menu_container, LV_OBJ_FLAG_HIDDEN);
         // Show normal display elements
         if (time_label != nullptr) lv_obj_clear_flag(time_label, LV_OBJ_FLAG_HIDDEN);
         if (state_label != nullptr) lv_obj_clear_flag(state_label, LV_OBJ_FLAG_HIDDEN);
         if (session_label != nullptr) lv_obj_clear_flag(session_label, LV_OBJ_FLAG_HIDDEN);
-        if (bg_img != nullptr) lv_obj_clear_flag(bg_img, LV_OBJ_FLAG_HIDDEN);
+        if (tree_layer != nullptr) lv_obj_clear_flag(tree_layer, LV_OBJ_FLAG_HIDDEN);
         if (sidebar_container != nullptr) lv_obj_clear_flag(sidebar_container, LV_OBJ_FLAG_HIDDEN);
         return;
     }
@@ -2036,7 +2074,7 @@ void update_menu_display() {
     if (time_label != nullptr) lv_obj_add_flag(time_label, LV_OBJ_FLAG_HIDDEN);
     if (state_label != nullptr) lv_obj_add_flag(state_label, LV_OBJ_FLAG_HIDDEN);
     if (session_label != nullptr) lv_obj_add_flag(session_label, LV_OBJ_FLAG_HIDDEN);
-    if (bg_img != nullptr) lv_obj_add_flag(bg_img, LV_OBJ_FLAG_HIDDEN);
+    if (tree_layer != nullptr) lv_obj_add_flag(tree_layer, LV_OBJ_FLAG_HIDDEN);
     if (sidebar_container != nullptr) lv_obj_add_flag(sidebar_container, LV_OBJ_FLAG_HIDDEN);  // ADD THIS
 
     // Create menu display (first time only)
@@ -2064,309 +2102,491 @@ void update_menu_display() {
     
     lv_obj_clear_flag(menu_container, LV_OBJ_FLAG_HIDDEN);
     
-    // Update menu content
-if (timer.getMenuState() == MenuState::MENU_LIST) {
-    // Set label text based on current menu item
-    switch (timer.getCurrentMenuItem()) {
-        case MenuItem::POMODORO_LENGTH:
-            lv_label_set_text(menu_item_label, "Pomodoro Length");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d min", timer.getWorkDuration());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::SHORT_BREAK_LENGTH:
-            lv_label_set_text(menu_item_label, "Short Break Length");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d min", timer.getShortBreakDuration());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::LONG_BREAK_LENGTH:
-            lv_label_set_text(menu_item_label, "Long Break Length");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d min", timer.getLongBreakDuration());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::POMODOROS_BEFORE_LONG_BREAK:
-            lv_label_set_text(menu_item_label, "n Pomodoros before long break");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d pomodoros", timer.getPomodorosBeforeLongBreak());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::LONG_BREAK_PROGRESS:
-            lv_label_set_text(menu_item_label, "Long Break Progress");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d / %d",
-                         timer.getPomodorosSinceLastLongBreak(),
-                         timer.getPomodorosBeforeLongBreak());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::MANAGE_TASKS:
-            lv_label_set_text(menu_item_label, "Total Tasks");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d tasks", timer.getTotalTasks());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::EDIT_COMPLETED_POMODOROS:
-            {
-                char label_str[32];
-                snprintf(label_str, sizeof(label_str), "Task %d Completed", timer.getCurrentTaskId() + 1);
-                lv_label_set_text(menu_item_label, label_str);
-                
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d", timer.getTaskCompletedPomodoros(timer.getCurrentTaskId()));
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-
-        case MenuItem::EDIT_INTERRUPTED_POMODOROS:
-            {
-                char label_str[32];
-                snprintf(label_str, sizeof(label_str), "Task %d Interrupted", timer.getCurrentTaskId() + 1);
-                lv_label_set_text(menu_item_label, label_str);
-                
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d", timer.getTaskInterruptedPomodoros(timer.getCurrentTaskId()));
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::ALARM_DURATION:
-            lv_label_set_text(menu_item_label, "Alarm Duration");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d sec", timer.getAlarmDuration());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::ALARM_VIBRATION:
-            lv_label_set_text(menu_item_label, "Haptic Feedback");
-            lv_label_set_text(menu_value_label, timer.getAlarmVibration() ? "ON" : "OFF");
-            break;
-        case MenuItem::ALARM_FLASH:
-            lv_label_set_text(menu_item_label, "Alarm Flash");
-            lv_label_set_text(menu_value_label, timer.getAlarmFlash() ? "ON" : "OFF");
-            break;                        
-        // case MenuItem::IDLE_TIMEOUT_MINUTES:
-        //     lv_label_set_text(menu_item_label, "Idle timeout time (min)");
-        //     {
-        //         char val_str[16];
-        //         snprintf(val_str, sizeof(val_str), "%d min", timer.getIdleTImeoutDuration());
-        //         lv_label_set_text(menu_value_label, val_str);
-        //     }
-        //     break;
-        case MenuItem::IDLE_TIMEOUT_BATTERY:
-            lv_label_set_text(menu_item_label, "Idle Timeout (Battery)");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d min", timer.getIdleTimeoutBattery());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::IDLE_TIMEOUT_USB:
-            lv_label_set_text(menu_item_label, "Idle Timeout (USB)");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d min", timer.getIdleTimeoutUSB());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::IDLE_SLEEP_ON_USB:
-            lv_label_set_text(menu_item_label, "Sleep When on USB");
-            lv_label_set_text(menu_value_label, timer.getSleepOnUSB() ? "ON" : "OFF");
-            break;            
-        case MenuItem::BRIGHTNESS:
-            lv_label_set_text(menu_item_label, "Brightness");
-            {
-                char val_str[16];
-                // Show as percentage or level number
-                int percent = (timer.getBrightnessLevel() + 1) * 12.5;  // Convert 0-7 to ~12-100%
-                snprintf(val_str, sizeof(val_str), "%d%%", percent);
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::THEME:
-            lv_label_set_text(menu_item_label, "Theme");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "Theme %d", timer.getTheme());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::SCREEN_ORIENTATION:
-            lv_label_set_text(menu_item_label, "Orientation");
-            lv_label_set_text(menu_value_label, timer.getScreenFlipped() ? "Flipped" : "Normal");
-            break;
-        case MenuItem::ENABLE_WINDUP:
-            lv_label_set_text(menu_item_label, "Wind-up Mode");
-            lv_label_set_text(menu_value_label, timer.getWindupEnabled() ? "ON" : "OFF");
-            break;
-        default:
-            break;
-    }
-    lv_obj_set_style_text_color(menu_item_label, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_text_color(menu_value_label, lv_color_hex(0x808080), 0);
-    
-} else if (timer.getMenuState() == MenuState::EDITING_VALUE) {
-    // Set label text based on current menu item
-    switch (timer.getCurrentMenuItem()) {
-        case MenuItem::POMODORO_LENGTH:
-            lv_label_set_text(menu_item_label, "Pomodoro Length");
-            break;
-        case MenuItem::SHORT_BREAK_LENGTH:
-            lv_label_set_text(menu_item_label, "Short Break Length");
-            break;
-        case MenuItem::LONG_BREAK_LENGTH:
-            lv_label_set_text(menu_item_label, "Long Break Length");
-            break;
-        case MenuItem::POMODOROS_BEFORE_LONG_BREAK:
-            lv_label_set_text(menu_item_label, "Pomodoros Before Break");
-            break;
-        case MenuItem::LONG_BREAK_PROGRESS:
-            lv_label_set_text(menu_item_label, "Long Break Progress");
-            break;
-        case MenuItem::MANAGE_TASKS:
-            lv_label_set_text(menu_item_label, "Total Tasks");
-            break;            
-        case MenuItem::EDIT_COMPLETED_POMODOROS:
-            {
-                char label_str[32];
-                snprintf(label_str, sizeof(label_str), "Task %d Completed", timer.getCurrentTaskId() + 1);
-                lv_label_set_text(menu_item_label, label_str);
-            }
-            break;
-        case MenuItem::EDIT_INTERRUPTED_POMODOROS:
-            {
-                char label_str[32];
-                snprintf(label_str, sizeof(label_str), "Task %d Interrupted", timer.getCurrentTaskId() + 1);
-                lv_label_set_text(menu_item_label, label_str);
-            }
-            break;
-        case MenuItem::ALARM_DURATION:
-            lv_label_set_text(menu_item_label, "Alarm Duration");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d sec", timer.getEditingValue());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::ALARM_VIBRATION:
-            lv_label_set_text(menu_item_label, "Haptic Feedback");
-            lv_label_set_text(menu_value_label, timer.getEditingValue() ? "ON" : "OFF");
-            break;
-        case MenuItem::ALARM_FLASH:
-            lv_label_set_text(menu_item_label, "Alarm Flash");
-            lv_label_set_text(menu_value_label, timer.getEditingValue() ? "ON" : "OFF");
-            break;      
-        // case MenuItem::IDLE_TIMEOUT_MINUTES:
-        //     lv_label_set_text(menu_item_label, "Idle Timeout");
-        //     break;
-        case MenuItem::IDLE_TIMEOUT_BATTERY:
-            lv_label_set_text(menu_item_label, "Battery Idle Timeout");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d min", timer.getEditingValue());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::IDLE_TIMEOUT_USB:
-            lv_label_set_text(menu_item_label, "USB Idle Timeout");
-            {
-                char val_str[16];
-                snprintf(val_str, sizeof(val_str), "%d min", timer.getEditingValue());
-                lv_label_set_text(menu_value_label, val_str);
-            }
-            break;
-        case MenuItem::IDLE_SLEEP_ON_USB:
-            lv_label_set_text(menu_item_label, "Sleep on USB");
-            lv_label_set_text(menu_value_label, timer.getEditingValue() ? "ON" : "OFF");
-            break;            
-        case MenuItem::BRIGHTNESS:
-            lv_label_set_text(menu_item_label, "Brightness");
-            break;
-        case MenuItem::THEME:
-            lv_label_set_text(menu_item_label, "Theme");
-            break;
-        case MenuItem::SCREEN_ORIENTATION:
-            lv_label_set_text(menu_item_label, "Orientation");
-            break;
-        case MenuItem::ENABLE_WINDUP:
-            lv_label_set_text(menu_item_label, "Wind-up Mode");
-            lv_label_set_text(menu_value_label, timer.getEditingValue() ? "ON" : "OFF");
-            break;
-        default:
-            break;
-    }
-    
+    // Update menu content: the list shows the stored value, the editor the pending one
+    MenuItem item = timer.getCurrentMenuItem();
+    bool editing = timer.getMenuState() == MenuState::EDITING_VALUE;
+    char label_str[32];
     char val_str[16];
-    // Special formatting for brightness
-    if (timer.getCurrentMenuItem() == MenuItem::BRIGHTNESS) {
-        int percent = (timer.getEditingValue() + 1) * 12.5;
-        snprintf(val_str, sizeof(val_str), "%d%%", percent);
-    } else if (timer.getCurrentMenuItem() == MenuItem::THEME) {
-        snprintf(val_str, sizeof(val_str), "Theme %d", timer.getEditingValue());
-    } else if (timer.getCurrentMenuItem() == MenuItem::MANAGE_TASKS) {
-        snprintf(val_str, sizeof(val_str), "%d tasks", timer.getEditingValue());
-    } else if (timer.getCurrentMenuItem() == MenuItem::POMODOROS_BEFORE_LONG_BREAK) {
-        snprintf(val_str, sizeof(val_str), "%d", timer.getEditingValue());
-    } else if (timer.getCurrentMenuItem() == MenuItem::LONG_BREAK_PROGRESS) {
-        snprintf(val_str, sizeof(val_str), "%d / %d", timer.getEditingValue(),
-                 timer.getPomodorosBeforeLongBreak());
-    } else if (timer.getCurrentMenuItem() == MenuItem::EDIT_COMPLETED_POMODOROS || 
-               timer.getCurrentMenuItem() == MenuItem::EDIT_INTERRUPTED_POMODOROS) {
-        snprintf(val_str, sizeof(val_str), "%d", timer.getEditingValue());
-    } else if (timer.getCurrentMenuItem() == MenuItem::ALARM_VIBRATION || 
-               timer.getCurrentMenuItem() == MenuItem::ALARM_FLASH) {
-        snprintf(val_str, sizeof(val_str), "%s", timer.getEditingValue() ? "ON" : "OFF");
-    } else if (timer.getCurrentMenuItem() == MenuItem::SCREEN_ORIENTATION) {
-        snprintf(val_str, sizeof(val_str), "%s", timer.getEditingValue() ? "Flipped" : "Normal");
-    } else {
-        snprintf(val_str, sizeof(val_str), "%d min", timer.getEditingValue());
-    }    
+    timer.formatMenuLabel(item, label_str, sizeof(label_str));
+    timer.formatMenuValue(item, editing ? timer.getEditingValue() : timer.getMenuValue(item),
+                          val_str, sizeof(val_str));
+    lv_label_set_text(menu_item_label, label_str);
     lv_label_set_text(menu_value_label, val_str);
-    lv_obj_set_style_text_color(menu_item_label, lv_color_hex(0x808080), 0);
-    lv_obj_set_style_text_color(menu_value_label, lv_color_hex(0x00FF00), 0);
+
+    if (editing) {
+        lv_obj_set_style_text_color(menu_item_label, lv_color_hex(0x808080), 0);
+        lv_obj_set_style_text_color(menu_value_label, lv_color_hex(0x00FF00), 0);
+    } else {
+        lv_obj_set_style_text_color(menu_item_label, lv_color_hex(0xFFFFFF), 0);
+        lv_obj_set_style_text_color(menu_value_label, lv_color_hex(0x808080), 0);
+    }
+}
+
+
+// ============================================================================
+// MAIN LOOP CHORES - scheduled on a timing wheel, run from loop()
+// ============================================================================
+enum Chore : uint8_t {
+  CHORE_BATTERY,     // Sample battery, refresh its label and the backlight
+  CHORE_LVGL,        // Advance the LVGL tick and run its timers
+  CHORE_UI,          // timer.update() + redraw, one-shot at the next timer deadline
+  CHORE_IDLE_CHECK,  // Idle timeout -> deep sleep
+  CHORE_IDLE_LOG,    // Idle countdown debug print
+  CHORE_STATS_LOG,   // Chore lateness report
+  CHORE_JOURNAL,     // Erase retired session journal sectors ahead of need
+  CHORE_CONSOLE,     // Serial console commands
+  CHORE_COUNT
+};
+
+static ChoreWheel chores;
+static uint32_t last_input_ms = 0;
+static uint32_t last_ui_update_ms = 0;
+static uint32_t last_lvgl_tick_ms = 0;
+
+// True while inputs are in use (or settling after the last one)
+bool input_in_progress(uint32_t now) {
+  return now - last_input_ms < INPUT_SETTLE_MS;
+}
+
+// Milliseconds from now until a TimerCore deadline (clamped to the loop cap)
+uint32_t ms_until_deadline(uint64_t deadline_us) {
+  if (deadline_us == TIMER_NO_DEADLINE) return MAX_LOOP_SLEEP_MS;
+  uint64_t now_us = timer.getClock().nowMicros();
+  if (deadline_us <= now_us) return 0;
+  uint64_t wait_ms = (deadline_us - now_us + 999) / 1000;
+  return (wait_ms > MAX_LOOP_SLEEP_MS) ? MAX_LOOP_SLEEP_MS : (uint32_t)wait_ms;
+}
+
+void chore_battery() {
+  update_battery_display();
+  update_brightness();
+}
+
+void chore_lvgl() {
+  uint32_t now = millis();
+  // Feed the real elapsed time, the loop has no fixed rate
+  lv_tick_inc(now - last_lvgl_tick_ms);
+  last_lvgl_tick_ms = now;
+  lv_timer_handler();
+
+  if (input_in_progress(now)) {
+    chores.schedule(CHORE_LVGL, now + INPUT_POLL_MS);
+  }
+}
+
+void chore_ui() {
+  timer.update();
+  update_cpu_frequency();
+  update_display();
+  update_brightness();
+
+  uint32_t now = millis();
+  last_ui_update_ms = now;
+
+  // Next visible change, or the input refresh rate while inputs are in use
+  uint32_t wait_ms = ms_until_deadline(timer.nextDeadline());
+  if (input_in_progress(now) && wait_ms > UI_INTERVAL_INPUT_MS) {
+    wait_ms = UI_INTERVAL_INPUT_MS;
+  }
+  chores.schedule(CHORE_UI, now + wait_ms);
+
+  if (!chores.isArmed(CHORE_LVGL)) {
+    chores.schedule(CHORE_LVGL, now);
+  }
 }
+
+void chore_idle_check() {
+  if (timer.checkIdleTimeout(current_battery_voltage)) {
+    Serial.println("Idle timeout - entering sleep");
+    display_sleep_message();
+    delay(1000);
+    enter_deep_sleep();
+  }
+}
+
+void chore_idle_log() {
+  timer.logIdleStatus(current_battery_voltage);
+}
+
+void chore_stats_log() {
+  Serial.println("Chore lateness (runs / avg ms / max ms):");
+  for (uint8_t i = 0; i < CHORE_COUNT; i++) {
+    const ChoreStats &stats = chores.stats(i);
+    if (stats.runs == 0) continue;
+    Serial.printf("  %-11s %7lu %5lu %5lu\n", chores.name(i),
+                  (unsigned long)stats.runs,
+                  (unsigned long)(stats.totalLateMs / stats.runs),
+                  (unsigned long)stats.maxLateMs);
+  }
+}
+
+void chore_journal() {
+  uint32_t erases = journal.stats().compactErases;
+  journal.compact();
+  if (journal.stats().compactErases != erases) flashTelemetry().recordErase(FlashTarget::JOURNAL);
+}
+
+// ============================================================================
+// SERIAL CONSOLE - one command per line
+// ============================================================================
+const uint8_t CONSOLE_LINE_MAX = 32;
+char console_line[CONSOLE_LINE_MAX];
+uint8_t console_len = 0;
+
+void print_flash_counters(const char *name, const FlashCounters &c, uint32_t avg_us) {
+  Serial.printf("  %-10s %7lu %9lu %6lu %7lu %7lu\n", name,
+                (unsigned long)c.writes, (unsigned long)c.bytes, (unsigned long)c.erases,
+                (unsigned long)avg_us, (unsigned long)c.maxUs);
+}
+
+void print_flash_telemetry() {
+  FlashTelemetry &telemetry = flashTelemetry();
+  Serial.println("Flash writes        writes     bytes erases  avg us  max us");
+  Serial.println(" since boot:");
+  for (uint8_t t = 0; t < FLASH_TARGET_COUNT; t++) {
+    FlashTarget target = (FlashTarget)t;
+    print_flash_counters(FlashTelemetry::name(target), telemetry.sinceBoot(target),
+                         telemetry.averageUs(target));
+  }
+  Serial.println(" lifetime:");
+  for (uint8_t t = 0; t < FLASH_TARGET_COUNT; t++) {
+    FlashTarget target = (FlashTarget)t;
+    FlashCounters c = telemetry.lifetime(target);
+    if (c.writes == 0 && c.erases == 0) continue;
+    print_flash_counters(FlashTelemetry::name(target), c, 0);
+  }
+
+  StateSlots &slots = stateSlots();
+  if (slots.isMounted()) {
+    Serial.printf("State slots: generation %lu, ~%lu erases per sector\n",
+                  (unsigned long)slots.generation(),
+                  (unsigned long)(slots.generation() / StateSlots::SLOT_COUNT));
+  }
+  if (journal.isMounted()) {
+    uint32_t lo = 0xFFFFFFFF;
+    uint32_t hi = 0;
+    for (uint8_t i = 0; i < journal.sectors(); i++) {
+      uint32_t erases = journal.sectorErases(i);
+      if (erases < lo) lo = erases;
+      if (erases > hi) hi = erases;
+    }
+    Serial.printf("Journal: %lu entries, sector erases %lu..%lu\n",
+                  (unsigned long)journal.count(), (unsigned long)lo, (unsigned long)hi);
+  }
+
+  // Project the wear of the busiest sectors from the lifetime rate per session
+  FlashCounters sessions = telemetry.lifetime(FlashTarget::JOURNAL);
+  FlashCounters state = telemetry.lifetime(FlashTarget::STATE_SLOTS);
+  if (sessions.writes > 0 && state.erases > 0) {
+    float erases_per_day = (float)state.erases / StateSlots::SLOT_COUNT / sessions.writes *
+                           BUDGET_SESSIONS_PER_DAY;
+    Serial.printf("Budget at %lu sessions/day: %.1f state writes per session, "
+                  "%.1f erases/sector/day, %.1f years to %lu cycles\n",
+                  (unsigned long)BUDGET_SESSIONS_PER_DAY,
+                  (float)state.writes / sessions.writes, erases_per_day,
+                  FLASH_ENDURANCE_CYCLES / erases_per_day / 365.0f,
+                  (unsigned long)FLASH_ENDURANCE_CYCLES);
+  }
+}
+
+const uint8_t HIST_PRINT_COUNT = 10;
+
+// Newest sessions, and what the whole history would take in the compact encoding
+void print_history() {
+  const SessionHistory &history = timer.getHistory();
+  uint16_t first = (history.size() > HIST_PRINT_COUNT) ? history.size() - HIST_PRINT_COUNT : 0;
+  Serial.println("Recent sessions (start, kind, outcome, task, run s, paused s):");
+  for (uint16_t i = first; i < history.size(); i++) {
+    const SessionRecord &r = history[i];
+    Serial.printf("  %10lu %d %d %3d %5u %5u\n", (unsigned long)r.startEpoch, (int)r.kind,
+                  (int)r.outcome, r.taskId + 1, r.durationSec, r.pausedSec);
+  }
+
+  HistoryEncoder encoder;
+  uint8_t scratch[HistoryEncoder::MAX_RECORD_SIZE];
+  uint32_t records = 0;
+  uint32_t encoded = 0;
+  uint32_t start_us = micros();
+  if (journal.isMounted()) {
+    for (uint32_t back = journal.count(); back-- > 0;) {
+      SessionRecord r;
+      if (!journal.readNewest(back, r)) continue;
+      encoded += encoder.encode(r, scratch);
+      records++;
+    }
+  } else {
+    for (const SessionRecord &r : history) {
+      encoded += encoder.encode(r, scratch);
+      records++;
+    }
+  }
+  if (records == 0) return;
+  Serial.printf("%lu records: %lu bytes raw, %lu encoded (%.2f bytes/record) in %lu us\n",
+                (unsigned long)records, (unsigned long)(records * sizeof(SessionRecord)),
+                (unsigned long)encoded, (float)encoded / records,
+                (unsigned long)(micros() - start_us));
+}
+
+const uint32_t IMPORT_TIMEOUT_MS = 5000;
+const uint32_t IMPORT_POLL_MS = 10;  // Console polling while a frame arrives
+uint8_t transfer_frame[STATE_FRAME_MAX];
+
+// Import in progress: the frame is gathered across console chore runs
+bool import_active = false;
+size_t import_len = 0;
+uint32_t import_deadline_ms = 0;
+
+// Binary frame straight after the command reply; see sealStateFrame()
+void export_state() {
+  size_t record_len = timer.exportState(transfer_frame + STATE_FRAME_HEADER,
+                                        sizeof(transfer_frame) - STATE_FRAME_HEADER - 4);
+  if (record_len == 0) {
+    Serial.println("Export failed");
+    return;
+  }
+  size_t frame_len = sealStateFrame(transfer_frame, record_len);
+  Serial.printf("Exporting %u bytes\n", (unsigned)frame_len);
+  Serial.write(transfer_frame, frame_len);
+  Serial.println();
+}
+
+// Wait for a frame without blocking the loop; receive_import() collects it
+void import_state() {
+  Serial.println("Send state frame");
+  import_active = true;
+  import_len = 0;
+  import_deadline_ms = millis() + IMPORT_TIMEOUT_MS;
+}
+
+void finish_import(size_t frame_len) {
+  size_t record_len = 0;
+  const uint8_t *record = openStateFrame(transfer_frame, frame_len, &record_len);
+  if (record == nullptr) {
+    Serial.println("Import rejected: frame CRC mismatch");
+    return;
+  }
+  if (timer.importState(record, record_len)) {
+    Serial.println("Import OK");
+    request_ui_refresh(millis());
+  }
+}
+
+// Take whatever part of the frame has arrived; the header announces the rest
+void receive_import() {
+  size_t frame_len = 0;
+  if (import_len >= STATE_FRAME_HEADER) frame_len = stateFrameLength(transfer_frame);
+  while (Serial.available() > 0) {
+    size_t want = (frame_len > 0) ? frame_len : STATE_FRAME_HEADER;
+    uint8_t b = (uint8_t)Serial.read();
+    if (import_len == 0 && (b == '\r' || b == '\n')) continue;  // Rest of the command line
+    transfer_frame[import_len++] = b;
+    if (import_len == STATE_FRAME_HEADER && frame_len == 0) {
+      frame_len = stateFrameLength(transfer_frame);
+      if (frame_len == 0) {
+        Serial.println("Import rejected: not a state frame");
+        import_active = false;
+        return;
+      }
+    } else if (import_len == want) {
+      import_active = false;
+      finish_import(frame_len);
+      return;
+    }
+  }
+  if ((int32_t)(millis() - import_deadline_ms) >= 0) {
+    Serial.println("Import timed out");
+    import_active = false;
+  }
+}
+
+// Redraw cost per screen since the last "frames" command. The header names
+// the flush path and band count so pasted numbers say what they measured.
+void print_frame_stats() {
+  Serial.printf("Frames (%s flush, %d x %d-row band%s, screen %d px)\n",
+                display_dma ? "DMA" : "blocking", lv_disp_buf2 ? 2 : 1,
+                LVGL_LCD_BUF_SIZE / DISPLAY_WIDTH, lv_disp_buf2 ? "s" : "",
+                DISPLAY_WIDTH * DISPLAY_HEIGHT);
+  Serial.println("  screen  frames  avg px  max px  last px  avg ms  max ms  flush us");
+  for (uint8_t i = 0; i < FRAME_SCREENS; i++) {
+    const FrameStats &stats = frame_stats[i];
+    if (stats.frames == 0) continue;
+    Serial.printf("  %-6s %7lu %7lu %7lu %8lu %7lu %7lu %9lu\n", FRAME_SCREEN_NAMES[i],
+                  (unsigned long)stats.frames,
+                  (unsigned long)(stats.pixels / stats.frames),
+                  (unsigned long)stats.max_pixels,
+                  (unsigned long)stats.last_pixels,
+                  (unsigned long)(stats.render_ms / stats.frames),
+                  (unsigned long)stats.max_ms,
+                  (unsigned long)(stats.flush_us / stats.frames));
+  }
+  Serial.printf("Tree layer: %lu renders, last %lu us\n",
+                (unsigned long)tree_renders, (unsigned long)tree_render_us);
+  memset(frame_stats, 0, sizeof(frame_stats));
+}
+
+// "time" shows the wall clock; "time <unix seconds>" sets it, e.g. with
+// `date +%s` on the host. The RTC keeps it through deep sleep, not power-off.
+void time_command(const char *arg) {
+  while (*arg == ' ') arg++;
+  if (*arg != '\0') {
+    char *end = nullptr;
+    unsigned long seconds = strtoul(arg, &end, 10);
+    if (end == arg || *end != '\0' || seconds < Clock::WALL_CLOCK_MIN_EPOCH) {
+      Serial.println("Usage: time <unix seconds>");
+      return;
+    }
+    if (!setWallClock((uint32_t)seconds)) {
+      Serial.println("Setting the clock failed");
+      return;
+    }
+  }
+
+  const Clock &clock = timer.getClock();
+  uint32_t now = clock.epochSeconds();
+  if (clock.hasWallTime()) {
+    time_t t = (time_t)now;
+    struct tm utc;
+    char text[24];
+    gmtime_r(&t, &utc);
+    strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &utc);
+    Serial.printf("Wall clock: %lu (%s UTC)\n", (unsigned long)now, text);
+  } else {
+    Serial.printf("Wall clock not set, %lu s since power-on (time <unix seconds>)\n",
+                  (unsigned long)now);
+  }
 }
 
+void run_console_command(const char *cmd) {
+  if (strcmp(cmd, "flash") == 0) {
+    print_flash_telemetry();
+  } else if (strcmp(cmd, "hist") == 0) {
+    print_history();
+  } else if (strcmp(cmd, "export") == 0) {
+    export_state();
+  } else if (strcmp(cmd, "import") == 0) {
+    import_state();
+  } else if (strcmp(cmd, "frames") == 0) {
+    print_frame_stats();
+  } else if (strncmp(cmd, "time", 4) == 0 && (cmd[4] == '\0' || cmd[4] == ' ')) {
+    time_command(cmd + 4);
+  } else if (strcmp(cmd, "help") == 0) {
+    Serial.println("Commands: flash (write counters and wear), hist (recent sessions),");
+    Serial.println("          export / import (binary settings and stats frame),");
+    Serial.println("          frames (redraw pixels and times per screen),");
+    Serial.println("          time [unix seconds] (show or set the wall clock), help");
+  } else if (cmd[0] != '\0') {
+    Serial.printf("Unknown command '%s' (try help)\n", cmd);
+  }
+}
+
+void chore_console() {
+  if (import_active) {
+    receive_import();
+    // Poll fast until the frame is in so the receive buffer cannot overrun
+    if (import_active) {
+      chores.schedule(CHORE_CONSOLE, millis() + IMPORT_POLL_MS);
+      return;
+    }
+  }
+  while (Serial.available() > 0) {
+    char c = (char)Serial.read();
+    if (c == '\n' || c == '\r') {
+      console_line[console_len] = '\0';
+      run_console_command(console_line);
+      console_len = 0;
+      if (import_active) {
+        // The frame may follow the command straight away
+        chores.schedule(CHORE_CONSOLE, millis() + IMPORT_POLL_MS);
+        return;
+      }
+    } else if (console_len < CONSOLE_LINE_MAX - 1) {
+      console_line[console_len++] = c;
+    }
+  }
+}
+
+// Pull the UI refresh forward after input, rate limited to UI_INTERVAL_INPUT_MS
+void request_ui_refresh(uint32_t now) {
+  uint32_t due = last_ui_update_ms + UI_INTERVAL_INPUT_MS;
+  if ((int32_t)(due - now) < 0) due = now;
+  if (!chores.isArmed(CHORE_UI) || (int32_t)(chores.dueAt(CHORE_UI) - due) > 0) {
+    chores.schedule(CHORE_UI, due);
+  }
+  if (!chores.isArmed(CHORE_LVGL)) {
+    chores.schedule(CHORE_LVGL, now);
+  }
+}
+
+void setup_chores() {
+  uint32_t now = millis();
+  chores.reset(now);
+  chores.add(CHORE_BATTERY, "battery", chore_battery, BATTERY_CHECK_INTERVAL_MS);
+  chores.add(CHORE_LVGL, "lvgl", chore_lvgl, 0);
+  chores.add(CHORE_UI, "ui", chore_ui, 0);
+  chores.add(CHORE_IDLE_CHECK, "idle_check", chore_idle_check, IDLE_CHECK_INTERVAL_MS);
+  chores.add(CHORE_IDLE_LOG, "idle_log", chore_idle_log, IDLE_LOG_INTERVAL_MS);
+  chores.add(CHORE_STATS_LOG, "stats_log", chore_stats_log, CHORE_STATS_INTERVAL_MS);
+  chores.add(CHORE_JOURNAL, "journal", chore_journal, JOURNAL_COMPACT_INTERVAL_MS);
+  chores.add(CHORE_CONSOLE, "console", chore_console, CONSOLE_POLL_MS);
+
+  // Battery first so the idle check sees a real voltage
+  chores.schedule(CHORE_BATTERY, now);
+  chores.schedule(CHORE_UI, now);
+  chores.schedule(CHORE_IDLE_CHECK, now + IDLE_CHECK_INTERVAL_MS);
+  chores.schedule(CHORE_IDLE_LOG, now + IDLE_LOG_INTERVAL_MS);
+  chores.schedule(CHORE_STATS_LOG, now + CHORE_STATS_INTERVAL_MS);
+  chores.schedule(CHORE_JOURNAL, now + JOURNAL_COMPACT_INTERVAL_MS);
+  chores.schedule(CHORE_CONSOLE, now + CONSOLE_POLL_MS);
+  last_lvgl_tick_ms = now;
+}
+
+void setup_journal() {
+  if (!journal_flash.begin("journal")) {
+    Serial.println("Session journal: no 'journal' partition, history stays in RAM");
+    return;
+  }
+  uint32_t start_us = micros();
+  if (!journal.mount()) {
+    Serial.println("Session journal: mount failed");
+    return;
+  }
+  const JournalStats &stats = journal.stats();
+  Serial.printf("Session journal: %lu entries, %lu reads, %lu torn, mounted in %lu us\n",
+                (unsigned long)journal.count(), (unsigned long)stats.mountReads,
+                (unsigned long)stats.tornSlots, (unsigned long)(micros() - start_us));
+  timer.attachJournal(&journal);
+}
 
 void setup() {
+  boot_mark("startup");
+
+  // Check wake reason
+  esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
+  bool woke = wakeup_reason == ESP_SLEEP_WAKEUP_EXT1;
+
   Serial.begin(115200);
-  delay(100);
+  if (!woke) delay(SERIAL_SETTLE_MS);
 
   esp_reset_reason_t reason = esp_reset_reason();
   Serial.printf("Reset reason: %d\n", reason);
+  boot_mark("serial");
 
-
-  // Check wake reason
-  esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
-  
-  if (wakeup_reason == ESP_SLEEP_WAKEUP_EXT1) {
+  if (woke) {
     Serial.println("Woke from deep sleep");
     gpio_reset_pin(GPIO_NUM_14);
     gpio_reset_pin((gpio_num_t)PIN_ENC_A);
     gpio_reset_pin((gpio_num_t)PIN_ENC_B);
     gpio_reset_pin((gpio_num_t)PIN_ENC_BTN);
-    delay(100);
     pinMode(PIN_BUTTON_2, INPUT_PULLUP);
     pinMode(PIN_ENC_A, INPUT_PULLUP);
     pinMode(PIN_ENC_B, INPUT_PULLUP);
     pinMode(PIN_ENC_BTN, INPUT_PULLUP);
+    delay(WAKE_PIN_SETTLE_MS);
     if (digitalRead(PIN_BUTTON_2) == LOW) {
       wake_button2_pending = true;
       wake_button2_start = millis();
     }
-    delay(100);
+    boot_mark("wake pins");
   }
 
   // Initialize watchdog timer (30 second timeout)
@@ -2376,7 +2596,12 @@ void setup() {
 
   Serial.println("Starting setup...");
   setCpuFrequencyMhz(80);
-  timer = TimerCore();
+  boot_mark("watchdog+cpu");
+  boot_resumed = timer.begin(woke);
+  stateWriter().begin();  // Saves from here on are written in the background
+  boot_mark("state");
+  setup_journal();
+  boot_mark("journal");
 
   // Initialize power
   pinMode(PIN_POWER_ON, OUTPUT);
@@ -2389,27 +2614,52 @@ void setup() {
   pinMode(PIN_BUTTON_2, INPUT_PULLUP);
 
   // Initialize TFT
+#ifdef DISPLAY_ESP_LCD_I80
+  static const I80Pins lcd_pins = {
+    {PIN_LCD_D0, PIN_LCD_D1, PIN_LCD_D2, PIN_LCD_D3, PIN_LCD_D4, PIN_LCD_D5, PIN_LCD_D6, PIN_LCD_D7},
+    PIN_LCD_WR, PIN_LCD_RD, PIN_LCD_DC, PIN_LCD_CS, PIN_LCD_RST
+  };
+  display_dma = lcd_io.begin(lcd_pins, LCD_PIXEL_CLOCK_HZ, LVGL_LCD_BUF_SIZE * sizeof(lv_color_t)) &&
+                lcd_panel.begin(timer.getScreenFlipped() ? 1 : 3);
+  if (!display_dma) Serial.println("esp_lcd i80 panel init failed");
+#else
   tft.init();
   apply_display_orientation();
   tft.fillScreen(TFT_BLACK);
+#endif
 
   // Initialize backlight
   ledcSetup(LCD_BL_PWM_CHANNEL, 10000, 8);
   ledcAttachPin(PIN_LCD_BL, LCD_BL_PWM_CHANNEL);
   ledcWrite(LCD_BL_PWM_CHANNEL, BRIGHTNESS_VALUES[timer.getBrightnessLevel()]);
+  boot_mark("display");
 
   // Initialize LVGL
   lv_init();
   lv_disp_buf = (lv_color_t *)heap_caps_malloc(LVGL_LCD_BUF_SIZE * sizeof(lv_color_t),
                                                MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
-  
-  lv_disp_draw_buf_init(&disp_buf, lv_disp_buf, NULL, LVGL_LCD_BUF_SIZE);
+#ifdef DISPLAY_ESP_LCD_I80
+  // Two bands: LVGL renders the next one while the i80 DMA sends the
+  // previous (a 25.6 KB band takes ~3.9 ms at 6.5 MHz x 8 bits), and
+  // lcd_flush_done() hands each back from the transfer-done interrupt.
+  // TFT_eSPI flushes synchronously, so a second band would only cost RAM.
+  if (display_dma) {
+    lv_disp_buf2 = (lv_color_t *)heap_caps_malloc(LVGL_LCD_BUF_SIZE * sizeof(lv_color_t),
+                                                  MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+  }
+#endif
+  lv_disp_draw_buf_init(&disp_buf, lv_disp_buf, lv_disp_buf2, LVGL_LCD_BUF_SIZE);
   lv_disp_drv_init(&disp_drv);
   disp_drv.hor_res = 320;
   disp_drv.ver_res = 170;
   disp_drv.flush_cb = my_disp_flush;
+  disp_drv.monitor_cb = my_disp_monitor;
   disp_drv.draw_buf = &disp_buf;
   lv_disp_drv_register(&disp_drv);
+#ifdef DISPLAY_ESP_LCD_I80
+  lcd_io.onColorDone(lcd_flush_done, &disp_drv);
+#endif
+  boot_mark("lvgl");
 
   // ============================================================================
   // EC11 ENCODER SETUP - OPTIMIZED
@@ -2446,6 +2696,10 @@ void setup() {
   btn2.setClickHandler([](Button2 &b) { handle_button2_click(); });
   btn2.setLongClickDetectedHandler([](Button2 &b) { handle_button2_longpress(); });
 
+  // Inputs wake the main loop instead of it polling continuously
+  loop_task = xTaskGetCurrentTaskHandle();
+  enable_button_interrupts();
+
   // Setup vibration
   pinMode(PIN_VIBRATION, OUTPUT);
   digitalWrite(PIN_VIBRATION, LOW);
@@ -2456,56 +2710,27 @@ void setup() {
 
   // Setup screen
   lv_obj_set_style_bg_color(lv_scr_act(), lv_color_hex(0x000000), 0);
+
+  // Periodic work for loop()
+  setup_chores();
+  boot_mark("inputs");
   
   Serial.println("Setup complete!");
 }
 
 void loop() {
-  static uint32_t last_lvgl_tick = 0;
-  static uint32_t last_ui_update = 0;
-  static TimerState last_encoder_state = TimerState::IDLE;
   uint32_t now = millis();
-  
-  // Read battery voltage
-  static uint32_t last_voltage_check = 0;
-  if (millis() - last_voltage_check > BATTERY_CHECK_INTERVAL_MS) {
-    current_battery_voltage = analogRead(PIN_BAT_VOLT) * 3.3 / 4095.0 * 2.0;
-    last_voltage_check = millis();
-  }
-
 
-  // Check idle timeout with voltage reading
-  if (timer.checkIdleTimeout(current_battery_voltage)) {
-    Serial.println("Idle timeout - entering sleep");
-    display_sleep_message();
-    delay(1000);
-    enter_deep_sleep();
-    return;
-  }
-
-
-  // --- LVGL tick at 20 ms ---
-  if (now - last_lvgl_tick >= LVGL_TICK_MS) {
-    lv_tick_inc(LVGL_TICK_MS);
-    lv_timer_handler();
-    last_lvgl_tick = now;
+  // Inputs since the last pass (interrupt edge or a button still held)
+  bool input_event = input_event_pending || any_button_down();
+  input_event_pending = false;
+  if (input_event) {
+    last_input_ms = now;
+    request_ui_refresh(now);
   }
 
-  // --- UI / timer update at lower rate ---
-  const uint32_t UI_INTERVAL_ACTIVE = 100;    // 20 Hz when running
-  const uint32_t UI_INTERVAL_IDLE   = 250;   // 4 Hz when idle
-
-  uint32_t interval = (timer.getState() == TimerState::IDLE) 
-                        ? UI_INTERVAL_IDLE 
-                        : UI_INTERVAL_ACTIVE;
-
-  if (now - last_ui_update >= interval) {
-    timer.update();
-    update_cpu_frequency();
-    update_display();
-    update_brightness();
-    last_ui_update = now;
-  }
+  // Battery, LVGL, UI refresh and idle timeout all run from the wheel
+  chores.advance(now);
 
 
   // Button handling
@@ -2517,7 +2742,6 @@ void loop() {
       Serial.println("Wake hold detected - resetting save state");
       timer.resetIdleTimer();
       timer.resetSaveState();
-      task_reset_pending = true;
       wake_button2_pending = false;
       btn2.reset();
     }
@@ -2581,9 +2805,6 @@ void loop() {
 
       if (target != current) {
         timer.selectTask(target);
-        if (task_list != nullptr && !lv_obj_has_flag(task_list, LV_OBJ_FLAG_HIDDEN)) {
-          lv_obj_scroll_to_y(task_list, target * 20, LV_ANIM_OFF);  // ← NO ANIMATION
-        }
       }
 
       
@@ -2666,4 +2887,17 @@ void loop() {
   
   // Feed the watchdog (reset timer)
   esp_task_wdt_reset();  
+
+  // ============================================================================
+  // SLEEP UNTIL THE NEXT CHORE OR INPUT
+  // ============================================================================
+  uint32_t wait_ms = chores.msUntilNext(millis());
+  if (wait_ms > MAX_LOOP_SLEEP_MS) wait_ms = MAX_LOOP_SLEEP_MS;
+  if (input_in_progress(millis()) && wait_ms > INPUT_POLL_MS) {
+    wait_ms = INPUT_POLL_MS;
+  }
+  if (wait_ms > 0) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
+  }
+
 }
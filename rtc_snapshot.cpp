@@ -0,0 +1,117 @@
+#include "rtc_snapshot.h"
+#include "crc32.h"
+#include "history_codec.h"
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_attr.h"
+#else
+#define RTC_DATA_ATTR
+#endif
+
+namespace {
+
+const uint32_t SNAPSHOT_MAGIC = 0x50414E53;  // "SNAP"
+
+struct RtcSnapshot {
+    uint32_t magic;
+    uint16_t length;
+    uint8_t unsaved;
+    uint8_t reserved;
+    uint32_t crc;  // Over length, flags and the record
+    uint8_t record[STATE_RECORD_MAX];
+};
+
+const uint32_t HISTORY_MAGIC = 0x54534948;  // "HIST"
+const size_t HISTORY_BYTES = 1024;            // The whole ring at typical sizes, 78 records at worst
+
+struct RtcHistory {
+    uint32_t magic;
+    uint32_t journalSeq;
+    uint16_t records;
+    uint16_t length;
+    uint32_t crc;  // Over journalSeq, records, length and the data
+    uint8_t data[HISTORY_BYTES];
+};
+
+// Zeroed on power-on, left alone across deep sleep
+RTC_DATA_ATTR RtcSnapshot snapshot;
+RTC_DATA_ATTR RtcHistory savedHistory;
+
+uint32_t snapshotCrc(const RtcSnapshot& s) {
+    uint32_t crc = crc32(&s.length, sizeof(s.length) + 2);
+    return crc32(s.record, s.length, crc);
+}
+
+uint32_t historyCrc(const RtcHistory& h) {
+    uint32_t crc = crc32(&h.journalSeq, sizeof(h.journalSeq) + 2 * sizeof(uint16_t));
+    return crc32(h.data, h.length, crc);
+}
+
+} // namespace
+
+void storeRtcSnapshot(const uint8_t* record, size_t len, bool unsaved) {
+    if (len > sizeof(snapshot.record)) return;
+    memcpy(snapshot.record, record, len);
+    snapshot.length = (uint16_t)len;
+    snapshot.unsaved = unsaved ? 1 : 0;
+    snapshot.reserved = 0;
+    snapshot.crc = snapshotCrc(snapshot);
+    snapshot.magic = SNAPSHOT_MAGIC;
+}
+
+size_t takeRtcSnapshot(uint8_t* buf, size_t len, bool* unsaved) {
+    if (snapshot.magic != SNAPSHOT_MAGIC) return 0;
+    snapshot.magic = 0;
+    if (snapshot.length > sizeof(snapshot.record) || snapshot.length > len) return 0;
+    if (snapshotCrc(snapshot) != snapshot.crc) return 0;
+
+    memcpy(buf, snapshot.record, snapshot.length);
+    *unsaved = snapshot.unsaved != 0;
+    return snapshot.length;
+}
+
+void storeRtcHistory(const SessionHistory& history, uint32_t journalSeq) {
+    savedHistory.magic = 0;
+    uint16_t first = 0;
+    for (;;) {
+        HistoryEncoder encoder;
+        size_t used = 0;
+        uint16_t i = first;
+        for (; i < history.size(); i++) {
+            if (used + HistoryEncoder::MAX_RECORD_SIZE > HISTORY_BYTES) break;
+            used += encoder.encode(history[i], savedHistory.data + used);
+        }
+        if (i == history.size()) {
+            savedHistory.journalSeq = journalSeq;
+            savedHistory.records = (uint16_t)(history.size() - first);
+            savedHistory.length = (uint16_t)used;
+            savedHistory.crc = historyCrc(savedHistory);
+            savedHistory.magic = HISTORY_MAGIC;
+            return;
+        }
+        // The encoding restarts from the new oldest record, so retry
+        first += history.size() - i;
+    }
+}
+
+bool takeRtcHistory(SessionHistory& history, uint32_t journalSeq) {
+    if (savedHistory.magic != HISTORY_MAGIC) return false;
+    savedHistory.magic = 0;
+    if (savedHistory.journalSeq != journalSeq || savedHistory.length > HISTORY_BYTES) return false;
+    if (historyCrc(savedHistory) != savedHistory.crc) return false;
+
+    history.clear();
+    HistoryDecoder decoder;
+    size_t pos = 0;
+    for (uint16_t i = 0; i < savedHistory.records; i++) {
+        SessionRecord record;
+        size_t n = decoder.decode(savedHistory.data + pos, savedHistory.length - pos, record);
+        if (n == 0) break;
+        history.append(record);
+        pos += n;
+    }
+    if (history.size() == savedHistory.records && pos == savedHistory.length) return true;
+    history.clear();
+    return false;
+}
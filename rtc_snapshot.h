@@ -0,0 +1,30 @@
+#pragma once
+#ifndef RTC_SNAPSHOT_H
+#define RTC_SNAPSHOT_H
+#include <stddef.h>
+#include <stdint.h>
+#include "state_record.h"
+#include "session_history.h"
+
+// Copy of the state record in RTC slow memory, which keeps its contents
+// through deep sleep but not through a power cycle. It is stored right
+// before deep sleep and taken on the next wake, so resuming needs no
+// flash reads. A snapshot is handed out at most once.
+
+// `unsaved` marks a record that may not have reached flash
+void storeRtcSnapshot(const uint8_t* record, size_t len, bool unsaved);
+
+// Copy the snapshot into buf and invalidate it; returns its length, or 0
+// if there is none or it fails its checksum
+size_t takeRtcSnapshot(uint8_t* buf, size_t len, bool* unsaved);
+
+// The session history ring, compacted with HistoryEncoder and tagged with
+// the journal's next sequence number so a wake can skip re-reading the
+// journal. The oldest records are dropped if the encoding does not fit.
+void storeRtcHistory(const SessionHistory& history, uint32_t journalSeq);
+
+// Rebuild history from the RTC copy if it matches journalSeq; the copy is
+// invalidated either way
+bool takeRtcHistory(SessionHistory& history, uint32_t journalSeq);
+
+#endif
@@ -0,0 +1,8 @@
+#include "session_history.h"
+
+void SessionHistory::append(const SessionRecord& record) {
+    records[head] = record;
+    head = (head + 1) % CAPACITY;
+    if (count < CAPACITY) count++;
+    appended++;
+}
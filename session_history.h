@@ -0,0 +1,80 @@
+#pragma once
+#ifndef SESSION_HISTORY_H
+#define SESSION_HISTORY_H
+#include <stdint.h>
+
+enum class SessionKind : uint8_t {
+    WORK,
+    SHORT_BREAK,
+    LONG_BREAK
+};
+
+enum class SessionOutcome : uint8_t {
+    COMPLETED,    // Ran to TIME_UP
+    INTERRUPTED,  // Work session given up with button 1
+    RESET         // Abandoned with button 2
+};
+
+// One finished (or abandoned) session, 12 bytes.
+// startEpoch is Unix time (UTC) once the wall clock has been set with the
+// console "time" command; before that the device counts from power-on, so
+// such records sort and bucket by day but are not dates (values below
+// Clock::WALL_CLOCK_MIN_EPOCH).
+struct SessionRecord {
+    uint32_t startEpoch;   // Wall-clock start, seconds (Clock::epochSeconds)
+    uint16_t durationSec;  // Time actually run, pauses excluded
+    uint16_t pausedSec;    // Total time spent paused
+    uint8_t taskId;
+    SessionKind kind;
+    SessionOutcome outcome;
+    uint8_t reserved;
+};
+
+static_assert(sizeof(SessionRecord) == 12, "SessionRecord layout changed");
+
+// Fixed-capacity ring of the most recent sessions, no heap.
+// append() is O(1) and overwrites the oldest record once full.
+// Indexing and iteration run oldest to newest.
+class SessionHistory {
+public:
+    static const uint16_t CAPACITY = 128;
+
+    class Iterator {
+    public:
+        Iterator(const SessionHistory* history, uint16_t index) : history(history), index(index) {}
+        const SessionRecord& operator*() const { return (*history)[index]; }
+        const SessionRecord* operator->() const { return &(*history)[index]; }
+        Iterator& operator++() { index++; return *this; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+        bool operator==(const Iterator& other) const { return index == other.index; }
+    private:
+        const SessionHistory* history;
+        uint16_t index;
+    };
+
+    SessionHistory() : head(0), count(0), appended(0) {}
+
+    void append(const SessionRecord& record);
+    void clear() { head = 0; count = 0; }
+
+    uint16_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    uint32_t totalAppended() const { return appended; }  // Including overwritten records
+
+    // i = 0 is the oldest record still held
+    const SessionRecord& operator[](uint16_t i) const {
+        return records[(head + CAPACITY - count + i) % CAPACITY];
+    }
+    const SessionRecord& newest() const { return (*this)[count - 1]; }
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, count); }
+
+private:
+    SessionRecord records[CAPACITY];
+    uint16_t head;   // Next slot to write
+    uint16_t count;
+    uint32_t appended;
+};
+
+#endif
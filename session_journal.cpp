@@ -0,0 +1,295 @@
+#include "session_journal.h"
+#include "crc32.h"
+#include <stddef.h>
+#include <string.h>
+
+namespace {
+
+const uint32_t JOURNAL_MAGIC = 0x4C4E524A;  // "JRNL"
+const uint32_t BLANK = 0xFFFFFFFF;
+
+// On-flash layouts
+struct SectorHeader {
+    uint32_t magic;       // Written after erase
+    uint32_t erases;
+    uint32_t eraseCrc;
+    uint32_t sectorSeq;   // Written when opened
+    uint32_t firstSeq;
+    uint32_t openCrc;
+    uint32_t reserved[2];
+};
+
+struct JournalEntry {
+    uint32_t seq;
+    SessionRecord record;
+    uint32_t crc;         // Over seq and record
+};
+
+const size_t OPEN_OFFSET = offsetof(SectorHeader, sectorSeq);
+
+static_assert(sizeof(SectorHeader) == SessionJournal::HEADER_SIZE, "SectorHeader layout changed");
+static_assert(sizeof(JournalEntry) == SessionJournal::ENTRY_SIZE, "JournalEntry layout changed");
+
+bool isBlank(const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+SessionJournal::SessionJournal(FlashDevice& flash)
+  : flash(flash),
+    liveCount(0),
+    sectorCount(0),
+    slotsPerSector((FlashDevice::SECTOR_SIZE - HEADER_SIZE) / ENTRY_SIZE),
+    lastSectorSeq(0),
+    nextSeq(1),
+    mounted(false)
+{
+    memset(&counters, 0, sizeof(counters));
+}
+
+uint32_t SessionJournal::slotAddr(uint8_t sector, uint16_t slot) const {
+    return (uint32_t)sector * FlashDevice::SECTOR_SIZE + HEADER_SIZE + (uint32_t)slot * ENTRY_SIZE;
+}
+
+bool SessionJournal::readSlotSeq(uint8_t sector, uint16_t slot, uint32_t& seq) {
+    counters.mountReads++;
+    return flash.read(slotAddr(sector, slot), &seq, sizeof(seq));
+}
+
+bool SessionJournal::mount() {
+    mounted = false;
+    liveCount = 0;
+    lastSectorSeq = 0;
+    nextSeq = 1;
+    counters.mountReads = 0;
+
+    uint32_t sectors = flash.size() / FlashDevice::SECTOR_SIZE;
+    if (sectors > MAX_SECTORS) sectors = MAX_SECTORS;
+    if (sectors < 3) return false;
+    sectorCount = (uint8_t)sectors;
+
+    // Classify every sector from its header alone
+    for (uint8_t i = 0; i < sectorCount; i++) {
+        SectorHeader h;
+        counters.mountReads++;
+        if (!flash.read((uint32_t)i * FlashDevice::SECTOR_SIZE, &h, sizeof(h))) return false;
+
+        Sector& s = table[i];
+        s.used = 0;
+        s.erases = 0;
+        s.state = SectorState::DIRTY;
+        if (h.magic != JOURNAL_MAGIC || crc32(&h, 2 * sizeof(uint32_t)) != h.eraseCrc) continue;
+
+        s.erases = h.erases;
+        if (h.sectorSeq == BLANK && h.firstSeq == BLANK && h.openCrc == BLANK) {
+            s.state = SectorState::ERASED;
+        } else if (crc32(&h.sectorSeq, 2 * sizeof(uint32_t)) == h.openCrc) {
+            s.state = SectorState::LIVE;
+            s.sectorSeq = h.sectorSeq;
+            s.firstSeq = h.firstSeq;
+            // Insertion into open order; there are at most MAX_SECTORS
+            uint8_t pos = liveCount++;
+            while (pos > 0 && table[order[pos - 1]].sectorSeq > s.sectorSeq) {
+                order[pos] = order[pos - 1];
+                pos--;
+            }
+            order[pos] = i;
+            if (s.sectorSeq > lastSectorSeq) lastSectorSeq = s.sectorSeq;
+        }
+    }
+
+    // Older sectors are full up to where their successor starts
+    for (uint8_t k = 0; k + 1 < liveCount; k++) {
+        Sector& s = table[order[k]];
+        uint32_t span = table[order[k + 1]].firstSeq - s.firstSeq;
+        s.used = (span < slotsPerSector) ? (uint16_t)span : slotsPerSector;
+    }
+
+    if (liveCount > 0) {
+        scanHead(head());
+        nextSeq = table[head()].firstSeq + table[head()].used;
+    }
+    mounted = true;
+    return true;
+}
+
+// Slots fill in order, so written slots are a prefix: binary search for
+// the first blank sequence field, then make sure that slot is really blank
+void SessionJournal::scanHead(uint8_t sector) {
+    uint16_t lo = 0;
+    uint16_t hi = slotsPerSector;
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        uint32_t seq = 0;
+        if (readSlotSeq(sector, mid, seq) && seq == BLANK) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    uint16_t used = lo;
+    if (used < slotsPerSector) {
+        JournalEntry e;
+        counters.mountReads++;
+        if (!flash.read(slotAddr(sector, used), &e, sizeof(e)) || !isBlank(&e, sizeof(e))) {
+            // Power was cut mid-write; the slot keeps its sequence number
+            // but is never read back or written again
+            used++;
+            counters.tornSlots++;
+        }
+    }
+    if (used > 0 && used == lo) {
+        // A cut after the sequence number leaves a slot the search counts
+        // as written; only its CRC tells
+        JournalEntry e;
+        counters.mountReads++;
+        if (!flash.read(slotAddr(sector, used - 1), &e, sizeof(e)) ||
+            crc32(&e, offsetof(JournalEntry, crc)) != e.crc) {
+            counters.tornSlots++;
+        }
+    }
+    table[sector].used = used;
+}
+
+bool SessionJournal::append(const SessionRecord& record) {
+    if (!mounted) return false;
+    uint8_t h = head();
+    if (h == NONE || table[h].used >= slotsPerSector) {
+        if (!openSector()) return false;
+        h = head();
+    }
+
+    JournalEntry e;
+    e.seq = nextSeq;
+    e.record = record;
+    e.crc = crc32(&e, offsetof(JournalEntry, crc));
+
+    bool ok = flash.write(slotAddr(h, table[h].used), &e, sizeof(e));
+    // A failed write still consumes the slot and its sequence number
+    table[h].used++;
+    nextSeq++;
+    if (ok) counters.appends++;
+    return ok;
+}
+
+uint8_t SessionJournal::pickSector(SectorState state) const {
+    uint8_t best = NONE;
+    for (uint8_t i = 0; i < sectorCount; i++) {
+        if (table[i].state != state) continue;
+        if (best == NONE || table[i].erases < table[best].erases) best = i;
+    }
+    return best;
+}
+
+void SessionJournal::retireOldest() {
+    if (liveCount == 0) return;
+    table[order[0]].state = SectorState::DIRTY;
+    memmove(order, order + 1, liveCount - 1);
+    liveCount--;
+    counters.retiredSectors++;
+}
+
+bool SessionJournal::eraseSector(uint8_t sector) {
+    uint32_t addr = (uint32_t)sector * FlashDevice::SECTOR_SIZE;
+    if (!flash.erase(addr)) return false;
+
+    SectorHeader h;
+    h.magic = JOURNAL_MAGIC;
+    h.erases = table[sector].erases + 1;
+    h.eraseCrc = crc32(&h, 2 * sizeof(uint32_t));
+    if (!flash.write(addr, &h, OPEN_OFFSET)) return false;
+
+    table[sector].erases = h.erases;
+    table[sector].used = 0;
+    table[sector].state = SectorState::ERASED;
+    return true;
+}
+
+bool SessionJournal::openSector() {
+    // Always leave one non-live sector to open next
+    if (liveCount >= sectorCount - 1) retireOldest();
+
+    uint8_t next = pickSector(SectorState::ERASED);
+    if (next == NONE) {
+        next = pickSector(SectorState::DIRTY);
+        if (next == NONE || !eraseSector(next)) return false;
+        counters.inlineErases++;
+    }
+
+    uint32_t open[3];
+    open[0] = lastSectorSeq + 1;
+    open[1] = nextSeq;
+    open[2] = crc32(open, 2 * sizeof(uint32_t));
+    if (!flash.write((uint32_t)next * FlashDevice::SECTOR_SIZE + OPEN_OFFSET, open, sizeof(open))) {
+        table[next].state = SectorState::DIRTY;
+        return false;
+    }
+
+    Sector& s = table[next];
+    s.state = SectorState::LIVE;
+    s.sectorSeq = open[0];
+    s.firstSeq = nextSeq;
+    s.used = 0;
+    order[liveCount++] = next;
+    lastSectorSeq = open[0];
+    counters.sectorOpens++;
+    return true;
+}
+
+bool SessionJournal::needsCompaction() const {
+    return mounted && pickSector(SectorState::DIRTY) != NONE;
+}
+
+bool SessionJournal::compact() {
+    if (!mounted) return false;
+    uint8_t victim = pickSector(SectorState::DIRTY);
+    if (victim == NONE) return false;
+    if (eraseSector(victim)) counters.compactErases++;
+    return needsCompaction();
+}
+
+bool SessionJournal::format() {
+    uint32_t sectors = flash.size() / FlashDevice::SECTOR_SIZE;
+    if (sectors > MAX_SECTORS) sectors = MAX_SECTORS;
+    for (uint32_t i = 0; i < sectors; i++) {
+        SectorHeader h;
+        uint32_t erases = 0;
+        // Carry erase counts over so wear levelling survives a format
+        if (flash.read(i * FlashDevice::SECTOR_SIZE, &h, sizeof(h)) &&
+            h.magic == JOURNAL_MAGIC && crc32(&h, 2 * sizeof(uint32_t)) == h.eraseCrc) {
+            erases = h.erases;
+        }
+        table[i].erases = erases;
+        if (!eraseSector((uint8_t)i)) return false;
+    }
+    return mount();
+}
+
+uint32_t SessionJournal::count() const {
+    return liveCount ? nextSeq - table[order[0]].firstSeq : 0;
+}
+
+bool SessionJournal::readNewest(uint32_t back, SessionRecord& out) const {
+    if (back >= count()) return false;
+    uint32_t seq = nextSeq - 1 - back;
+
+    for (int8_t k = liveCount - 1; k >= 0; k--) {
+        const Sector& s = table[order[k]];
+        if (seq < s.firstSeq) continue;
+        uint32_t slot = seq - s.firstSeq;
+        if (slot >= s.used) return false;
+
+        JournalEntry e;
+        if (!flash.read(slotAddr(order[k], (uint16_t)slot), &e, sizeof(e))) return false;
+        if (e.seq != seq || crc32(&e, offsetof(JournalEntry, crc)) != e.crc) return false;
+        out = e.record;
+        return true;
+    }
+    return false;
+}
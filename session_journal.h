@@ -0,0 +1,101 @@
+#pragma once
+#ifndef SESSION_JOURNAL_H
+#define SESSION_JOURNAL_H
+#include <stdint.h>
+#include "flash_device.h"
+#include "session_history.h"
+
+// Append-only log of SessionRecords on a raw flash partition.
+//
+// Each sector starts with a header; the rest holds fixed-size entries
+// (sequence number + record + CRC). The header is written in two steps:
+// after an erase (magic, erase count) and when the sector is opened as
+// the new head (sector sequence, first entry sequence), so a sector's
+// state survives a reboot without scanning it:
+//
+//   no valid header       -> DIRTY   (needs an erase before use)
+//   erase part only       -> ERASED  (ready to open)
+//   both parts            -> LIVE    (holds entries)
+//
+// Entry sequence numbers follow slot positions, so an entry is found by
+// arithmetic and mount() only binary-searches the head sector for its
+// first blank slot. When every other sector is live, opening a new head
+// retires the oldest one; the journal keeps at least capacity() entries.
+// Retired sectors are erased by compact() in idle time, and the next
+// head is the ready sector with the fewest erases.
+struct JournalStats {
+    uint32_t appends;
+    uint32_t sectorOpens;
+    uint32_t retiredSectors;
+    uint32_t compactErases;  // Erases done ahead of time by compact()
+    uint32_t inlineErases;   // Erases append() had to wait for
+    uint32_t tornSlots;      // Half-written slots skipped at mount
+    uint32_t mountReads;     // Flash reads made by the last mount()
+};
+
+class SessionJournal {
+public:
+    static const uint8_t MAX_SECTORS = 64;
+    static const uint32_t HEADER_SIZE = 32;
+    static const uint32_t ENTRY_SIZE = 20;
+
+    explicit SessionJournal(FlashDevice& flash);
+
+    // Recover the log from flash; false if the region is unusable
+    bool mount();
+    // Erase everything and mount an empty journal
+    bool format();
+    bool isMounted() const { return mounted; }
+
+    bool append(const SessionRecord& record);
+
+    // back = 0 is the newest entry; false if missing or corrupt
+    bool readNewest(uint32_t back, SessionRecord& out) const;
+    uint32_t count() const;
+    uint32_t capacity() const { return (uint32_t)(sectorCount - 2) * slotsPerSector; }
+    uint32_t nextSequence() const { return nextSeq; }
+
+    // Erase one retired sector; returns true while more are waiting
+    bool compact();
+    bool needsCompaction() const;
+
+    uint8_t sectors() const { return sectorCount; }
+    uint16_t slots() const { return slotsPerSector; }
+    uint32_t sectorErases(uint8_t sector) const { return table[sector].erases; }
+    const JournalStats& stats() const { return counters; }
+
+private:
+    enum class SectorState : uint8_t { DIRTY, ERASED, LIVE };
+
+    struct Sector {
+        uint32_t sectorSeq;  // Open order of LIVE sectors
+        uint32_t firstSeq;   // Sequence number of slot 0
+        uint32_t erases;     // From the header; 0 when unknown
+        uint16_t used;       // Slots consumed (written or torn)
+        SectorState state;
+    };
+
+    static const uint8_t NONE = 0xFF;
+
+    FlashDevice& flash;
+    Sector table[MAX_SECTORS];
+    uint8_t order[MAX_SECTORS];  // LIVE sectors, oldest first
+    uint8_t liveCount;
+    uint8_t sectorCount;
+    uint16_t slotsPerSector;
+    uint32_t lastSectorSeq;
+    uint32_t nextSeq;
+    bool mounted;
+    JournalStats counters;
+
+    uint8_t head() const { return liveCount ? order[liveCount - 1] : NONE; }
+    uint32_t slotAddr(uint8_t sector, uint16_t slot) const;
+    bool readSlotSeq(uint8_t sector, uint16_t slot, uint32_t& seq);
+    void scanHead(uint8_t sector);
+    bool openSector();
+    bool eraseSector(uint8_t sector);
+    void retireOldest();
+    uint8_t pickSector(SectorState state) const;
+};
+
+#endif
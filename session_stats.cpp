@@ -0,0 +1,76 @@
+#include "session_stats.h"
+#include <string.h>
+
+void SessionStats::reset() {
+    completed = 0;
+    interrupted = 0;
+    focusedSec = 0;
+    streak = 0;
+    lastCompletedDay = NO_DAY;
+    memset(days, 0, sizeof(days));
+    for (uint8_t i = 0; i < DAY_BUCKETS; i++) days[i].day = NO_DAY;
+}
+
+void SessionStats::setTotals(uint16_t completedCount, uint16_t interruptedCount) {
+    completed = completedCount;
+    interrupted = interruptedCount;
+}
+
+DayStats& SessionStats::bucketFor(uint16_t day) {
+    DayStats& bucket = days[day % DAY_BUCKETS];
+    if (bucket.day != day) {
+        // Slot still holds a day that fell out of the window
+        bucket.day = day;
+        bucket.completed = 0;
+        bucket.interrupted = 0;
+        bucket.focusedSec = 0;
+    }
+    return bucket;
+}
+
+void SessionStats::record(const SessionRecord& record) {
+    if (record.kind != SessionKind::WORK) return;
+
+    uint16_t today = dayNumber(record.startEpoch);
+    DayStats& bucket = bucketFor(today);
+    bucket.focusedSec += record.durationSec;
+    focusedSec += record.durationSec;
+
+    if (record.outcome == SessionOutcome::COMPLETED) {
+        if (bucket.completed < 0xFF) bucket.completed++;
+        if (lastCompletedDay == NO_DAY || today > lastCompletedDay + 1) {
+            streak = 1;
+        } else if (today == lastCompletedDay + 1) {
+            streak++;
+        }
+        lastCompletedDay = today;
+    } else if (record.outcome == SessionOutcome::INTERRUPTED) {
+        if (bucket.interrupted < 0xFF) bucket.interrupted++;
+    }
+}
+
+uint16_t SessionStats::streakDays(uint32_t todayEpoch) const {
+    uint16_t today = dayNumber(todayEpoch);
+    if (lastCompletedDay == NO_DAY || today > lastCompletedDay + 1) return 0;
+    return streak;
+}
+
+const DayStats* SessionStats::day(uint32_t epoch) const {
+    uint16_t d = dayNumber(epoch);
+    const DayStats& bucket = days[d % DAY_BUCKETS];
+    return (bucket.day == d) ? &bucket : nullptr;
+}
+
+void SessionStats::save(Snapshot& out) const {
+    out.focusedSec = focusedSec;
+    out.streak = streak;
+    out.lastCompletedDay = lastCompletedDay;
+    memcpy(out.days, days, sizeof(days));
+}
+
+void SessionStats::restore(const Snapshot& in) {
+    focusedSec = in.focusedSec;
+    streak = in.streak;
+    lastCompletedDay = in.lastCompletedDay;
+    memcpy(days, in.days, sizeof(days));
+}
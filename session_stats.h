@@ -0,0 +1,72 @@
+#pragma once
+#ifndef SESSION_STATS_H
+#define SESSION_STATS_H
+#include <stdint.h>
+#include "session_history.h"
+
+const uint32_t SECONDS_PER_DAY = 86400UL;
+
+// Work done on one calendar day (UTC day number = epoch / 86400)
+struct DayStats {
+    uint16_t day;
+    uint8_t completed;
+    uint8_t interrupted;
+    uint32_t focusedSec;
+};
+
+// Running statistics, updated incrementally as sessions finish.
+// Every query is O(1); nothing rescans tasks or history. Focus time is
+// the time sessions actually ran, so changing the pomodoro length
+// mid-day does not rewrite earlier work.
+class SessionStats {
+public:
+    static const uint8_t DAY_BUCKETS = 7;  // Per-day window, one bucket per day
+    static const uint16_t NO_DAY = 0xFFFF;
+
+    SessionStats() { reset(); }
+    void reset();
+
+    // Feed one finished session
+    void record(const SessionRecord& record);
+
+    // Completed / interrupted totals mirror the per-task counters, which
+    // can also be edited from the menu; TimerCore keeps them in sync
+    void setTotals(uint16_t completed, uint16_t interrupted);
+    void addCompleted() { completed++; }
+    void addInterrupted() { interrupted++; }
+
+    uint16_t totalCompleted() const { return completed; }
+    uint16_t totalInterrupted() const { return interrupted; }
+    uint32_t focusedSeconds() const { return focusedSec; }
+    uint16_t focusedMinutes() const { return (uint16_t)(focusedSec / 60); }
+
+    // Consecutive days with a completed pomodoro, ending today or yesterday
+    uint16_t streakDays(uint32_t todayEpoch) const;
+
+    // Bucket for a day inside the window, or nullptr
+    const DayStats* day(uint32_t epoch) const;
+
+    static uint16_t dayNumber(uint32_t epoch) { return (uint16_t)(epoch / SECONDS_PER_DAY); }
+
+    // Persisted part (everything but the counter mirrors), as a flat blob
+    struct Snapshot {
+        uint32_t focusedSec;
+        uint16_t streak;
+        uint16_t lastCompletedDay;
+        DayStats days[DAY_BUCKETS];
+    };
+    void save(Snapshot& out) const;
+    void restore(const Snapshot& in);
+
+private:
+    uint16_t completed;
+    uint16_t interrupted;
+    uint32_t focusedSec;
+    uint16_t streak;
+    uint16_t lastCompletedDay;  // NO_DAY until the first completion
+    DayStats days[DAY_BUCKETS];
+
+    DayStats& bucketFor(uint16_t day);
+};
+
+#endif
@@ -0,0 +1,98 @@
+#include "settings_store.h"
+#include <string.h>
+
+MemorySettingsStore::Entry* MemorySettingsStore::find(const char* key) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (strcmp(entries[i].key, key) == 0) return &entries[i];
+    }
+    return nullptr;
+}
+
+size_t MemorySettingsStore::getBytesLength(const char* key) {
+    Entry* entry = find(key);
+    return entry ? entry->len : 0;
+}
+
+size_t MemorySettingsStore::getBytes(const char* key, void* buf, size_t len) {
+    Entry* entry = find(key);
+    if (entry == nullptr || len < entry->len) return 0;
+    memcpy(buf, entry->value, entry->len);
+    return entry->len;
+}
+
+size_t MemorySettingsStore::putBytes(const char* key, const void* value, size_t len) {
+    if (strlen(key) >= KEY_MAX || len > VALUE_MAX) return 0;
+    Entry* entry = find(key);
+    if (entry == nullptr) {
+        if (count >= MAX_KEYS) return 0;
+        entry = &entries[count++];
+        strcpy(entry->key, key);
+    }
+    memcpy(entry->value, value, len);
+    entry->len = len;
+    return len;
+}
+
+bool MemorySettingsStore::clear() {
+    count = 0;
+    return true;
+}
+
+uint8_t MemorySettingsStore::getUChar(const char* key, uint8_t defaultValue) {
+    Entry* entry = find(key);
+    return (entry != nullptr && entry->len == 1) ? entry->value[0] : defaultValue;
+}
+
+bool MemorySettingsStore::getBool(const char* key, bool defaultValue) {
+    Entry* entry = find(key);
+    return (entry != nullptr && entry->len == 1) ? entry->value[0] != 0 : defaultValue;
+}
+
+#ifdef ESP_PLATFORM
+#include <Preferences.h>
+
+static Preferences nvsPrefs;
+
+bool NvsSettingsStore::open() {
+    if (!opened) opened = nvsPrefs.begin("pomodoro", false);
+    return opened;
+}
+
+size_t NvsSettingsStore::getBytesLength(const char* key) {
+    return open() ? nvsPrefs.getBytesLength(key) : 0;
+}
+
+size_t NvsSettingsStore::getBytes(const char* key, void* buf, size_t len) {
+    return open() ? nvsPrefs.getBytes(key, buf, len) : 0;
+}
+
+size_t NvsSettingsStore::putBytes(const char* key, const void* value, size_t len) {
+    return open() ? nvsPrefs.putBytes(key, value, len) : 0;
+}
+
+bool NvsSettingsStore::isKey(const char* key) {
+    return open() && nvsPrefs.isKey(key);
+}
+
+bool NvsSettingsStore::clear() {
+    return open() && nvsPrefs.clear();
+}
+
+uint8_t NvsSettingsStore::getUChar(const char* key, uint8_t defaultValue) {
+    return open() ? nvsPrefs.getUChar(key, defaultValue) : defaultValue;
+}
+
+bool NvsSettingsStore::getBool(const char* key, bool defaultValue) {
+    return open() ? nvsPrefs.getBool(key, defaultValue) : defaultValue;
+}
+
+SettingsStore& settingsStore() {
+    static NvsSettingsStore store;
+    return store;
+}
+#else
+SettingsStore& settingsStore() {
+    static MemorySettingsStore store;
+    return store;
+}
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+#include <stddef.h>
+#include <stdint.h>
+
+// The "pomodoro" key-value namespace: the state record when the flash
+// slots are not mounted, and the per-key settings of older firmware that
+// loadState() migrates. NVS (Preferences) on the device, RAM on the host.
+class SettingsStore {
+public:
+    virtual ~SettingsStore() {}
+    virtual size_t getBytesLength(const char* key) = 0;  // 0 if missing
+    virtual size_t getBytes(const char* key, void* buf, size_t len) = 0;
+    virtual size_t putBytes(const char* key, const void* value, size_t len) = 0;
+    virtual bool isKey(const char* key) = 0;
+    virtual bool clear() = 0;  // Drop every key
+
+    // One-byte keys written by older firmware
+    virtual uint8_t getUChar(const char* key, uint8_t defaultValue) = 0;
+    virtual bool getBool(const char* key, bool defaultValue) = 0;
+};
+
+// RAM-backed store for host runs; starts empty
+class MemorySettingsStore : public SettingsStore {
+public:
+    static const uint8_t MAX_KEYS = 48;
+    static const uint8_t KEY_MAX = 16;     // NVS key limit, terminator included
+    static const size_t VALUE_MAX = 768;   // Room for a full state record
+
+    MemorySettingsStore() { clear(); }
+
+    size_t getBytesLength(const char* key) override;
+    size_t getBytes(const char* key, void* buf, size_t len) override;
+    size_t putBytes(const char* key, const void* value, size_t len) override;
+    bool isKey(const char* key) override { return find(key) != nullptr; }
+    bool clear() override;
+    uint8_t getUChar(const char* key, uint8_t defaultValue) override;
+    bool getBool(const char* key, bool defaultValue) override;
+
+    uint8_t size() const { return count; }
+
+private:
+    struct Entry {
+        char key[KEY_MAX];
+        uint8_t value[VALUE_MAX];
+        size_t len;
+    };
+
+    Entry entries[MAX_KEYS];
+    uint8_t count;
+
+    Entry* find(const char* key);
+};
+
+#ifdef ESP_PLATFORM
+// NVS namespace "pomodoro", opened read-write on first use and kept open
+class NvsSettingsStore : public SettingsStore {
+public:
+    NvsSettingsStore() : opened(false) {}
+
+    size_t getBytesLength(const char* key) override;
+    size_t getBytes(const char* key, void* buf, size_t len) override;
+    size_t putBytes(const char* key, const void* value, size_t len) override;
+    bool isKey(const char* key) override;
+    bool clear() override;
+    uint8_t getUChar(const char* key, uint8_t defaultValue) override;
+    bool getBool(const char* key, bool defaultValue) override;
+
+private:
+    bool opened;
+    bool open();
+};
+#endif
+
+// NVS on the device, a MemorySettingsStore on the host
+SettingsStore& settingsStore();
+
+#endif
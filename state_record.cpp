@@ -0,0 +1,63 @@
+#include "state_record.h"
+#include "crc32.h"
+#include <string.h>
+
+size_t sealStateRecord(uint8_t* buf, size_t payloadLen) {
+    StateHeader header;
+    header.magic = STATE_MAGIC;
+    header.version = STATE_VERSION;
+    header.length = (uint16_t)payloadLen;
+    header.crc = crc32(buf + sizeof(StateHeader), payloadLen);
+    memcpy(buf, &header, sizeof(header));
+    return sizeof(header) + payloadLen;
+}
+
+const uint8_t* openStateRecord(const uint8_t* buf, size_t len,
+                               size_t* payloadLen, uint16_t* version) {
+    if (len < sizeof(StateHeader)) return nullptr;
+
+    StateHeader header;
+    memcpy(&header, buf, sizeof(header));
+    if (header.magic != STATE_MAGIC) return nullptr;
+    if (header.length != len - sizeof(header)) return nullptr;
+
+    const uint8_t* payload = buf + sizeof(header);
+    if (crc32(payload, header.length) != header.crc) return nullptr;
+
+    *payloadLen = header.length;
+    *version = header.version;
+    return payload;
+}
+
+size_t sealStateFrame(uint8_t* frame, size_t recordLen) {
+    uint16_t length = (uint16_t)recordLen;
+    memcpy(frame, &STATE_FRAME_MAGIC, sizeof(STATE_FRAME_MAGIC));
+    memcpy(frame + 4, &length, sizeof(length));
+    size_t body = STATE_FRAME_HEADER + recordLen;
+    uint32_t crc = crc32(frame, body);
+    memcpy(frame + body, &crc, sizeof(crc));
+    return body + sizeof(crc);
+}
+
+size_t stateFrameLength(const uint8_t* header) {
+    uint32_t magic;
+    uint16_t length;
+    memcpy(&magic, header, sizeof(magic));
+    memcpy(&length, header + 4, sizeof(length));
+    if (magic != STATE_FRAME_MAGIC || length < sizeof(StateHeader) || length > STATE_RECORD_MAX) {
+        return 0;
+    }
+    return STATE_FRAME_HEADER + length + sizeof(uint32_t);
+}
+
+const uint8_t* openStateFrame(const uint8_t* frame, size_t len, size_t* recordLen) {
+    if (len < STATE_FRAME_HEADER || stateFrameLength(frame) != len) return nullptr;
+
+    size_t body = len - sizeof(uint32_t);
+    uint32_t crc;
+    memcpy(&crc, frame + body, sizeof(crc));
+    if (crc32(frame, body) != crc) return nullptr;
+
+    *recordLen = body - STATE_FRAME_HEADER;
+    return frame + STATE_FRAME_HEADER;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#ifndef STATE_RECORD_H
+#define STATE_RECORD_H
+#include <stddef.h>
+#include <stdint.h>
+#include "flash_telemetry.h"
+#include "session_stats.h"
+#include "task_store.h"
+
+// Everything TimerCore persists, as one record (see StateSlots):
+//
+//   StateHeader | StateSettings | SessionStats::Snapshot |
+//   FlashTelemetry::Snapshot | TaskStore record
+//
+// The header carries a schema version and a CRC-32 over the payload, so a
+// torn or foreign blob is rejected instead of loading garbage. Version 0 is
+// the old one-key-per-setting layout, which TimerCore migrates on load;
+// version 1 lacks the flash telemetry.
+const uint32_t STATE_MAGIC = 0x52444D50;  // "PMDR"
+const uint16_t STATE_VERSION = 2;
+
+struct StateHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;  // Payload bytes following the header
+    uint32_t crc;     // CRC-32 of the payload
+};
+
+// Scalar settings, one byte each so the layout has no padding
+struct StateSettings {
+    uint8_t currentTask;
+    uint8_t workDuration;
+    uint8_t shortBreak;
+    uint8_t longBreak;
+    uint8_t pomosBeforeLong;
+    uint8_t pomosSince;
+    uint8_t idleTimeoutBattery;
+    uint8_t idleTimeoutUSB;
+    uint8_t sleepOnUSB;
+    uint8_t brightness;
+    uint8_t theme;
+    uint8_t screenFlipped;
+    uint8_t windupEnabled;
+    uint8_t alarmDuration;
+    uint8_t alarmVibration;
+    uint8_t alarmFlash;
+};
+static_assert(sizeof(StateSettings) == 16, "StateSettings layout is part of the record format");
+
+// Version 1 minimum; version 2 adds the telemetry snapshot
+const size_t STATE_PAYLOAD_MIN = sizeof(StateSettings) + sizeof(SessionStats::Snapshot) + 3;
+const size_t STATE_RECORD_MAX = sizeof(StateHeader) + sizeof(StateSettings) +
+                                sizeof(SessionStats::Snapshot) + sizeof(FlashTelemetry::Snapshot) +
+                                TaskStore::MAX_RECORD_SIZE;
+
+// Fill in the header for `payloadLen` bytes already written after it.
+// Returns the total record length.
+size_t sealStateRecord(uint8_t* buf, size_t payloadLen);
+
+// Check magic, length and CRC. Returns the payload (and its length and
+// version) or nullptr if the record is not usable.
+const uint8_t* openStateRecord(const uint8_t* buf, size_t len,
+                               size_t* payloadLen, uint16_t* version);
+
+// Transfer frame for serial export/import:
+//
+//   "PMDX" | uint16 record length | sealed record | CRC-32 of all before it
+//
+// The frame CRC catches transport damage; the record keeps its own
+// version and CRC.
+const uint32_t STATE_FRAME_MAGIC = 0x58444D50;  // "PMDX"
+const size_t STATE_FRAME_HEADER = 6;
+const size_t STATE_FRAME_MAX = STATE_FRAME_HEADER + STATE_RECORD_MAX + 4;
+
+// Wrap a record already placed at frame + STATE_FRAME_HEADER.
+// Returns the frame length.
+size_t sealStateFrame(uint8_t* frame, size_t recordLen);
+
+// Frame length announced by the first STATE_FRAME_HEADER bytes, 0 if
+// they are not a frame header
+size_t stateFrameLength(const uint8_t* header);
+
+// Check the frame CRC. Returns the record (and its length) or nullptr.
+const uint8_t* openStateFrame(const uint8_t* frame, size_t len, size_t* recordLen);
+
+#endif
@@ -0,0 +1,167 @@
+#include "state_slots.h"
+#include "crc32.h"
+#include <string.h>
+
+namespace {
+
+const uint32_t SLOT_MAGIC = 0x424F4C53;  // "SLOB"
+
+struct SlotHeader {
+    uint32_t magic;
+    uint32_t generation;
+    uint32_t length;
+    uint32_t crc;  // Over generation, length and the record
+};
+
+static_assert(sizeof(SlotHeader) == StateSlots::HEADER_SIZE, "SlotHeader layout changed");
+static_assert(sizeof(SlotHeader) + STATE_RECORD_MAX <= FlashDevice::SECTOR_SIZE,
+              "State record must fit one flash sector");
+
+uint32_t slotCrc(const SlotHeader& header, const uint8_t* record) {
+    uint32_t crc = crc32(&header.generation, 2 * sizeof(uint32_t));
+    return crc32(record, header.length, crc);
+}
+
+} // namespace
+
+StateSlots::StateSlots(FlashDevice& flash)
+  : flash(flash),
+    active(NONE),
+    bytesRead(0),
+    mounted(false)
+{
+    memset(slots, 0, sizeof(slots));
+}
+
+bool StateSlots::mount() {
+    mounted = false;
+    active = NONE;
+    bytesRead = 0;
+    if (flash.size() < SLOT_COUNT * FlashDevice::SECTOR_SIZE) return false;
+
+    for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+        SlotHeader header;
+        Slot& slot = slots[i];
+        slot.present = false;
+        if (!flash.read(i * FlashDevice::SECTOR_SIZE, &header, sizeof(header))) continue;
+        bytesRead += sizeof(header);
+        if (header.magic != SLOT_MAGIC || header.length > STATE_RECORD_MAX) continue;
+        slot.generation = header.generation;
+        slot.length = header.length;
+        slot.crc = header.crc;
+        slot.present = true;
+    }
+    mounted = true;
+    return true;
+}
+
+uint8_t StateSlots::newestPresent() const {
+    uint8_t pick = NONE;
+    for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+        if (!slots[i].present) continue;
+        if (pick == NONE || slots[i].generation > slots[pick].generation) pick = i;
+    }
+    return pick;
+}
+
+uint8_t StateSlots::newestValid() {
+    for (uint8_t attempt = 0; attempt < SLOT_COUNT; attempt++) {
+        uint8_t pick = newestPresent();
+        if (pick == NONE) return NONE;
+
+        Slot& slot = slots[pick];
+        SlotHeader header;
+        header.generation = slot.generation;
+        header.length = slot.length;
+        uint32_t crc = crc32(&header.generation, 2 * sizeof(uint32_t));
+        uint32_t addr = pick * FlashDevice::SECTOR_SIZE + sizeof(SlotHeader);
+        uint8_t chunk[64];
+        bool readOk = true;
+        for (uint32_t done = 0; done < slot.length && readOk; done += sizeof(chunk)) {
+            uint32_t n = slot.length - done < sizeof(chunk) ? slot.length - done : sizeof(chunk);
+            readOk = flash.read(addr + done, chunk, n);
+            crc = crc32(chunk, n, crc);
+        }
+        if (readOk && crc == slot.crc) return pick;
+        slot.present = false;
+    }
+    return NONE;
+}
+
+size_t StateSlots::load(uint8_t* buf, size_t len) {
+    if (!mounted) return 0;
+
+    // Newest first; fall back to the other slot if its record is torn
+    for (uint8_t attempt = 0; attempt < SLOT_COUNT; attempt++) {
+        uint8_t pick = newestPresent();
+        if (pick == NONE) return 0;
+
+        Slot& slot = slots[pick];
+        SlotHeader header;
+        header.generation = slot.generation;
+        header.length = slot.length;
+        if (slot.length <= len &&
+            flash.read(pick * FlashDevice::SECTOR_SIZE + sizeof(SlotHeader), buf, slot.length)) {
+            bytesRead += slot.length;
+            if (slotCrc(header, buf) == slot.crc) {
+                active = pick;
+                return slot.length;
+            }
+        }
+        slot.present = false;
+    }
+    return 0;
+}
+
+bool StateSlots::store(const uint8_t* record, size_t len) {
+    if (!mounted || len > STATE_RECORD_MAX) return false;
+
+    // Without a load() (state restored from elsewhere) keep the newest
+    // slot whose record checks out; a torn header alone must not send the
+    // write over the only good copy
+    uint8_t current = (active != NONE) ? active : newestValid();
+    uint8_t target = (current == 0) ? 1 : 0;
+    uint32_t addr = target * FlashDevice::SECTOR_SIZE;
+
+    SlotHeader header;
+    header.magic = SLOT_MAGIC;
+    header.generation = (current != NONE ? slots[current].generation : 0) + 1;
+    header.length = (uint32_t)len;
+    header.crc = slotCrc(header, record);
+
+    // Invalidate the target before anything else touches it
+    slots[target].present = false;
+    if (!flash.erase(addr)) return false;
+    if (!flash.write(addr + sizeof(header), record, len)) return false;
+    if (!flash.write(addr, &header, sizeof(header))) return false;
+
+    slots[target].generation = header.generation;
+    slots[target].length = header.length;
+    slots[target].crc = header.crc;
+    slots[target].present = true;
+    active = target;
+    return true;
+}
+
+#ifdef ESP_PLATFORM
+
+StateSlots& stateSlots() {
+    static EspPartitionFlash flash;
+    static StateSlots slots(flash);
+    static bool ready = flash.begin("state") && slots.mount();
+    (void)ready;
+    return slots;
+}
+
+#else
+
+StateSlots& stateSlots() {
+    static uint8_t storage[StateSlots::SLOT_COUNT * FlashDevice::SECTOR_SIZE];
+    static SimFlash flash(storage, sizeof(storage));
+    static StateSlots slots(flash);
+    static bool ready = (flash.eraseAll(), slots.mount());
+    (void)ready;
+    return slots;
+}
+
+#endif
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef STATE_SLOTS_H
+#define STATE_SLOTS_H
+#include <stddef.h>
+#include <stdint.h>
+#include "flash_device.h"
+#include "state_record.h"
+
+// Two flash sectors written alternately with state records.
+//
+// Each slot holds a header (generation, length, CRC over both and the
+// record) followed by the record. store() erases the older slot, programs
+// the record and writes the header last, so power lost at any point leaves
+// the previous generation intact in the other slot. At boot load() reads
+// both headers and then only the newest record; the older one is read
+// only if the newest fails its CRC.
+class StateSlots {
+public:
+    static const uint8_t SLOT_COUNT = 2;
+    static const uint8_t NONE = 0xFF;
+    static const uint32_t HEADER_SIZE = 16;
+
+    explicit StateSlots(FlashDevice& flash);
+
+    bool mount();  // Read both slot headers
+    bool isMounted() const { return mounted; }
+
+    // Copy the newest valid record into buf; returns its length, 0 if none
+    size_t load(uint8_t* buf, size_t len);
+
+    // Write a sealed record to the slot not holding the current generation
+    bool store(const uint8_t* record, size_t len);
+
+    uint8_t activeSlot() const { return active; }  // NONE until a record loads or stores
+    uint32_t generation() const { return active != NONE ? slots[active].generation : 0; }
+    uint32_t readBytes() const { return bytesRead; }  // Read by the last mount() + load()
+
+private:
+    struct Slot {
+        uint32_t generation;
+        uint32_t length;
+        uint32_t crc;
+        bool present;  // Header looks sane; the record is not checked yet
+    };
+
+    FlashDevice& flash;
+    Slot slots[SLOT_COUNT];
+    uint8_t active;
+    uint32_t bytesRead;
+    bool mounted;
+
+    uint8_t newestPresent() const;
+    uint8_t newestValid();  // Streams each record through its CRC
+};
+
+// Slots on the "state" partition (a RAM simulation off-device); check
+// isMounted() before use
+StateSlots& stateSlots();
+
+#endif
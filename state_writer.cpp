@@ -0,0 +1,149 @@
+#include "state_writer.h"
+#include "state_slots.h"
+#include "flash_telemetry.h"
+#include "settings_store.h"
+#include "timer_clock.h"
+#include "core_log.h"
+#include <string.h>
+
+StateWriter::StateWriter()
+  : fill(0),
+    pending(false),
+    submitted(0),
+    attempted(0),
+    written(0),
+    lastUs(0)
+#ifdef ESP_PLATFORM
+    , task(nullptr)
+#endif
+{
+#ifdef ESP_PLATFORM
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    lock = unlocked;
+#endif
+}
+
+void StateWriter::write(const Slot& slot) {
+    Clock& clock = systemClock();
+    uint64_t start_us = clock.nowMicros();
+    StateSlots& slots = stateSlots();
+    SettingsStore& store = settingsStore();
+    // Drop every pre-record key at once; the record replaces them
+    if (slot.clearFirst) store.clear();
+    bool ok;
+    if (slots.isMounted()) {
+        ok = slots.store(slot.data, slot.len);
+    } else {
+        ok = store.putBytes("state", slot.data, slot.len) == slot.len;
+    }
+    lastUs = (uint32_t)(clock.nowMicros() - start_us);
+    if (ok) written = slot.seq;
+    attempted = slot.seq;
+    if (slots.isMounted()) {
+        flashTelemetry().record(FlashTarget::STATE_SLOTS, StateSlots::HEADER_SIZE + slot.len, 1, lastUs);
+    } else {
+        flashTelemetry().record(FlashTarget::STATE_NVS, slot.len, 0, lastUs);
+    }
+
+    if (ok && slots.isMounted()) {
+        coreLog("State #%lu written to slot %c (gen %lu): %u bytes in %lu us\n",
+                      (unsigned long)slot.seq, 'A' + slots.activeSlot(),
+                      (unsigned long)slots.generation(), (unsigned)slot.len,
+                      (unsigned long)lastUs);
+    } else {
+        coreLog("State #%lu %s: %u bytes in %lu us\n", (unsigned long)slot.seq,
+                      ok ? "written" : "write FAILED",
+                      (unsigned)slot.len, (unsigned long)lastUs);
+    }
+}
+
+#ifdef ESP_PLATFORM
+
+// Low priority on the core the Arduino loop does not use
+static const uint32_t WRITER_STACK_SIZE = 4096;
+static const UBaseType_t WRITER_PRIORITY = 1;
+static const BaseType_t WRITER_CORE = 0;
+
+void StateWriter::begin() {
+    if (task != nullptr) return;
+    xTaskCreatePinnedToCore(taskMain, "state_writer", WRITER_STACK_SIZE, this,
+                            WRITER_PRIORITY, &task, WRITER_CORE);
+}
+
+uint32_t StateWriter::submit(const uint8_t* record, size_t len, bool clearFirst) {
+    if (len > STATE_RECORD_MAX) return written;
+
+    portENTER_CRITICAL(&lock);
+    Slot& slot = slots[fill];
+    memcpy(slot.data, record, len);
+    slot.len = len;
+    slot.seq = ++submitted;
+    // A clear still owed by an overwritten record must not be lost
+    slot.clearFirst = (pending && slot.clearFirst) || clearFirst;
+    pending = true;
+    uint32_t seq = slot.seq;
+    portEXIT_CRITICAL(&lock);
+
+    if (task != nullptr) {
+        xTaskNotifyGive(task);
+    } else {
+        // Scheduler side not running yet: write on the caller
+        pending = false;
+        write(slots[fill]);
+    }
+    return seq;
+}
+
+void StateWriter::taskMain(void* arg) {
+    StateWriter* self = static_cast<StateWriter*>(arg);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        portENTER_CRITICAL(&self->lock);
+        if (!self->pending) {
+            portEXIT_CRITICAL(&self->lock);
+            continue;
+        }
+        uint8_t take = self->fill;
+        self->fill ^= 1;
+        self->pending = false;
+        portEXIT_CRITICAL(&self->lock);
+
+        self->write(self->slots[take]);
+    }
+}
+
+bool StateWriter::flush(uint32_t timeoutMs) {
+    TickType_t start = xTaskGetTickCount();
+    while (attempted != submitted) {
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeoutMs)) return false;
+        vTaskDelay(pdMS_TO_TICKS(5));
+    }
+    return written == submitted;
+}
+
+#else
+
+void StateWriter::begin() {}
+
+uint32_t StateWriter::submit(const uint8_t* record, size_t len, bool clearFirst) {
+    if (len > STATE_RECORD_MAX) return written;
+    Slot& slot = slots[fill];
+    memcpy(slot.data, record, len);
+    slot.len = len;
+    slot.seq = ++submitted;
+    slot.clearFirst = clearFirst;
+    write(slot);
+    return slot.seq;
+}
+
+bool StateWriter::flush(uint32_t) {
+    return written == submitted;
+}
+
+#endif
+
+StateWriter& stateWriter() {
+    static StateWriter writer;
+    return writer;
+}
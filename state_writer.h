@@ -0,0 +1,67 @@
+#pragma once
+#ifndef STATE_WRITER_H
+#define STATE_WRITER_H
+#include <stddef.h>
+#include <stdint.h>
+#include "state_record.h"
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+// Writes state records to flash (the A/B slots, or the settings store
+// without them) from a background FreeRTOS task.
+//
+// submit() copies the record into one of two slots and wakes the task;
+// the task swaps slots and writes the one it took while the next record
+// can already be filled in. A newer submit overwrites a record the task
+// has not picked up yet, so a burst of saves costs one write. Every
+// record gets a sequence number; flush() waits until the latest one has
+// been attempted and reports whether it reached flash. A failed write
+// leaves writtenSeq() behind until a later record lands. Before begin()
+// (and off-device) submit() writes inline.
+class StateWriter {
+public:
+    StateWriter();
+
+    void begin();  // Start the writer task
+
+    // Queue a sealed record; clearFirst wipes the namespace before writing
+    uint32_t submit(const uint8_t* record, size_t len, bool clearFirst);
+
+    // Wait up to timeoutMs for everything submitted to be written;
+    // false on timeout or if the latest write failed
+    bool flush(uint32_t timeoutMs);
+
+    uint32_t submittedSeq() const { return submitted; }
+    uint32_t writtenSeq() const { return written; }  // Last seq that reached flash
+    uint32_t lastWriteUs() const { return lastUs; }
+
+private:
+    struct Slot {
+        uint8_t data[STATE_RECORD_MAX];
+        size_t len;
+        uint32_t seq;
+        bool clearFirst;
+    };
+
+    Slot slots[2];
+    uint8_t fill;     // Slot submit() copies into; the task owns the other
+    bool pending;     // slots[fill] holds a record not yet taken
+    volatile uint32_t submitted;
+    volatile uint32_t attempted;  // Last seq the writer finished, ok or not
+    volatile uint32_t written;
+    uint32_t lastUs;
+
+#ifdef ESP_PLATFORM
+    TaskHandle_t task;
+    portMUX_TYPE lock;
+    static void taskMain(void* arg);
+#endif
+
+    void write(const Slot& slot);
+};
+
+StateWriter& stateWriter();
+
+#endif
@@ -0,0 +1,83 @@
+#include "task_store.h"
+#include <string.h>
+
+void TaskStore::clear() {
+    clearCounters();
+    active = 1;
+}
+
+void TaskStore::clearCounters() {
+    memset(completedCol, 0, sizeof(completedCol));
+    memset(interruptedCol, 0, sizeof(interruptedCol));
+    sumCompleted = 0;
+    sumInterrupted = 0;
+}
+
+// Growing or shrinking only touches the tasks entering or leaving the sums
+void TaskStore::setCount(uint8_t n) {
+    if (n < 1) n = 1;
+    while (active < n) {
+        sumCompleted += completedCol[active];
+        sumInterrupted += interruptedCol[active];
+        active++;
+    }
+    while (active > n) {
+        active--;
+        sumCompleted -= completedCol[active];
+        sumInterrupted -= interruptedCol[active];
+    }
+}
+
+void TaskStore::setCompleted(uint8_t id, uint8_t value) {
+    if (id >= MAX_TASKS) return;
+    if (id < active) sumCompleted += value - completedCol[id];
+    completedCol[id] = value;
+}
+
+void TaskStore::setInterrupted(uint8_t id, uint8_t value) {
+    if (id >= MAX_TASKS) return;
+    if (id < active) sumInterrupted += value - interruptedCol[id];
+    interruptedCol[id] = value;
+}
+
+void TaskStore::recount() {
+    sumCompleted = 0;
+    sumInterrupted = 0;
+    for (uint8_t i = 0; i < active; i++) {
+        sumCompleted += completedCol[i];
+        sumInterrupted += interruptedCol[i];
+    }
+}
+
+size_t TaskStore::save(uint8_t* buf, size_t len) const {
+    uint8_t stored = active;
+    for (uint16_t i = MAX_TASKS; i > stored; i--) {
+        if (completedCol[i - 1] || interruptedCol[i - 1]) {
+            stored = (uint8_t)i;
+            break;
+        }
+    }
+
+    size_t size = 3 + 2 * (size_t)stored;
+    if (len < size) return 0;
+    buf[0] = RECORD_VERSION;
+    buf[1] = active;
+    buf[2] = stored;
+    memcpy(buf + 3, completedCol, stored);
+    memcpy(buf + 3 + stored, interruptedCol, stored);
+    return size;
+}
+
+bool TaskStore::restore(const uint8_t* buf, size_t len) {
+    if (len < 3 || buf[0] != RECORD_VERSION) return false;
+    uint8_t count = buf[1];
+    uint8_t stored = buf[2];
+    if (count < 1 || len != 3 + 2 * (size_t)stored) return false;
+
+    clearCounters();
+    memcpy(completedCol, buf + 3, stored);
+    memcpy(interruptedCol, buf + 3 + stored, stored);
+    active = count;
+    recount();
+    return true;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#ifndef TASK_STORE_H
+#define TASK_STORE_H
+#include <stddef.h>
+#include <stdint.h>
+
+// Task ids are uint8_t, so 255 is the natural ceiling
+const uint8_t MAX_TASKS = 255;
+
+// Per-task pomodoro counters as a struct of arrays.
+//
+// Both columns are allocated once for MAX_TASKS (510 bytes, no heap);
+// count() is how many of them are active. Lookups are plain array reads
+// and the totals over the active tasks are kept up to date on every write,
+// so no query rescans the tasks. Counters of tasks beyond count() are kept,
+// so lowering and raising the task count does not lose them.
+class TaskStore {
+public:
+    static const uint8_t RECORD_VERSION = 1;
+    // Header (version, count, stored) + two columns
+    static const size_t MAX_RECORD_SIZE = 3 + 2 * (size_t)MAX_TASKS;
+
+    TaskStore() { clear(); }
+
+    // Zero every counter and go back to a single task
+    void clear();
+    void clearCounters();
+
+    uint8_t count() const { return active; }
+    void setCount(uint8_t n);  // Clamped to 1..MAX_TASKS
+
+    uint8_t completed(uint8_t id) const { return completedCol[id]; }
+    uint8_t interrupted(uint8_t id) const { return interruptedCol[id]; }
+    void setCompleted(uint8_t id, uint8_t value);
+    void setInterrupted(uint8_t id, uint8_t value);
+    void addCompleted(uint8_t id) { setCompleted(id, completedCol[id] + 1); }
+    void addInterrupted(uint8_t id) { setInterrupted(id, interruptedCol[id] + 1); }
+
+    // Sums over the active tasks
+    uint16_t totalCompleted() const { return sumCompleted; }
+    uint16_t totalInterrupted() const { return sumInterrupted; }
+
+    // Whole store as one persisted record; returns bytes written (0 if
+    // `len` is too small). Only tasks up to the last non-zero one are kept.
+    size_t save(uint8_t* buf, size_t len) const;
+    bool restore(const uint8_t* buf, size_t len);
+
+private:
+    uint8_t completedCol[MAX_TASKS];
+    uint8_t interruptedCol[MAX_TASKS];
+    uint8_t active;
+    uint16_t sumCompleted;
+    uint16_t sumInterrupted;
+
+    void recount();
+};
+
+#endif
@@ -0,0 +1,186 @@
+// ChoreWheel: cascades across the 64 ms and 4.1 s level boundaries, due
+// times past the 262 s top level, millis() wraparound, re-arming and
+// cancelling from inside a callback, and the lateness stats.
+#include "chore_wheel.h"
+#include "test_check.h"
+
+namespace {
+
+ChoreWheel wheel;
+uint32_t clockMs = 0;
+uint32_t fires[ChoreWheel::MAX_CHORES];
+uint32_t firedAt[ChoreWheel::MAX_CHORES];
+uint32_t order[64];
+uint8_t orderCount = 0;
+
+template <int N>
+void mark() {
+    fires[N]++;
+    firedAt[N] = clockMs;
+    if (orderCount < sizeof(order) / sizeof(order[0])) order[orderCount++] = N;
+}
+
+void resetAt(uint32_t nowMs) {
+    wheel.reset(nowMs);
+    clockMs = nowMs;
+    orderCount = 0;
+    for (uint8_t i = 0; i < ChoreWheel::MAX_CHORES; i++) {
+        fires[i] = 0;
+        firedAt[i] = 0;
+    }
+}
+
+// Sleep the way the loop does, exactly msUntilNext() each time, until
+// `endMs`; returns the number of wakes
+uint32_t sleepUntil(uint32_t endMs) {
+    uint32_t wakes = 0;
+    while (wakes < 100000) {
+        uint32_t wait = wheel.msUntilNext(clockMs);
+        if (wait == ChoreWheel::NO_EXPIRY || (int32_t)(clockMs + wait - endMs) > 0) break;
+        clockMs += wait;
+        wheel.advance(clockMs);
+        wakes++;
+    }
+    clockMs = endMs;
+    wheel.advance(clockMs);
+    return wakes;
+}
+
+// Callback behaviour for the re-arm and cancel checks
+void rearmThrice() {
+    mark<0>();
+    if (fires[0] < 3) wheel.schedule(0, clockMs + 7);
+}
+
+void cancelSibling() {
+    mark<1>();
+    wheel.cancel(2);
+}
+
+void cancelSelf() {
+    mark<3>();
+    wheel.cancel(3);
+}
+
+void moveSelf() {
+    mark<4>();
+    wheel.schedule(4, clockMs + 1000);
+}
+
+} // namespace
+
+int main() {
+    // One-shots either side of each level boundary fire on time when the
+    // loop sleeps for msUntilNext()
+    const uint32_t dues[] = {1, 63, 64, 65, 4095, 4096, 4097, 262143};
+    const uint8_t dueCount = sizeof(dues) / sizeof(dues[0]);
+    resetAt(0);
+    wheel.add(0, "d0", mark<0>, 0);
+    wheel.add(1, "d1", mark<1>, 0);
+    wheel.add(2, "d2", mark<2>, 0);
+    wheel.add(3, "d3", mark<3>, 0);
+    wheel.add(4, "d4", mark<4>, 0);
+    wheel.add(5, "d5", mark<5>, 0);
+    wheel.add(6, "d6", mark<6>, 0);
+    wheel.add(7, "d7", mark<7>, 0);
+    for (uint8_t i = 0; i < dueCount; i++) wheel.schedule(i, dues[i]);
+    uint32_t wakes = sleepUntil(300000);
+    for (uint8_t i = 0; i < dueCount; i++) {
+        CHECK_EQ(fires[i], 1);
+        CHECK_EQ(firedAt[i], dues[i]);
+        CHECK_EQ(wheel.stats(i).maxLateMs, 0);
+        CHECK(!wheel.isArmed(i));
+    }
+    printf("boundaries: %u chores on time in %lu wakes\n", dueCount, (unsigned long)wakes);
+    CHECK(wakes < 64);
+
+    // The same chores caught up in one late advance run in due order
+    resetAt(0);
+    for (uint8_t i = 0; i < dueCount; i++) wheel.schedule(dueCount - 1 - i, dues[dueCount - 1 - i]);
+    clockMs = 300000;
+    wheel.advance(clockMs);
+    CHECK_EQ(orderCount, dueCount);
+    for (uint8_t i = 0; i < orderCount; i++) CHECK_EQ(order[i], i);
+    CHECK_EQ(wheel.stats(0).lastLateMs, 300000 - dues[0]);
+    CHECK_EQ(wheel.msUntilNext(clockMs), ChoreWheel::NO_EXPIRY);
+
+    // Beyond the top level a chore parks in the farthest slot and is
+    // re-placed on each cascade until its time comes
+    resetAt(1000);
+    wheel.schedule(0, 1000 + 600000);
+    wheel.schedule(1, 1000 + 3000000);
+    wakes = sleepUntil(1000 + 3100000);
+    CHECK_EQ(fires[0], 1);
+    CHECK_EQ(firedAt[0], 1000 + 600000);
+    CHECK_EQ(fires[1], 1);
+    CHECK_EQ(firedAt[1], 1000 + 3000000);
+    printf("far: 600 s and 3000 s chores on time in %lu wakes\n", (unsigned long)wakes);
+
+    // Periodic and one-shot chores across the 32-bit millis() wrap
+    const uint32_t nearWrap = 0xFFFFFF00;
+    resetAt(nearWrap);
+    wheel.add(0, "tick", mark<0>, 100);
+    wheel.add(1, "once", mark<1>, 0);
+    wheel.schedule(0, nearWrap + 50);
+    wheel.schedule(1, 0x100);
+    sleepUntil(nearWrap + 1050);
+    CHECK_EQ(fires[0], 11);
+    CHECK_EQ(firedAt[0], nearWrap + 1050);
+    CHECK_EQ(wheel.stats(0).maxLateMs, 0);
+    CHECK_EQ(fires[1], 1);
+    CHECK_EQ(firedAt[1], 0x100);
+    CHECK_EQ(wheel.dueAt(0), nearWrap + 1150);
+
+    // Callbacks re-arm themselves, cancel a chore later in the same slot,
+    // cancel a periodic chore from inside its own run, or move it
+    resetAt(0);
+    wheel.add(0, "rearm", rearmThrice, 0);
+    wheel.add(1, "cancel", cancelSibling, 0);
+    wheel.add(2, "victim", mark<2>, 0);
+    wheel.add(3, "self", cancelSelf, 50);
+    wheel.add(4, "move", moveSelf, 50);
+    wheel.schedule(0, 10);
+    wheel.schedule(2, 20);
+    wheel.schedule(1, 20);  // Linked last, so it runs first in the slot
+    wheel.schedule(3, 30);
+    wheel.schedule(4, 30);
+    sleepUntil(2000);
+    CHECK_EQ(fires[0], 3);
+    CHECK_EQ(firedAt[0], 24);
+    CHECK(!wheel.isArmed(0));
+    CHECK_EQ(fires[1], 1);
+    CHECK_EQ(fires[2], 0);
+    CHECK(!wheel.isArmed(2));
+    CHECK_EQ(fires[3], 1);
+    CHECK(!wheel.isArmed(3));
+    CHECK_EQ(fires[4], 2);
+    CHECK_EQ(firedAt[4], 1030);
+    CHECK_EQ(wheel.dueAt(4), 2030);
+
+    // Lateness: a missed period is skipped, keeping the original phase
+    resetAt(0);
+    wheel.add(0, "late", mark<0>, 50);
+    wheel.schedule(0, 50);
+    clockMs = 130;
+    wheel.advance(clockMs);
+    CHECK_EQ(fires[0], 1);
+    CHECK_EQ(wheel.stats(0).lastLateMs, 80);
+    CHECK_EQ(wheel.dueAt(0), 150);
+    clockMs = 160;
+    wheel.advance(clockMs);
+    clockMs = 200;
+    wheel.advance(clockMs);
+    const ChoreStats& late = wheel.stats(0);
+    CHECK_EQ(late.runs, 3);
+    CHECK_EQ(late.lastLateMs, 0);
+    CHECK_EQ(late.maxLateMs, 80);
+    CHECK_EQ(late.totalLateMs, 90);
+    CHECK_EQ(wheel.msUntilNext(clockMs), 50);
+    wheel.clearStats();
+    CHECK_EQ(wheel.stats(0).runs, 0);
+    CHECK_EQ(wheel.stats(0).maxLateMs, 0);
+    CHECK_EQ(wheel.stats(0).totalLateMs, 0);
+    CHECK(wheel.isArmed(0));
+
+    return checkResult("chore_wheel_test");
+}
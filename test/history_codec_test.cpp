@@ -0,0 +1,158 @@
+// HistoryEncoder/HistoryDecoder: round-trip of a synthetic history,
+// bytes per record against the raw struct, encode/decode rate, malformed
+// input, and the RTC history copy built on the codec.
+#include "history_codec.h"
+#include "rtc_snapshot.h"
+#include "test_check.h"
+#include <chrono>
+#include <random>
+#include <string.h>
+#include <vector>
+
+namespace {
+
+const size_t RECORDS = 100000;
+const int REPEATS = 20;
+
+// Eight-phase pomodoro days: mostly completed sessions near their nominal
+// length, a few cut short, occasional pauses, a handful of tasks with
+// stray ones mixed in, and an overnight gap now and then
+std::vector<SessionRecord> makeHistory(std::mt19937& rng, size_t count) {
+    std::vector<SessionRecord> history;
+    uint32_t t = 1700000000;
+    for (size_t i = 0; i < count; i++) {
+        SessionRecord r = SessionRecord();
+        int phase = i % 8;
+        bool work = phase % 2 == 0;
+        r.kind = work ? SessionKind::WORK
+                      : (phase == 7 ? SessionKind::LONG_BREAK : SessionKind::SHORT_BREAK);
+        uint16_t nominal = work ? 1500 : (phase == 7 ? 900 : 300);
+        uint32_t roll = rng() % 20;
+        r.outcome = roll == 0 ? SessionOutcome::INTERRUPTED
+                              : (roll == 1 ? SessionOutcome::RESET : SessionOutcome::COMPLETED);
+        r.durationSec = r.outcome == SessionOutcome::COMPLETED ? nominal + rng() % 3 : rng() % nominal;
+        r.pausedSec = (rng() % 5 == 0) ? rng() % 600 : 0;
+        r.taskId = (rng() % 10 < 7) ? (i / 16) % 6 : rng() % 40;
+        t += 2 + rng() % 30;
+        if (phase == 7 && rng() % 4 == 0) t += 12 * 3600;
+        r.startEpoch = t;
+        t += r.durationSec + r.pausedSec;
+        history.push_back(r);
+    }
+    return history;
+}
+
+double seconds(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+bool sameRecord(const SessionRecord& a, const SessionRecord& b) {
+    return memcmp(&a, &b, sizeof(SessionRecord)) == 0;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    std::vector<SessionRecord> history = makeHistory(rng, RECORDS);
+    std::vector<uint8_t> encoded(RECORDS * HistoryEncoder::MAX_RECORD_SIZE);
+
+    size_t bytes = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int k = 0; k < REPEATS; k++) {
+        HistoryEncoder encoder;
+        bytes = 0;
+        for (size_t i = 0; i < RECORDS; i++) bytes += encoder.encode(history[i], &encoded[bytes]);
+    }
+    double encodeSec = seconds(start);
+
+    std::vector<SessionRecord> decoded(RECORDS);
+    size_t pos = 0;
+    start = std::chrono::steady_clock::now();
+    for (int k = 0; k < REPEATS; k++) {
+        HistoryDecoder decoder;
+        pos = 0;
+        for (size_t i = 0; i < RECORDS; i++) {
+            size_t used = decoder.decode(&encoded[pos], bytes - pos, decoded[i]);
+            if (used == 0) break;
+            pos += used;
+        }
+    }
+    double decodeSec = seconds(start);
+    CHECK_EQ(pos, bytes);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < RECORDS; i++) {
+        if (!sameRecord(history[i], decoded[i])) mismatches++;
+    }
+    CHECK_EQ(mismatches, 0);
+
+    double perRecord = (double)bytes / RECORDS;
+    printf("%lu records: %.2f bytes/record vs %lu raw (%.1f%%), encode %.1f M rec/s, "
+           "decode %.1f M rec/s\n",
+           (unsigned long)RECORDS, perRecord, (unsigned long)sizeof(SessionRecord),
+           100.0 * perRecord / sizeof(SessionRecord), RECORDS * REPEATS / encodeSec / 1e6,
+           RECORDS * REPEATS / decodeSec / 1e6);
+    CHECK(perRecord < 6.0);
+
+    // Every truncation of a record is rejected, never half-decoded
+    {
+        HistoryEncoder encoder;
+        uint8_t one[HistoryEncoder::MAX_RECORD_SIZE];
+        SessionRecord far = history[0];
+        far.taskId = 200;  // Literal task id, longest form
+        size_t len = encoder.encode(far, one);
+        for (size_t cut = 0; cut < len; cut++) {
+            HistoryDecoder decoder;
+            SessionRecord r;
+            CHECK_EQ(decoder.decode(one, cut, r), 0);
+        }
+        HistoryDecoder decoder;
+        SessionRecord r;
+        CHECK_EQ(decoder.decode(one, len, r), len);
+        CHECK(sameRecord(r, far));
+    }
+
+    // Garbage decodes to nothing or to a record that stays in bounds
+    for (int k = 0; k < 100000; k++) {
+        uint8_t garbage[16];
+        for (size_t i = 0; i < sizeof(garbage); i++) garbage[i] = (uint8_t)rng();
+        size_t len = rng() % (sizeof(garbage) + 1);
+        HistoryDecoder decoder;
+        SessionRecord r;
+        CHECK(decoder.decode(garbage, len, r) <= len);
+    }
+
+    // RTC copy of the ring: typical sessions fit whole
+    SessionHistory ring;
+    for (size_t i = 0; i < SessionHistory::CAPACITY; i++) ring.append(history[i]);
+    storeRtcHistory(ring, 1234);
+    SessionHistory resumed;
+    CHECK(takeRtcHistory(resumed, 1234));
+    CHECK_EQ(resumed.size(), ring.size());
+    for (uint16_t i = 0; i < resumed.size() && i < ring.size(); i++) CHECK(sameRecord(resumed[i], ring[i]));
+    CHECK(!takeRtcHistory(resumed, 1234));  // Taken once only
+
+    // A journal that moved since suspend wins over the copy
+    storeRtcHistory(ring, 1234);
+    CHECK(!takeRtcHistory(resumed, 1235));
+
+    // Worst-case records overflow the copy; the newest ones are kept
+    SessionHistory wide;
+    for (size_t i = 0; i < SessionHistory::CAPACITY; i++) {
+        SessionRecord r = history[i];
+        r.startEpoch = (uint32_t)(i * 100000000u);
+        r.durationSec = (uint16_t)(i % 2 ? 60000 : 1);
+        r.pausedSec = 60000;
+        r.taskId = (uint8_t)(100 + i);
+        wide.append(r);
+    }
+    storeRtcHistory(wide, 7);
+    CHECK(takeRtcHistory(resumed, 7));
+    printf("worst case: %u of %u records kept in RTC memory\n", resumed.size(), wide.size());
+    CHECK(resumed.size() > 0 && resumed.size() < wide.size());
+    uint16_t skipped = wide.size() - resumed.size();
+    for (uint16_t i = 0; i < resumed.size(); i++) CHECK(sameRecord(resumed[i], wide[skipped + i]));
+
+    return checkResult("history_codec_test");
+}
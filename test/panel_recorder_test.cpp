@@ -0,0 +1,100 @@
+// St7789Display against a PanelRecorder: init sequence, rotation, address
+// window with the 35-row gap, color transfers left in flight, and sleep.
+#include "display_backend.h"
+#include "test_check.h"
+
+namespace {
+
+const uint8_t CMD_SLPIN = 0x10;
+const uint8_t CMD_DISPOFF = 0x28;
+const uint8_t CMD_DISPON = 0x29;
+const uint8_t CMD_CASET = 0x2A;
+const uint8_t CMD_RASET = 0x2B;
+const uint8_t CMD_RAMWR = 0x2C;
+const uint8_t CMD_MADCTL = 0x36;
+const uint16_t ROW_GAP = 35;
+const uint16_t BAND_ROWS = 40;
+
+int doneCount = 0;
+void onDone(void*) { doneCount++; }
+
+uint16_t bandA[St7789Display::WIDTH * BAND_ROWS];
+uint16_t bandB[St7789Display::WIDTH * BAND_ROWS];
+
+uint16_t param16(const PanelRecorder::Op& op, uint8_t at) {
+    return (uint16_t)(op.params[at] << 8 | op.params[at + 1]);
+}
+
+} // namespace
+
+int main() {
+    PanelRecorder panel;
+    St7789Display lcd(panel);
+    panel.onColorDone(onDone, nullptr);
+
+    // Init clears the whole screen before the display is switched on
+    CHECK(lcd.begin(3));
+    CHECK_EQ(panel.colorBytes(), St7789Display::WIDTH * St7789Display::HEIGHT * 2);
+    CHECK_EQ(doneCount, 17);  // 170 rows in bands of 10
+    CHECK_EQ(panel.inFlight(), 0);
+    CHECK_EQ(panel.op(panel.count() - 1).cmd, CMD_DISPON);
+    uint16_t madctl = 0;
+    for (uint16_t i = 0; i < panel.count(); i++) {
+        if (panel.op(i).cmd == CMD_MADCTL) {
+            CHECK_EQ(panel.op(i).params[0], 0xA0);
+            madctl++;
+        }
+    }
+    CHECK_EQ(madctl, 1);
+    printf("begin: %u ops, %lu color bytes\n", panel.count(), (unsigned long)panel.colorBytes());
+
+    // A band goes out as CASET, RASET (shifted by the row gap) and RAMWR,
+    // and stays in flight until the bus finishes it
+    panel.clear();
+    panel.autoComplete = false;
+    doneCount = 0;
+    CHECK(lcd.draw(0, 40, St7789Display::WIDTH - 1, 40 + BAND_ROWS - 1, bandA));
+    CHECK_EQ(panel.count(), 3);
+    CHECK_EQ(panel.op(0).cmd, CMD_CASET);
+    CHECK_EQ(param16(panel.op(0), 0), 0);
+    CHECK_EQ(param16(panel.op(0), 2), St7789Display::WIDTH - 1);
+    CHECK_EQ(panel.op(1).cmd, CMD_RASET);
+    CHECK_EQ(param16(panel.op(1), 0), 40 + ROW_GAP);
+    CHECK_EQ(param16(panel.op(1), 2), 40 + BAND_ROWS - 1 + ROW_GAP);
+    CHECK(panel.op(2).type == PanelRecorder::COLOR);
+    CHECK_EQ(panel.op(2).cmd, CMD_RAMWR);
+    CHECK_EQ(panel.op(2).value, sizeof(bandA));
+    CHECK(panel.op(2).pixels == bandA);
+    CHECK_EQ(doneCount, 0);
+    CHECK_EQ(panel.inFlight(), 1);
+
+    // The next band's window commands would wait for the first transfer
+    CHECK(lcd.draw(0, 80, St7789Display::WIDTH - 1, 80 + BAND_ROWS - 1, bandB));
+    CHECK_EQ(panel.busyCommands(), 2);
+    CHECK_EQ(panel.inFlight(), 2);
+    printf("second band: %u commands issued while a transfer was in flight\n",
+           panel.busyCommands());
+    CHECK(panel.complete());
+    CHECK(panel.complete());
+    CHECK(!panel.complete());
+    CHECK_EQ(doneCount, 2);
+
+    // Windows past the panel are refused without touching the bus
+    panel.clear();
+    CHECK(!lcd.draw(0, 160, St7789Display::WIDTH - 1, St7789Display::HEIGHT, bandA));
+    CHECK(!lcd.draw(10, 0, 9, 0, bandA));
+    CHECK_EQ(panel.count(), 0);
+
+    panel.clear();
+    CHECK(lcd.setRotation(1));
+    CHECK_EQ(panel.op(0).cmd, CMD_MADCTL);
+    CHECK_EQ(panel.op(0).params[0], 0x60);
+
+    panel.clear();
+    CHECK(lcd.sleep());
+    CHECK_EQ(panel.op(0).cmd, CMD_DISPOFF);
+    CHECK(panel.op(1).type == PanelRecorder::DELAY);
+    CHECK_EQ(panel.op(2).cmd, CMD_SLPIN);
+
+    return checkResult("panel_recorder_test");
+}
@@ -0,0 +1,117 @@
+// StateSlots on a simulated NOR flash: power cut partway through either
+// program of a store(), boot read cost, generations and CRC fallback.
+#include "state_slots.h"
+#include "test_check.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+const uint32_t STORES = 20000;
+
+uint8_t storage[StateSlots::SLOT_COUNT * FlashDevice::SECTOR_SIZE];
+
+// A sealed record of varying length whose payload starts with `value`
+size_t makeRecord(uint8_t* buf, uint32_t value) {
+    size_t payloadLen = 100 + value % 400;
+    uint8_t* payload = buf + sizeof(StateHeader);
+    for (size_t i = 0; i < payloadLen; i++) payload[i] = (uint8_t)(value * 31 + i);
+    memcpy(payload, &value, sizeof(value));
+    return sealStateRecord(buf, payloadLen);
+}
+
+// Mount, load and return the value of the record found, 0 if none
+uint32_t bootValue(FlashDevice& flash) {
+    StateSlots slots(flash);
+    if (!slots.mount()) return 0;
+    uint8_t buf[STATE_RECORD_MAX];
+    size_t len = slots.load(buf, sizeof(buf));
+    if (len == 0) return 0;
+    size_t payloadLen = 0;
+    uint16_t version = 0;
+    const uint8_t* payload = openStateRecord(buf, len, &payloadLen, &version);
+    if (payload == nullptr) return 0;
+    uint32_t value = 0;
+    memcpy(&value, payload, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+int main() {
+    SimFlash flash(storage, sizeof(storage));
+    uint8_t record[STATE_RECORD_MAX];
+
+    // Generations count up across reboots
+    for (uint32_t i = 1; i <= 5; i++) {
+        StateSlots slots(flash);
+        CHECK(slots.mount());
+        size_t len = makeRecord(record, i);
+        CHECK(slots.store(record, len));
+        CHECK_EQ(slots.generation(), i);
+    }
+    CHECK_EQ(bootValue(flash), 5);
+
+    // Store with the power cut at a random byte of the record (program 0)
+    // or the header (program 1) on every other store. Boot must find the
+    // previous value or, if the header made it, the new one; never garbage.
+    srand(1234);
+    uint32_t committed = 5;
+    uint32_t cuts = 0;
+    uint32_t rolledBack = 0;
+    for (uint32_t value = 6; value < 6 + STORES; value++) {
+        StateSlots slots(flash);
+        CHECK(slots.mount());
+        size_t len = makeRecord(record, value);
+        if (rand() % 2 == 0) {
+            CHECK(slots.store(record, len));
+            committed = value;
+        } else {
+            bool header = rand() % 2;
+            size_t size = header ? StateSlots::HEADER_SIZE : len;
+            flash.cutPowerAt(header ? 1 : 0, rand() % (size + 1));
+            slots.store(record, len);
+            flash.powerOn();
+            cuts++;
+        }
+        uint32_t found = bootValue(flash);
+        CHECK(found == committed || found == value);
+        if (found == value) {
+            committed = value;
+        } else {
+            rolledBack++;
+        }
+    }
+    printf("%lu power cuts, %lu rolled back to the previous generation\n",
+           (unsigned long)cuts, (unsigned long)rolledBack);
+    CHECK(rolledBack > 0 && rolledBack <= cuts);
+
+    // Boot reads both headers and one record
+    flash.resetCounters();
+    StateSlots slots(flash);
+    CHECK(slots.mount());
+    uint8_t out[STATE_RECORD_MAX];
+    size_t len = slots.load(out, sizeof(out));
+    CHECK(len > 0);
+    printf("boot: %lu reads, %lu bytes, %.1f us simulated flash, record %lu bytes\n",
+           (unsigned long)flash.counters().reads, (unsigned long)slots.readBytes(),
+           flash.counters().busyNs / 1000.0, (unsigned long)len);
+    CHECK_EQ(slots.readBytes(), 2 * StateSlots::HEADER_SIZE + len);
+
+    // A bit flip in the newest record falls back to the other slot
+    len = makeRecord(record, 1);
+    CHECK(slots.store(record, len));
+    len = makeRecord(record, 2);
+    CHECK(slots.store(record, len));
+    uint8_t newest = slots.activeSlot();
+    uint32_t generation = slots.generation();
+    storage[newest * FlashDevice::SECTOR_SIZE + StateSlots::HEADER_SIZE + 40] ^= 0x01;
+    StateSlots fallback(flash);
+    CHECK(fallback.mount());
+    CHECK(fallback.load(out, sizeof(out)) > 0);
+    CHECK(fallback.activeSlot() != newest);
+    CHECK_EQ(fallback.generation(), generation - 1);
+    CHECK_EQ(bootValue(flash), 1);
+
+    return checkResult("state_slots_test");
+}
@@ -0,0 +1,38 @@
+#pragma once
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+#include <stdio.h>
+
+// Minimal checks for the host tests: report every failure, exit non-zero
+static int checkFailures = 0;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, \
+                    #cond);                                                  \
+            checkFailures++;                                                 \
+        }                                                                    \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                             \
+    do {                                                                           \
+        long long check_a = (long long)(a);                                        \
+        long long check_b = (long long)(b);                                        \
+        if (check_a != check_b) {                                                  \
+            fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %s (%lld vs %lld)\n",   \
+                    __FILE__, __LINE__, #a, #b, check_a, check_b);                 \
+            checkFailures++;                                                       \
+        }                                                                          \
+    } while (0)
+
+static int checkResult(const char* name) {
+    if (checkFailures == 0) {
+        printf("%s: ok\n", name);
+        return 0;
+    }
+    printf("%s: %d check(s) failed\n", name, checkFailures);
+    return 1;
+}
+
+#endif
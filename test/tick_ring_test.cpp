@@ -0,0 +1,85 @@
+// TickRing: Q14 sine/cosine error against libm, tick endpoints within a
+// pixel of float rounding for every count, count clamping and no-op rebuilds.
+#include "tick_ring.h"
+#include "test_check.h"
+#include <math.h>
+#include <stdlib.h>
+
+namespace {
+
+const double TURN = 2.0 * M_PI;
+
+int pixelError(int16_t got, int16_t radius, double factor) {
+    return abs(got - (int)lround(radius * factor));
+}
+
+// Worst endpoint deviation over every count from 1 to MAX_TICKS
+int worstEndpointError(int16_t inner, int16_t outer) {
+    TickRing ring(inner, outer);
+    int worst = 0;
+    for (uint8_t n = 1; n <= TickRing::MAX_TICKS; n++) {
+        CHECK(ring.setCount(n));
+        CHECK_EQ(ring.count(), n);
+        for (uint8_t i = 0; i < n; i++) {
+            // Clockwise from 12 o'clock with y down
+            double angle = TURN * (0.75 + (double)i / n);
+            const TickSegment& t = ring.tick(i);
+            int d = pixelError(t.x1, inner, cos(angle));
+            if (pixelError(t.y1, inner, sin(angle)) > d) d = pixelError(t.y1, inner, sin(angle));
+            if (pixelError(t.x2, outer, cos(angle)) > d) d = pixelError(t.x2, outer, cos(angle));
+            if (pixelError(t.y2, outer, sin(angle)) > d) d = pixelError(t.y2, outer, sin(angle));
+            if (d > worst) worst = d;
+            CHECK_EQ(t.major, i % 5 == 0);
+        }
+        // The first tick sits straight up
+        CHECK_EQ(ring.tick(0).x1, 0);
+        CHECK_EQ(ring.tick(0).y1, -inner);
+        CHECK_EQ(ring.tick(0).x2, 0);
+        CHECK_EQ(ring.tick(0).y2, -outer);
+    }
+    CHECK_EQ(ring.rebuilds(), TickRing::MAX_TICKS);
+    return worst;
+}
+
+} // namespace
+
+int main() {
+    double worstTrig = 0;
+    for (uint16_t a = 0; a < TickRing::ANGLE_STEPS; a++) {
+        double angle = TURN * a / TickRing::ANGLE_STEPS;
+        double e = fabs(TickRing::sinQ14(a) / 16384.0 - sin(angle));
+        if (e > worstTrig) worstTrig = e;
+        e = fabs(TickRing::cosQ14(a) / 16384.0 - cos(angle));
+        if (e > worstTrig) worstTrig = e;
+    }
+    printf("Q14 sin/cos: max error %.7f (%.2f LSB)\n", worstTrig, worstTrig * 16384);
+    CHECK(worstTrig <= 1.0 / 16384);
+
+    // Angles wrap past a full turn
+    CHECK_EQ(TickRing::sinQ14(TickRing::ANGLE_STEPS + 256), 16384);
+    CHECK_EQ(TickRing::cosQ14(TickRing::ANGLE_STEPS * 2), 16384);
+
+    // The sketch's ring and a wider one
+    int worstSketch = worstEndpointError(62, 66);
+    int worstWide = worstEndpointError(100, 120);
+    printf("endpoints: worst %d px (62/66), %d px (100/120)\n", worstSketch, worstWide);
+    CHECK(worstSketch <= 1);
+    CHECK(worstWide <= 1);
+
+    // Counts clamp to MAX_TICKS; an unchanged count does not rebuild
+    TickRing ring(62, 66);
+    CHECK(!ring.setCount(0));
+    CHECK_EQ(ring.rebuilds(), 0);
+    CHECK(ring.setCount(200));
+    CHECK_EQ(ring.count(), TickRing::MAX_TICKS);
+    CHECK_EQ(ring.rebuilds(), 1);
+    CHECK(!ring.setCount(TickRing::MAX_TICKS));
+    CHECK(!ring.setCount(255));
+    CHECK_EQ(ring.rebuilds(), 1);
+    CHECK(ring.setCount(25));
+    CHECK(!ring.setCount(25));
+    CHECK_EQ(ring.count(), 25);
+    CHECK_EQ(ring.rebuilds(), 2);
+
+    return checkResult("tick_ring_test");
+}
@@ -0,0 +1,182 @@
+// Weeks of pomodoro cycles through TimerCore on a FakeClock: every session
+// runs second by second through update(), with the deferred saves and the
+// alerts, in a fraction of a second of real time.
+#include "timer_core.h"
+#include "settings_store.h"
+#include "core_log.h"
+#include <string.h>
+#include "test_check.h"
+
+namespace {
+
+const uint32_t SIM_START_EPOCH = 1767600000UL;  // 2026-01-05 08:00 UTC, a Monday
+const uint32_t SIM_DAYS = 28;
+const uint8_t SESSIONS_PER_DAY = 8;
+const uint8_t SIM_TASKS = 3;
+
+// Counts the core's log lines instead of printing them
+class CountingSink : public LogSink {
+public:
+    CountingSink() : lines(0), sessions(0) {}
+    void write(const char* text) override {
+        lines++;
+        if (strncmp(text, "Session recorded", 16) == 0) sessions++;
+    }
+    uint32_t lines;
+    uint32_t sessions;
+};
+
+// Follow the timer's own deadlines until it waits for input or `until` holds
+void runUntil(FakeClock& clock, TimerCore& timer, TimerState until) {
+    while (timer.getState() != until) {
+        uint64_t deadline = timer.nextDeadline();
+        if (deadline == TIMER_NO_DEADLINE) return;
+        clock.setMicros(deadline);
+        timer.update();
+        timer.getChanges().drain();
+    }
+}
+
+void settle(FakeClock& clock, TimerCore& timer) {
+    clock.advanceMillis(SAVE_QUIET_MS);
+    timer.update();
+    timer.getChanges().drain();
+}
+
+uint16_t sumCompleted(const TimerCore& timer) {
+    uint16_t sum = 0;
+    for (uint8_t t = 0; t < timer.getTotalTasks(); t++) sum += timer.getTaskCompletedPomodoros(t);
+    return sum;
+}
+
+uint16_t sumInterrupted(const TimerCore& timer) {
+    uint16_t sum = 0;
+    for (uint8_t t = 0; t < timer.getTotalTasks(); t++) sum += timer.getTaskInterruptedPomodoros(t);
+    return sum;
+}
+
+} // namespace
+
+int main() {
+    CountingSink log;
+    setLogSink(&log);
+    settingsStore().clear();
+
+    FakeClock clock;
+    CHECK(!clock.hasWallTime());  // Counting from "power-on"
+    clock.setEpochBase(SIM_START_EPOCH);
+    CHECK(clock.hasWallTime());
+    TimerCore timer(&clock);
+    timer.begin(false);
+    while (timer.getTotalTasks() < SIM_TASKS) timer.addTask();
+    settle(clock, timer);
+
+    uint16_t completed = 0;
+    uint16_t interrupted = 0;
+    uint16_t longBreaks = 0;
+    uint32_t focusedSec = 0;
+    uint32_t session = 0;
+
+    for (uint32_t day = 0; day < SIM_DAYS; day++) {
+        // Sundays off, so the streak has to restart on Mondays
+        bool rest_day = (day % 7) == 6;
+        uint8_t day_completed = 0;
+        uint8_t day_interrupted = 0;
+
+        for (uint8_t s = 0; s < SESSIONS_PER_DAY && !rest_day; s++, session++) {
+            timer.selectTask(session % SIM_TASKS);
+            timer.startWork();
+            CHECK(timer.getState() == TimerState::WORK);
+
+            if (session % 7 == 3) {
+                // Ten minutes in, a pause, then the pomodoro is abandoned
+                clock.advanceSeconds(10 * 60);
+                timer.update();
+                timer.pause();
+                clock.advanceSeconds(3 * 60);
+                timer.interrupt();
+                CHECK(timer.getState() == TimerState::IDLE);
+                interrupted++;
+                day_interrupted++;
+                focusedSec += 10 * 60;
+                settle(clock, timer);
+                continue;
+            }
+
+            runUntil(clock, timer, TimerState::ALERT);
+            CHECK(timer.getState() == TimerState::ALERT);
+            // The pomodoro counts the moment it ends, before the alert does
+            completed++;
+            day_completed++;
+            focusedSec += timer.getWorkDuration() * 60U;
+            CHECK_EQ(sumCompleted(timer), completed);
+            CHECK_EQ(timer.getStats().totalCompleted(), completed);
+
+            if (session % 11 == 5) {
+                // Reset during the alert: counted already, no break follows
+                timer.reset();
+                CHECK(timer.getState() == TimerState::IDLE);
+                CHECK(!timer.isAlertActive());
+            } else {
+                runUntil(clock, timer, TimerState::IDLE);
+                CHECK(timer.getState() == TimerState::IDLE);
+                if (timer.getPomodorosSinceLastLongBreak() == 0) longBreaks++;
+            }
+            settle(clock, timer);
+            clock.advanceSeconds(2 * 60);
+        }
+
+        const DayStats* today = timer.getStats().day(clock.epochSeconds());
+        if (rest_day) {
+            CHECK(today == nullptr);
+        } else {
+            CHECK(today != nullptr);
+            if (today != nullptr) {
+                CHECK_EQ(today->completed, day_completed);
+                CHECK_EQ(today->interrupted, day_interrupted);
+            }
+            CHECK_EQ(timer.getStats().streakDays(clock.epochSeconds()), day % 7 + 1);
+        }
+
+        // Overnight: jump to 08:00 the next day
+        uint32_t next_day = SIM_START_EPOCH + (day + 1) * SECONDS_PER_DAY;
+        clock.advanceSeconds(next_day - clock.epochSeconds());
+        timer.update();
+    }
+
+    CHECK_EQ(sumCompleted(timer), completed);
+    CHECK_EQ(sumInterrupted(timer), interrupted);
+    CHECK_EQ(timer.getStats().totalCompleted(), completed);
+    CHECK_EQ(timer.getStats().totalInterrupted(), interrupted);
+    CHECK_EQ(timer.getStats().focusedSeconds(), focusedSec);
+    CHECK(longBreaks > 0);
+    CHECK(!timer.hasUnsavedChanges());
+    // One record per work session and per break that ran to its alert
+    CHECK(log.sessions >= completed + interrupted);
+
+    // Everything above went through the deferred saves; a fresh core must
+    // load the same numbers from the settings store
+    TimerCore reloaded(&clock);
+    reloaded.begin(false);
+    CHECK_EQ(reloaded.getTotalTasks(), SIM_TASKS);
+    CHECK_EQ(sumCompleted(reloaded), completed);
+    CHECK_EQ(sumInterrupted(reloaded), interrupted);
+    CHECK_EQ(reloaded.getStats().focusedSeconds(), focusedSec);
+    CHECK_EQ(reloaded.getPomodorosSinceLastLongBreak(), timer.getPomodorosSinceLastLongBreak());
+
+    // A stats reset is saved like any other counter change
+    reloaded.resetTaskStats();
+    CHECK(reloaded.hasUnsavedChanges());
+    settle(clock, reloaded);
+    CHECK(!reloaded.hasUnsavedChanges());
+    TimerCore cleared(&clock);
+    cleared.begin(false);
+    CHECK_EQ(sumCompleted(cleared), 0);
+    CHECK_EQ(sumInterrupted(cleared), 0);
+    CHECK_EQ(cleared.getStats().focusedSeconds(), 0);
+
+    printf("%lu simulated days: %u completed, %u interrupted, %u long breaks, %lu focused minutes\n",
+           (unsigned long)SIM_DAYS, completed, interrupted, longBreaks,
+           (unsigned long)(focusedSec / 60));
+    return checkResult("timer_sim_test");
+}
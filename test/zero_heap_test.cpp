@@ -0,0 +1,171 @@
+// The state load/save path allocates nothing: a counting operator new
+// tracks calls and the live-byte high-water mark across a cold load,
+// sessions with journal appends, deferred saves, suspend and both wakes.
+#include "timer_core.h"
+#include "session_journal.h"
+#include "settings_store.h"
+#include "core_log.h"
+#include "test_check.h"
+#include <new>
+#include <stdlib.h>
+
+namespace {
+
+size_t allocations = 0;
+size_t liveBytes = 0;
+size_t peakBytes = 0;
+
+// Size prefix so delete can keep liveBytes; max_align_t keeps alignment
+union AllocHeader {
+    size_t size;
+    max_align_t align;
+};
+
+void* countedAlloc(size_t size) {
+    allocations++;
+    AllocHeader* h = static_cast<AllocHeader*>(malloc(sizeof(AllocHeader) + size));
+    if (h == nullptr) throw std::bad_alloc();
+    h->size = size;
+    liveBytes += size;
+    if (liveBytes > peakBytes) peakBytes = liveBytes;
+    return h + 1;
+}
+
+void countedFree(void* p) {
+    if (p == nullptr) return;
+    AllocHeader* h = static_cast<AllocHeader*>(p) - 1;
+    liveBytes -= h->size;
+    free(h);
+}
+
+// Allocations and peak growth made by one step
+struct HeapUse {
+    size_t calls;
+    size_t peakGrowth;
+};
+
+class HeapProbe {
+public:
+    HeapProbe() : calls(allocations), live(liveBytes) { peakBytes = liveBytes; }
+    HeapUse use() const {
+        HeapUse u;
+        u.calls = allocations - calls;
+        u.peakGrowth = peakBytes - live;
+        return u;
+    }
+private:
+    size_t calls;
+    size_t live;
+};
+
+const uint32_t JOURNAL_BYTES = 0x20000;
+const uint32_t SAVES = 1000;
+uint8_t journalStorage[JOURNAL_BYTES];
+
+void report(const char* step, const HeapUse& u) {
+    printf("  %-28s %4lu allocations, peak +%lu bytes\n", step, (unsigned long)u.calls,
+           (unsigned long)u.peakGrowth);
+}
+
+// A work session and its break, back to IDLE with the deferred save done
+void runSession(FakeClock& clock, TimerCore& timer) {
+    timer.startWork();
+    do {
+        uint64_t deadline = timer.nextDeadline();
+        if (deadline == TIMER_NO_DEADLINE) break;
+        clock.setMicros(deadline);
+        timer.update();
+        timer.getChanges().drain();
+    } while (timer.getState() != TimerState::IDLE);
+    clock.advanceMillis(SAVE_QUIET_MS);
+    timer.update();
+    timer.getChanges().drain();
+}
+
+} // namespace
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t) noexcept { countedFree(p); }
+
+int main() {
+    // The counter sees allocations made through it
+    int* volatile canary = new int(1);
+    delete canary;
+    CHECK_EQ(allocations, 1);
+    CHECK_EQ(liveBytes, 0);
+
+    settingsStore().clear();
+    SimFlash flash(journalStorage, sizeof(journalStorage));
+    SessionJournal journal(flash);
+    CHECK(journal.mount());
+    FakeClock clock;
+    clock.setEpochBase(1767600000UL);
+
+    printf("heap use:\n");
+    TimerCore timer(&clock);
+    HeapProbe probe;
+    timer.begin(false);
+    timer.attachJournal(&journal);
+    HeapUse cold = probe.use();
+    report("cold load", cold);
+
+    timer.addTask();
+    timer.addTask();
+    probe = HeapProbe();
+    for (int i = 0; i < 20; i++) runSession(clock, timer);
+    HeapUse sessions = probe.use();
+    report("20 sessions + journal", sessions);
+
+    HeapUse worstSave = HeapUse();
+    for (uint32_t i = 0; i < SAVES; i++) {
+        timer.setWorkDuration(20 + i % 10);
+        probe = HeapProbe();
+        CHECK(timer.flushState());
+        HeapUse u = probe.use();
+        if (u.calls > worstSave.calls) worstSave.calls = u.calls;
+        if (u.peakGrowth > worstSave.peakGrowth) worstSave.peakGrowth = u.peakGrowth;
+    }
+    report("worst of 1000 saves", worstSave);
+
+    probe = HeapProbe();
+    timer.suspend();
+    HeapUse suspend = probe.use();
+    report("suspend", suspend);
+
+    // Wake from deep sleep: RTC snapshot and RTC history copy
+    TimerCore woken(&clock);
+    probe = HeapProbe();
+    CHECK(woken.begin(true));
+    woken.attachJournal(&journal);
+    HeapUse wake = probe.use();
+    report("wake from RTC memory", wake);
+
+    // Power-on: state slots and the journal
+    TimerCore rebooted(&clock);
+    probe = HeapProbe();
+    CHECK(!rebooted.begin(true));  // Snapshot already taken
+    rebooted.attachJournal(&journal);
+    HeapUse reboot = probe.use();
+    report("reload from flash", reboot);
+
+    CHECK_EQ(cold.calls, 0);
+    CHECK_EQ(sessions.calls, 0);
+    CHECK_EQ(worstSave.calls, 0);
+    CHECK_EQ(suspend.calls, 0);
+    CHECK_EQ(wake.calls, 0);
+    CHECK_EQ(reboot.calls, 0);
+    CHECK_EQ(cold.peakGrowth + sessions.peakGrowth + worstSave.peakGrowth +
+             suspend.peakGrowth + wake.peakGrowth + reboot.peakGrowth, 0);
+
+    CHECK_EQ(woken.getWorkDuration(), timer.getWorkDuration());
+    CHECK_EQ(rebooted.getWorkDuration(), timer.getWorkDuration());
+    CHECK_EQ(timer.getHistory().size(), 40);
+    CHECK_EQ(woken.getHistory().size(), 40);
+    CHECK_EQ(rebooted.getHistory().size(), 40);
+
+    return checkResult("zero_heap_test");
+}
@@ -0,0 +1,85 @@
+#include "tick_ring.h"
+
+namespace {
+
+// sin(i * 90° / 256) in Q14, i = 0..256
+const int16_t QUARTER_SINE[257] = {
+        0,   101,   201,   302,   402,   503,   603,   704,   804,   904,  1005,  1105,
+     1205,  1306,  1406,  1506,  1606,  1706,  1806,  1906,  2006,  2105,  2205,  2305,
+     2404,  2503,  2603,  2702,  2801,  2900,  2999,  3098,  3196,  3295,  3393,  3492,
+     3590,  3688,  3786,  3883,  3981,  4078,  4176,  4273,  4370,  4467,  4563,  4660,
+     4756,  4852,  4948,  5044,  5139,  5235,  5330,  5425,  5520,  5614,  5708,  5803,
+     5897,  5990,  6084,  6177,  6270,  6363,  6455,  6547,  6639,  6731,  6823,  6914,
+     7005,  7096,  7186,  7276,  7366,  7456,  7545,  7635,  7723,  7812,  7900,  7988,
+     8076,  8163,  8250,  8337,  8423,  8509,  8595,  8680,  8765,  8850,  8935,  9019,
+     9102,  9186,  9269,  9352,  9434,  9516,  9598,  9679,  9760,  9841,  9921, 10001,
+    10080, 10159, 10238, 10316, 10394, 10471, 10549, 10625, 10702, 10778, 10853, 10928,
+    11003, 11077, 11151, 11224, 11297, 11370, 11442, 11514, 11585, 11656, 11727, 11797,
+    11866, 11935, 12004, 12072, 12140, 12207, 12274, 12340, 12406, 12472, 12537, 12601,
+    12665, 12729, 12792, 12854, 12916, 12978, 13039, 13100, 13160, 13219, 13279, 13337,
+    13395, 13453, 13510, 13567, 13623, 13678, 13733, 13788, 13842, 13896, 13949, 14001,
+    14053, 14104, 14155, 14206, 14256, 14305, 14354, 14402, 14449, 14497, 14543, 14589,
+    14635, 14680, 14724, 14768, 14811, 14854, 14896, 14937, 14978, 15019, 15059, 15098,
+    15137, 15175, 15213, 15250, 15286, 15322, 15357, 15392, 15426, 15460, 15493, 15525,
+    15557, 15588, 15619, 15649, 15679, 15707, 15736, 15763, 15791, 15817, 15843, 15868,
+    15893, 15917, 15941, 15964, 15986, 16008, 16029, 16049, 16069, 16088, 16107, 16125,
+    16143, 16160, 16176, 16192, 16207, 16221, 16235, 16248, 16261, 16273, 16284, 16295,
+    16305, 16315, 16324, 16332, 16340, 16347, 16353, 16359, 16364, 16369, 16373, 16376,
+    16379, 16381, 16383, 16384, 16384,
+};
+
+const uint16_t QUARTER = TickRing::ANGLE_STEPS / 4;
+
+// Radius times a Q14 factor, rounded to the nearest pixel
+int16_t scale(int16_t radius, int16_t q14) {
+    int32_t v = (int32_t)radius * q14;
+    return (int16_t)((v + (v >= 0 ? 8192 : -8192)) / 16384);
+}
+
+} // namespace
+
+int16_t TickRing::sinQ14(uint16_t angle) {
+    angle %= ANGLE_STEPS;
+    uint16_t quadrant = angle / QUARTER;
+    uint16_t offset = angle % QUARTER;
+    switch (quadrant) {
+        case 0:  return QUARTER_SINE[offset];
+        case 1:  return QUARTER_SINE[QUARTER - offset];
+        case 2:  return (int16_t)-QUARTER_SINE[offset];
+        default: return (int16_t)-QUARTER_SINE[QUARTER - offset];
+    }
+}
+
+int16_t TickRing::cosQ14(uint16_t angle) {
+    return sinQ14((uint16_t)((angle % ANGLE_STEPS) + QUARTER));
+}
+
+TickRing::TickRing(int16_t innerRadius, int16_t outerRadius)
+  : inner(innerRadius),
+    outer(outerRadius),
+    ticks(0),
+    builds(0)
+{
+}
+
+bool TickRing::setCount(uint8_t count) {
+    if (count > MAX_TICKS) count = MAX_TICKS;
+    if (count == ticks) return false;
+
+    ticks = count;
+    builds++;
+    for (uint8_t i = 0; i < count; i++) {
+        // 12 o'clock is three quarters round from +x; y grows downwards,
+        // so increasing angles run clockwise on screen
+        uint16_t angle = (uint16_t)(3 * QUARTER + ((uint32_t)i * ANGLE_STEPS + count / 2) / count);
+        int16_t c = cosQ14(angle);
+        int16_t s = sinQ14(angle);
+        TickSegment& t = segments[i];
+        t.x1 = scale(inner, c);
+        t.y1 = scale(inner, s);
+        t.x2 = scale(outer, c);
+        t.y2 = scale(outer, s);
+        t.major = (i % 5 == 0);
+    }
+    return true;
+}
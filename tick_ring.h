@@ -0,0 +1,42 @@
+#pragma once
+#ifndef TICK_RING_H
+#define TICK_RING_H
+#include <stdint.h>
+
+// Tick marks around the work arc: evenly spaced radial segments starting
+// at 12 o'clock and going clockwise, every fifth one major. Endpoints are
+// relative to the ring centre (y down) and come from a fixed-point
+// quarter-wave sine table, so a rebuild needs no float or libm. They are
+// recomputed only when the tick count changes.
+struct TickSegment {
+    int16_t x1, y1;  // Inner end
+    int16_t x2, y2;  // Outer end
+    bool major;
+};
+
+class TickRing {
+public:
+    static const uint8_t MAX_TICKS = 60;
+    static const uint16_t ANGLE_STEPS = 1024;  // Angle units per full turn
+
+    TickRing(int16_t innerRadius, int16_t outerRadius);
+
+    // Rebuild for `count` ticks (clamped to MAX_TICKS); false if unchanged
+    bool setCount(uint8_t count);
+    uint8_t count() const { return ticks; }
+    const TickSegment& tick(uint8_t i) const { return segments[i]; }
+    uint16_t rebuilds() const { return builds; }
+
+    // Q14 sine and cosine of an angle in ANGLE_STEPS units
+    static int16_t sinQ14(uint16_t angle);
+    static int16_t cosQ14(uint16_t angle);
+
+private:
+    int16_t inner;
+    int16_t outer;
+    uint8_t ticks;
+    uint16_t builds;
+    TickSegment segments[MAX_TICKS];
+};
+
+#endif
@@ -0,0 +1,48 @@
+#include "timer_clock.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+#include <sys/time.h>
+#include <time.h>
+
+uint64_t EspTimerClock::nowMicros() const {
+    return (uint64_t)esp_timer_get_time();
+}
+
+uint32_t EspTimerClock::epochSeconds() const {
+    return (uint32_t)time(nullptr);
+}
+
+Clock& systemClock() {
+    static EspTimerClock clock;
+    return clock;
+}
+
+bool setWallClock(uint32_t seconds) {
+    struct timeval tv;
+    tv.tv_sec = (time_t)seconds;
+    tv.tv_usec = 0;
+    return settimeofday(&tv, nullptr) == 0;
+}
+#else
+#include <chrono>
+#include <ctime>
+
+uint64_t SteadyClock::nowMicros() const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t SteadyClock::epochSeconds() const {
+    return (uint32_t)std::time(nullptr);
+}
+
+Clock& systemClock() {
+    static SteadyClock clock;
+    return clock;
+}
+
+bool setWallClock(uint32_t) {
+    return false;
+}
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef TIMER_CLOCK_H
+#define TIMER_CLOCK_H
+#include <stdint.h>
+
+// Monotonic time source for TimerCore.
+// Timestamps are 64-bit microseconds since an arbitrary epoch (boot on the
+// device), so they never wrap during the lifetime of the timer.
+// epochSeconds() is wall-clock time for records that must outlive a boot;
+// it is not monotonic and is only as good as the RTC setting.
+class Clock {
+public:
+    virtual ~Clock() {}
+    virtual uint64_t nowMicros() const = 0;
+    virtual uint32_t epochSeconds() const = 0;
+    uint64_t nowMillis() const { return nowMicros() / 1000ULL; }
+
+    // False while epochSeconds() still counts from power-on
+    bool hasWallTime() const { return epochSeconds() >= WALL_CLOCK_MIN_EPOCH; }
+
+    static const uint32_t WALL_CLOCK_MIN_EPOCH = 1704067200UL;  // 2024-01-01 UTC
+};
+
+#ifdef ESP_PLATFORM
+// Device clock backed by esp_timer (1 us resolution)
+// Wall clock from the RTC (time()), which keeps counting through deep sleep
+// and resets but restarts at 0 on power-on, until setWallClock()
+class EspTimerClock : public Clock {
+public:
+    uint64_t nowMicros() const override;
+    uint32_t epochSeconds() const override;
+};
+#else
+// Host clock backed by std::chrono::steady_clock
+class SteadyClock : public Clock {
+public:
+    uint64_t nowMicros() const override;
+    uint32_t epochSeconds() const override;
+};
+#endif
+
+// Manually advanced clock for host-side simulation.
+// Inject into TimerCore to run days of pomodoro cycles without waiting.
+class FakeClock : public Clock {
+public:
+    explicit FakeClock(uint64_t startMicros = 0) : now(startMicros), epochBase(0) {}
+    uint64_t nowMicros() const override { return now; }
+    uint32_t epochSeconds() const override { return epochBase + (uint32_t)(now / 1000000ULL); }
+    void setEpochBase(uint32_t seconds) { epochBase = seconds; }  // Wall time at micros == 0
+
+    void setMicros(uint64_t micros) { now = micros; }
+    void advanceMicros(uint64_t micros) { now += micros; }
+    void advanceMillis(uint64_t millis) { now += millis * 1000ULL; }
+    void advanceSeconds(uint64_t seconds) { now += seconds * 1000000ULL; }
+
+private:
+    uint64_t now;
+    uint32_t epochBase;
+};
+
+// Clock used by TimerCore when none is injected
+Clock& systemClock();
+
+// Set the system wall clock to Unix time `seconds`; false if this platform
+// cannot (the host keeps its own time)
+bool setWallClock(uint32_t seconds);
+
+#endif
@@ -1,9 +1,36 @@
 
 #include "timer_core.h"
-#include <Preferences.h>
-
-TimerCore::TimerCore()
-  : state(TimerState::IDLE),
+#include "session_journal.h"
+#include "rtc_snapshot.h"
+#include "settings_store.h"
+#include "core_log.h"
+#include <stdio.h>
+#include <string.h>
+
+// The persistence path allocates nothing: records are built in one static
+// buffer (load, save and suspend all run on the loop task, never nested)
+// and the legacy NVS key names come from tables instead of String concatenation.
+namespace {
+
+uint8_t recordBuffer[STATE_RECORD_MAX];
+
+const char* const LEGACY_COMPLETED_KEYS[] = {
+  "comp0", "comp1", "comp2", "comp3", "comp4", "comp5",
+  "comp6", "comp7", "comp8", "comp9", "comp10", "comp11"
+};
+const char* const LEGACY_INTERRUPTED_KEYS[] = {
+  "int0", "int1", "int2", "int3", "int4", "int5",
+  "int6", "int7", "int8", "int9", "int10", "int11"
+};
+static_assert(sizeof(LEGACY_COMPLETED_KEYS) / sizeof(LEGACY_COMPLETED_KEYS[0]) == LEGACY_TASK_SLOTS &&
+              sizeof(LEGACY_INTERRUPTED_KEYS) / sizeof(LEGACY_INTERRUPTED_KEYS[0]) == LEGACY_TASK_SLOTS,
+              "One legacy key per task slot");
+
+} // namespace
+
+TimerCore::TimerCore(Clock* clock)
+  : clock(clock != nullptr ? clock : &systemClock()),
+    state(TimerState::IDLE),
     previousState(TimerState::IDLE),
     startTime(0),
     pausedTime(0),
@@ -13,14 +40,17 @@ TimerCore::TimerCore()
     shortBreakDuration(SHORT_BREAK_DURATION),
     longBreakDuration(LONG_BREAK_DURATION),
     completedSessions(0),
-    totalTasks(1),
     currentTaskId(0),
     pomodorosBeforeLongBreak(POMODOROS_BEFORE_LONG_BREAK),
     pomodorosSinceLastLongBreak(0),
     idleTimeoutBattery(IDLE_TIMEOUT_BATTERY_MINUTES),
     idleTimeoutUSB(IDLE_TIMEOUT_USB_MINUTES),
     sleepOnUSB(true),
-    idleStartTime(millis()),
+    idleStartTime(now()),
+    lastIdleMinutes(0),
+    journal(nullptr),
+    sessionStartEpoch(0),
+    sessionPausedUs(0),
     brightnessLevel(4),
     themeId(1),
     screenFlipped(false),
@@ -30,6 +60,9 @@ TimerCore::TimerCore()
     alertStartTime(0),
     alertActive(false),
     blinkCount(0),
+    legacyKeys(false),
+    dirtyFields(0),
+    dirtySince(0),
     windupEnabled(false),
     windupValue(0),
     windupStartTime(0),
@@ -37,17 +70,36 @@ TimerCore::TimerCore()
     currentMenuItem(MenuItem::POMODORO_LENGTH),
     editingValue(0)
 {
+}
 
-
-  // Initialize arrays
-  for (int i = 0; i < MAX_TASKS; i++) {
-    completedPomodoros[i] = 0;
-    interruptedPomodoros[i] = 0;
+bool TimerCore::begin(bool wokeFromSleep) {
+  coreLog("TimerCore initializing...\n");
+  uint64_t start_us = now();
+  bool resumed = false;
+
+  if (wokeFromSleep) {
+    bool unsaved = false;
+    size_t record_len = takeRtcSnapshot(recordBuffer, sizeof(recordBuffer), &unsaved);
+    size_t payload_len = 0;
+    uint16_t version = 0;
+    const uint8_t* payload = record_len ? openStateRecord(recordBuffer, record_len, &payload_len, &version)
+                                        : nullptr;
+    resumed = payload != nullptr && unpackState(payload, payload_len, version, true);
+    if (resumed) {
+      sanitizeState();
+      // The last flush before sleep did not finish: write it again
+      if (unsaved) markDirty(DIRTY_SETTINGS | DIRTY_TASKS | DIRTY_STATS);
+      coreLog("State resumed from RTC snapshot%s in %lu us\n",
+                    unsaved ? " (unsaved)" : "", (unsigned long)(now() - start_us));
+    } else {
+      coreLog("No usable RTC snapshot, loading from flash\n");
+    }
   }
+  if (!resumed) loadState();
 
-  Serial.println("TimerCore initializing...");
-  loadState();  // Load saved state
-  Serial.println("TimerCore initialization complete");
+  idleStartTime = now();
+  coreLog("TimerCore initialization complete\n");
+  return resumed;
 }
 
 
@@ -56,17 +108,20 @@ TimerCore::TimerCore()
 // For menu options
 void TimerCore::setWorkDuration(uint8_t minutes) { 
     workDuration = minutes; 
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::POMODORO_LENGTH);
+    markDirty(DIRTY_SETTINGS);
 }
 
 void TimerCore::setShortBreakDuration(uint8_t minutes) { 
     shortBreakDuration = minutes; 
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::SHORT_BREAK_LENGTH);
+    markDirty(DIRTY_SETTINGS);
 }
 
 void TimerCore::setLongBreakDuration(uint8_t minutes) { 
     longBreakDuration = minutes; 
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::LONG_BREAK_LENGTH);
+    markDirty(DIRTY_SETTINGS);
 }
 
 void TimerCore::setPomodorosBeforeLongBreak(uint8_t count) { 
@@ -74,7 +129,8 @@ void TimerCore::setPomodorosBeforeLongBreak(uint8_t count) {
     if (pomodorosSinceLastLongBreak > pomodorosBeforeLongBreak) {
         pomodorosSinceLastLongBreak = pomodorosBeforeLongBreak;
     }
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::POMODOROS_BEFORE_LONG_BREAK);
+    markDirty(DIRTY_SETTINGS);
 }
 
 // Power Setting
@@ -84,34 +140,40 @@ void TimerCore::setPomodorosBeforeLongBreak(uint8_t count) {
 // }
 void TimerCore::setIdleTimeoutBattery(uint8_t minutes) { 
     idleTimeoutBattery = minutes; 
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::IDLE_TIMEOUT_BATTERY);
+    markDirty(DIRTY_SETTINGS);
 }
 
 void TimerCore::setIdleTimeoutUSB(uint8_t minutes) { 
     idleTimeoutUSB = minutes; 
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::IDLE_TIMEOUT_USB);
+    markDirty(DIRTY_SETTINGS);
 }
 
 void TimerCore::setSleepOnUSB(bool enabled) {
     sleepOnUSB = enabled;
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::IDLE_SLEEP_ON_USB);
+    markDirty(DIRTY_SETTINGS);
 }
 
 
 
 void TimerCore::setBrightnessLevel(uint8_t level) { 
     brightnessLevel = level; 
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::BRIGHTNESS);
+    markDirty(DIRTY_SETTINGS);
 }
 
 void TimerCore::setTheme(uint8_t theme) {
     themeId = theme;
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::THEME);
+    markDirty(DIRTY_SETTINGS);
 }
 
 void TimerCore::setScreenFlipped(bool flipped) {
     screenFlipped = flipped;
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::SCREEN_ORIENTATION);
+    markDirty(DIRTY_SETTINGS);
 }
 
 void TimerCore::setPomodorosSinceLastLongBreak(uint8_t count) {
@@ -119,13 +181,15 @@ void TimerCore::setPomodorosSinceLastLongBreak(uint8_t count) {
         count = pomodorosBeforeLongBreak;
     }
     pomodorosSinceLastLongBreak = count;
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::LONG_BREAK_PROGRESS);
+    markDirty(DIRTY_SETTINGS);
 }
 
 // Windup toggle
 void TimerCore::setWindupEnabled(bool enabled) {
     windupEnabled = enabled;
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::ENABLE_WINDUP);
+    markDirty(DIRTY_SETTINGS);
 }
 
 // wind-up method implementations:
@@ -135,18 +199,12 @@ void TimerCore::startWindup() {
       return;
    }
     
-   state = TimerState::WIND_UP;
-   windupValue = 0;
-   Serial.println("Wind-up started - windupValue reset to 0");
+   dispatch(TimerEvent::START_WINDUP);
 }
 
 
 void TimerCore::cancelWindup() {
-    if (state == TimerState::WIND_UP) {
-        state = TimerState::IDLE;
-        windupValue = 0;
-        Serial.println("Wind-up cancelled");
-    }
+    dispatch(TimerEvent::CANCEL_WINDUP);
 }
 
 void TimerCore::incrementWindup(int8_t direction) {
@@ -161,27 +219,18 @@ void TimerCore::incrementWindup(int8_t direction) {
     if (newValue < 0) newValue = 0;
     if (newValue > maxSeconds) newValue = maxSeconds;
     
+    if ((uint32_t)newValue != windupValue) notify(ChangeType::SECOND);
     windupValue = newValue;
     
     // Auto-start when fully wound up
     if (windupValue >= maxSeconds) {
-        Serial.println("Fully wound up - auto-starting work");
+        coreLog("Fully wound up - auto-starting work\n");
         startWorkFromWindup();
     }
 }
 
 void TimerCore::startWorkFromWindup() {
-    if (state != TimerState::WIND_UP) return;
-    
-    // Start work with the wound-up duration
-    duration = windupValue;
-    remainingTime = duration;
-    startTime = 0;
-    windupStartTime = millis();
-    state = TimerState::STARTING;
-    windupValue = 0;  // Reset for next time
-    
-    Serial.printf("Work started from wind-up - Duration: %lu seconds\n", duration);
+    dispatch(TimerEvent::CONFIRM_WINDUP);
 }
 
 uint32_t TimerCore::getWindupPercentage() const {
@@ -195,39 +244,48 @@ uint32_t TimerCore::getWindupPercentage() const {
 // Alarm settings
 void TimerCore::setAlarmDuration(uint8_t seconds) {
     alarmDuration = seconds;
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::ALARM_DURATION);
+    markDirty(DIRTY_SETTINGS);
 }
 
 void TimerCore::setAlarmVibration(bool enabled) {
     alarmVibrationEnabled = enabled;
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::ALARM_VIBRATION);
+    markDirty(DIRTY_SETTINGS);
 }
 
 void TimerCore::setAlarmFlash(bool enabled) {
     alarmFlashEnabled = enabled;
-    saveState();
+    notify(ChangeType::SETTINGS, (uint8_t)MenuItem::ALARM_FLASH);
+    markDirty(DIRTY_SETTINGS);
 }
 
 void TimerCore::setTotalTasks(uint8_t count) {
-    totalTasks = count;
+    tasks.setCount(count);
     // Make sure current task is valid
-    if (currentTaskId >= totalTasks) {
-        currentTaskId = totalTasks - 1;
+    if (currentTaskId >= tasks.count()) {
+        currentTaskId = tasks.count() - 1;
     }
-    saveState();
+    recountTotals();
+    notify(ChangeType::TASK);
+    markDirty(DIRTY_SETTINGS | DIRTY_TASKS);
 }
 
 void TimerCore::setTaskCompletedPomodoros(uint8_t taskId, uint8_t count) {
     if (taskId < MAX_TASKS) {
-        completedPomodoros[taskId] = count;
-        saveState();
+        tasks.setCompleted(taskId, count);
+        recountTotals();
+        notify(ChangeType::STATS);
+        markDirty(DIRTY_TASKS);
     }
 }
 
 void TimerCore::setTaskInterruptedPomodoros(uint8_t taskId, uint8_t count) {
     if (taskId < MAX_TASKS) {
-        interruptedPomodoros[taskId] = count;
-        saveState();
+        tasks.setInterrupted(taskId, count);
+        recountTotals();
+        notify(ChangeType::STATS);
+        markDirty(DIRTY_TASKS);
     }
 }
 
@@ -235,13 +293,15 @@ void TimerCore::openMenu() {
     if (state == TimerState::IDLE) {
         menuState = MenuState::MENU_LIST;
         currentMenuItem = MenuItem::POMODORO_LENGTH;
-        Serial.println("Menu opened");
+        notify(ChangeType::MENU);
+        coreLog("Menu opened\n");
     }
 }
 
 void TimerCore::closeMenu() {
     menuState = MenuState::CLOSED;
-    Serial.println("Menu closed");
+    notify(ChangeType::MENU);
+    coreLog("Menu closed\n");
 }
 
 void TimerCore::navigateMenu(int8_t direction) {
@@ -257,266 +317,135 @@ void TimerCore::navigateMenu(int8_t direction) {
     }
     
     currentMenuItem = static_cast<MenuItem>(newItem);
-    Serial.printf("Menu item: %d\n", newItem);
+    notify(ChangeType::MENU);
+    coreLog("Menu item: %d\n", newItem);
+}
+
+const MenuDescriptor& TimerCore::menuDescriptor(MenuItem item) {
+    typedef TimerCore T;
+    // Rows in MenuItem order; constant-initialized, so the table lives in flash
+    static constexpr MenuDescriptor ITEMS[] = {
+        {"Pomodoro Length",        MenuUnit::MINUTES,     1, 60, 1, false, false,
+         &T::getWorkDuration, &T::setWorkDuration, nullptr},
+        {"Short Break Length",     MenuUnit::MINUTES,     1, 15, 1, false, false,
+         &T::getShortBreakDuration, &T::setShortBreakDuration, nullptr},
+        {"Long Break Length",      MenuUnit::MINUTES,     5, 30, 1, false, false,
+         &T::getLongBreakDuration, &T::setLongBreakDuration, nullptr},
+        {"Pomodoros Before Break", MenuUnit::POMODOROS,   2, 10, 1, false, false,
+         &T::getPomodorosBeforeLongBreak, &T::setPomodorosBeforeLongBreak, nullptr},
+        {"Long Break Progress",    MenuUnit::PROGRESS,    0, 10, 1, false, false,
+         &T::getPomodorosSinceLastLongBreak, &T::setPomodorosSinceLastLongBreak,
+         &T::getPomodorosBeforeLongBreak},
+        {"Total Tasks",            MenuUnit::TASKS,       1, MAX_TASKS, 1, false, false,
+         &T::getTotalTasks, &T::setTotalTasks, nullptr},
+        {"Task %d Completed",      MenuUnit::COUNT,       0, 99, 1, false, true,
+         &T::menuGetCompleted, &T::menuSetCompleted, nullptr},
+        {"Task %d Interrupted",    MenuUnit::COUNT,       0, 99, 1, false, true,
+         &T::menuGetInterrupted, &T::menuSetInterrupted, nullptr},
+        {"Idle Timeout (Battery)", MenuUnit::MINUTES,     1, 30, 1, false, false,
+         &T::getIdleTimeoutBattery, &T::setIdleTimeoutBattery, nullptr},
+        {"Idle Timeout (USB)",     MenuUnit::MINUTES,     1, 60, 1, false, false,
+         &T::getIdleTimeoutUSB, &T::setIdleTimeoutUSB, nullptr},
+        {"Sleep When on USB",      MenuUnit::ON_OFF,      0, 1, 1, true, false,
+         &T::menuGetSleepOnUSB, &T::menuSetSleepOnUSB, nullptr},
+        {"Brightness",             MenuUnit::LEVEL_PCT,   0, 7, 1, false, false,
+         &T::getBrightnessLevel, &T::setBrightnessLevel, nullptr},
+        {"Theme",                  MenuUnit::THEME,       1, 2, 1, false, false,
+         &T::getTheme, &T::setTheme, nullptr},
+        {"Wind-up Mode",           MenuUnit::ON_OFF,      0, 1, 1, true, false,
+         &T::menuGetWindup, &T::menuSetWindup, nullptr},
+        {"Alarm Duration",         MenuUnit::SECONDS,     1, 10, 1, false, false,
+         &T::getAlarmDuration, &T::setAlarmDuration, nullptr},
+        {"Haptic Feedback",        MenuUnit::ON_OFF,      0, 1, 1, true, false,
+         &T::menuGetVibration, &T::menuSetVibration, nullptr},
+        {"Alarm Flash",            MenuUnit::ON_OFF,      0, 1, 1, true, false,
+         &T::menuGetFlash, &T::menuSetFlash, nullptr},
+        {"Orientation",            MenuUnit::ORIENTATION, 0, 1, 1, true, false,
+         &T::menuGetFlipped, &T::menuSetFlipped, nullptr},
+    };
+    static_assert(sizeof(ITEMS) / sizeof(ITEMS[0]) == (size_t)MenuItem::MENU_ITEM_COUNT,
+                  "Menu descriptor table must have one row per MenuItem");
+
+    uint8_t index = static_cast<uint8_t>(item);
+    if (index >= static_cast<uint8_t>(MenuItem::MENU_ITEM_COUNT)) index = 0;
+    return ITEMS[index];
+}
+
+uint8_t TimerCore::getMenuValue(MenuItem item) const {
+    const MenuDescriptor& d = menuDescriptor(item);
+    return (this->*d.get)();
+}
+
+uint8_t TimerCore::getMenuMax(MenuItem item) const {
+    const MenuDescriptor& d = menuDescriptor(item);
+    return d.dynamicMax ? (this->*d.dynamicMax)() : d.max;
+}
+
+void TimerCore::formatMenuLabel(MenuItem item, char* buf, size_t len) const {
+    const MenuDescriptor& d = menuDescriptor(item);
+    if (d.perTask) {
+        snprintf(buf, len, d.label, currentTaskId + 1);
+    } else {
+        snprintf(buf, len, "%s", d.label);
+    }
+}
+
+void TimerCore::formatMenuValue(MenuItem item, uint8_t value, char* buf, size_t len) const {
+    switch (menuDescriptor(item).unit) {
+        case MenuUnit::MINUTES:     snprintf(buf, len, "%d min", value); break;
+        case MenuUnit::SECONDS:     snprintf(buf, len, "%d sec", value); break;
+        case MenuUnit::COUNT:       snprintf(buf, len, "%d", value); break;
+        case MenuUnit::POMODOROS:   snprintf(buf, len, "%d pomodoros", value); break;
+        case MenuUnit::TASKS:       snprintf(buf, len, "%d tasks", value); break;
+        case MenuUnit::LEVEL_PCT:   snprintf(buf, len, "%d%%", (int)((value + 1) * 12.5)); break;  // 0-7 -> ~12-100%
+        case MenuUnit::THEME:       snprintf(buf, len, "Theme %d", value); break;
+        case MenuUnit::PROGRESS:    snprintf(buf, len, "%d / %d", value, getMenuMax(item)); break;
+        case MenuUnit::ON_OFF:      snprintf(buf, len, "%s", value ? "ON" : "OFF"); break;
+        case MenuUnit::ORIENTATION: snprintf(buf, len, "%s", value ? "Flipped" : "Normal"); break;
+    }
 }
 
 void TimerCore::selectMenuItem() {
     if (menuState == MenuState::MENU_LIST) {
         menuState = MenuState::EDITING_VALUE;
-        
-        // Load current value based on menu item
-        switch (currentMenuItem) {
-            case MenuItem::POMODORO_LENGTH:
-                editingValue = workDuration;
-                break;
-            case MenuItem::SHORT_BREAK_LENGTH:
-                editingValue = shortBreakDuration;
-                break;
-            case MenuItem::LONG_BREAK_LENGTH:
-                editingValue = longBreakDuration;
-                break;
-            case MenuItem::POMODOROS_BEFORE_LONG_BREAK:
-                editingValue = pomodorosBeforeLongBreak;
-                break;
-            case MenuItem::LONG_BREAK_PROGRESS:
-                editingValue = pomodorosSinceLastLongBreak;
-                break;
-            case MenuItem::MANAGE_TASKS:
-                editingValue = totalTasks;
-                break;
-            case MenuItem::EDIT_COMPLETED_POMODOROS:
-                editingValue = completedPomodoros[currentTaskId];
-                break;
-            case MenuItem::EDIT_INTERRUPTED_POMODOROS:
-                editingValue = interruptedPomodoros[currentTaskId];
-                break;                
-            // case MenuItem::IDLE_TIMEOUT_MINUTES:
-            //     editingValue = idleTimeoutDuration;
-            //     break;
-            case MenuItem::IDLE_TIMEOUT_BATTERY:
-                editingValue = idleTimeoutBattery;
-                break;
-            case MenuItem::IDLE_TIMEOUT_USB:
-                editingValue = idleTimeoutUSB;
-                break;
-            case MenuItem::IDLE_SLEEP_ON_USB:
-                editingValue = sleepOnUSB ? 1 : 0;
-                break;
-
-            case MenuItem::BRIGHTNESS:
-                editingValue = brightnessLevel;
-                break;
-            case MenuItem::THEME:
-                editingValue = themeId;
-                break;
-            case MenuItem::SCREEN_ORIENTATION:
-                editingValue = screenFlipped ? 1 : 0;
-                break;
-            case MenuItem::ENABLE_WINDUP:
-                editingValue = windupEnabled ? 1 : 0;
-                break;                
-            case MenuItem::ALARM_DURATION:
-                editingValue = alarmDuration;
-                break;
-            case MenuItem::ALARM_VIBRATION:
-                editingValue = alarmVibrationEnabled ? 1 : 0;
-                break;
-            case MenuItem::ALARM_FLASH:
-                editingValue = alarmFlashEnabled ? 1 : 0;
-                break;
-            default:
-                editingValue = 0;
-        }
-        Serial.printf("Editing value: %d\n", editingValue);
+        editingValue = getMenuValue(currentMenuItem);
+        notify(ChangeType::MENU);
+        coreLog("Editing value: %d\n", editingValue);
     }
 }
 
 void TimerCore::adjustValue(int8_t direction) {
     if (menuState != MenuState::EDITING_VALUE) return;
-    
-   switch (currentMenuItem) {
-      case MenuItem::POMODORO_LENGTH:
-         editingValue += direction;
-         if (editingValue < 1) editingValue = 1;
-         if (editingValue > 60) editingValue = 60;
-         break;
-      case MenuItem::SHORT_BREAK_LENGTH:
-         editingValue += direction;
-         if (editingValue < 1) editingValue = 1;
-         if (editingValue > 15) editingValue = 15;
-         break;            
-      case MenuItem::LONG_BREAK_LENGTH:
-         editingValue += direction;
-         if (editingValue < 5) editingValue = 5;
-         if (editingValue > 30) editingValue = 30;
-         break;            
-      case MenuItem::POMODOROS_BEFORE_LONG_BREAK:
-         editingValue += direction;
-         if (editingValue < 2) editingValue = 2;
-         if (editingValue > 10) editingValue = 10;
-         break;
-      case MenuItem::LONG_BREAK_PROGRESS:
-         {
-             int16_t newValue = editingValue + direction;
-             if (newValue < 0) newValue = 0;
-             if (newValue > pomodorosBeforeLongBreak) newValue = pomodorosBeforeLongBreak;
-             editingValue = newValue;
-         }
-         break;
-      case MenuItem::MANAGE_TASKS:
-         {
-             int16_t newValue = editingValue + direction;
-             if (newValue < 1) newValue = 1;
-             if (newValue > MAX_TASKS) newValue = MAX_TASKS;
-             editingValue = newValue;
-         }
-         break;
-      case MenuItem::EDIT_COMPLETED_POMODOROS:
-      case MenuItem::EDIT_INTERRUPTED_POMODOROS:
-         {
-             int16_t newValue = editingValue + direction;
-             if (newValue < 0) newValue = 0;
-             if (newValue > 99) newValue = 99;
-             editingValue = newValue;
-         }
-         break;            
-      // case MenuItem::IDLE_TIMEOUT_MINUTES:
-      //    editingValue += direction;
-      //    if (editingValue < 1) editingValue = 1;
-      //    if (editingValue > 30) editingValue = 30;
-      //    break;
-        case MenuItem::IDLE_TIMEOUT_BATTERY:
-            editingValue += direction;
-            if (editingValue < 1) editingValue = 1;
-            if (editingValue > 30) editingValue = 30;
-            break;
-        case MenuItem::IDLE_TIMEOUT_USB:
-            editingValue += direction;
-            if (editingValue < 1) editingValue = 1;
-            if (editingValue > 60) editingValue = 60;  // Longer max for USB
-            break;
-        case MenuItem::IDLE_SLEEP_ON_USB:
-            editingValue = editingValue ? 0 : 1;
-            break;         
-      case MenuItem::BRIGHTNESS:
-         if (direction < 0 && editingValue == 0) {
-             editingValue = 0;
-         } else if (direction > 0 && editingValue == 7) {
-             editingValue = 7;
-         } else {
-             editingValue += direction;
-         }
-         break;
-      case MenuItem::THEME:
-         editingValue += direction;
-         if (editingValue < 1) editingValue = 1;
-         if (editingValue > 2) editingValue = 2;
-         break;
-      case MenuItem::ALARM_DURATION:
-         editingValue += direction;
-         if (editingValue < 1) editingValue = 1;
-         if (editingValue > 10) editingValue = 10;
-         break;
-      case MenuItem::SCREEN_ORIENTATION:
-      case MenuItem::ENABLE_WINDUP:
-      case MenuItem::ALARM_VIBRATION:
-      case MenuItem::ALARM_FLASH:
-         // Toggle between 0 and 1
-         editingValue = editingValue ? 0 : 1;
-         break;
-      default:
-         break;
+
+    const MenuDescriptor& d = menuDescriptor(currentMenuItem);
+    if (d.toggle) {
+        editingValue = editingValue ? 0 : 1;
+    } else {
+        int16_t newValue = editingValue + direction * d.step;
+        if (newValue < d.min) newValue = d.min;
+        if (newValue > getMenuMax(currentMenuItem)) newValue = getMenuMax(currentMenuItem);
+        editingValue = newValue;
     }
-    Serial.printf("Adjusted value: %d\n", editingValue);
+    notify(ChangeType::MENU);
+    coreLog("Adjusted value: %d\n", editingValue);
 }
 
 void TimerCore::confirmValue() {
-   if (menuState != MenuState::EDITING_VALUE) return;
-    
-   // Apply the value
-   switch (currentMenuItem) {
-      case MenuItem::POMODORO_LENGTH:
-         setWorkDuration(editingValue);
-         Serial.printf("Pomodoro length set to: %d min\n", editingValue);
-         break;
-      case MenuItem::SHORT_BREAK_LENGTH:
-         setShortBreakDuration(editingValue);
-         Serial.printf("Short Break length set to: %d min\n", editingValue);
-         break; 
-      case MenuItem::LONG_BREAK_LENGTH:
-         setLongBreakDuration(editingValue);
-         Serial.printf("Long Break length set to: %d min\n", editingValue);
-         break; 
-      case MenuItem::POMODOROS_BEFORE_LONG_BREAK:
-         setPomodorosBeforeLongBreak(editingValue);
-         Serial.printf("n Pomodoros Before long break set to: %d pomodoros\n", editingValue);
-         break;
-      case MenuItem::LONG_BREAK_PROGRESS:
-         setPomodorosSinceLastLongBreak(editingValue);
-         Serial.printf("Pomodoros since last long break set to: %d\n", editingValue);
-         break;
-      case MenuItem::MANAGE_TASKS:
-         setTotalTasks(editingValue);
-         Serial.printf("Total tasks set to: %d\n", editingValue);
-         break;
-      case MenuItem::EDIT_COMPLETED_POMODOROS:
-         setTaskCompletedPomodoros(currentTaskId, editingValue);
-         Serial.printf("Task %d completed pomodoros set to: %d\n", currentTaskId + 1, editingValue);
-         break;
-      case MenuItem::EDIT_INTERRUPTED_POMODOROS:
-         setTaskInterruptedPomodoros(currentTaskId, editingValue);
-         Serial.printf("Task %d interrupted pomodoros set to: %d\n", currentTaskId + 1, editingValue);
-         break;            
-      // case MenuItem::IDLE_TIMEOUT_MINUTES:
-      //    setIdleTimeoutDuration(editingValue);
-      //    Serial.printf("Idle timeout time set to: %d min\n", editingValue);
-      //    break;
-        case MenuItem::IDLE_TIMEOUT_BATTERY:
-            setIdleTimeoutBattery(editingValue);
-            Serial.printf("Battery idle timeout set to: %d min\n", editingValue);
-            break;
-        case MenuItem::IDLE_TIMEOUT_USB:
-            setIdleTimeoutUSB(editingValue);
-            Serial.printf("USB idle timeout set to: %d min\n", editingValue);
-            break;
-        case MenuItem::IDLE_SLEEP_ON_USB:
-            setSleepOnUSB(editingValue != 0);
-            Serial.printf("Sleep on USB set to: %s\n", editingValue ? "ON" : "OFF");
-            break;
-      case MenuItem::BRIGHTNESS:
-         setBrightnessLevel(editingValue);
-         Serial.printf("Brightness level set to: %d\n", editingValue);
-         break;
-      case MenuItem::THEME:
-         setTheme(editingValue);
-         Serial.printf("Theme set to: %d\n", editingValue);
-         break;
-      case MenuItem::SCREEN_ORIENTATION:
-         setScreenFlipped(editingValue != 0);
-         Serial.printf("Screen orientation set to: %s\n", editingValue ? "Flipped" : "Normal");
-         break;
-      case MenuItem::ENABLE_WINDUP:
-            setWindupEnabled(editingValue != 0);
-            Serial.printf("Wind-up mode set to: %s\n", editingValue ? "ON" : "OFF");
-            break;
-      case MenuItem::ALARM_DURATION:
-         setAlarmDuration(editingValue);
-         Serial.printf("Alarm duration set to: %d sec\n", editingValue);
-         break;
-      case MenuItem::ALARM_VIBRATION:
-         setAlarmVibration(editingValue != 0);
-         Serial.printf("Alarm vibration set to: %s\n", editingValue ? "ON" : "OFF");
-         break;
-      case MenuItem::ALARM_FLASH:
-         setAlarmFlash(editingValue != 0);
-         Serial.printf("Alarm flash set to: %s\n", editingValue ? "ON" : "OFF");
-         break;
-      default:
-         break;
-    }
-    
+    if (menuState != MenuState::EDITING_VALUE) return;
+
+    // Apply the value
+    const MenuDescriptor& d = menuDescriptor(currentMenuItem);
+    (this->*d.set)(editingValue);
+
+    char label[32];
+    char value[16];
+    formatMenuLabel(currentMenuItem, label, sizeof(label));
+    formatMenuValue(currentMenuItem, editingValue, value, sizeof(value));
+    coreLog("%s set to: %s\n", label, value);
+
     // Return to menu list
     menuState = MenuState::MENU_LIST;
+    notify(ChangeType::MENU);
 }
 
 // USB power detection method:
@@ -542,325 +471,841 @@ bool TimerCore::checkIdleTimeout(float batteryVoltage) {
     // Use appropriate timeout based on power source
     uint8_t timeout_minutes = onUSB ? idleTimeoutUSB : idleTimeoutBattery;
     uint32_t timeout_ms = timeout_minutes * 60 * 1000;
-    uint32_t elapsed_ms = millis() - idleStartTime;
     
-    static uint32_t lastDebug = 0;
-    if (millis() - lastDebug > 10000) {
-        Serial.printf("Idle timeout: %d/%d seconds (set to %d min, %s power, %.2fV)\n", 
-                      elapsed_ms/1000, timeout_ms/1000, timeout_minutes,
-                      onUSB ? "USB" : "Battery", batteryVoltage);
-        lastDebug = millis();
+    return getIdleElapsedMs() >= timeout_ms;
+}
+
+void TimerCore::logIdleStatus(float batteryVoltage) const {
+    bool onUSB = isOnUSBPower(batteryVoltage);
+    if (state != TimerState::IDLE || (onUSB && !sleepOnUSB)) return;
+
+    uint8_t timeout_minutes = onUSB ? idleTimeoutUSB : idleTimeoutBattery;
+    uint32_t timeout_ms = timeout_minutes * 60 * 1000;
+    coreLog("Idle timeout: %d/%d seconds (set to %d min, %s power, %.2fV)\n", 
+                  getIdleElapsedMs()/1000, timeout_ms/1000, timeout_minutes,
+                  onUSB ? "USB" : "Battery", batteryVoltage);
+}
+
+
+uint32_t TimerCore::getElapsedMs() const {
+    uint64_t elapsed_us;
+    switch (state) {
+        case TimerState::WORK:
+        case TimerState::SHORT_BREAK:
+        case TimerState::LONG_BREAK:
+            elapsed_us = now() - startTime;
+            break;
+        case TimerState::PAUSED_WORK:
+        case TimerState::PAUSED_SHORT_BREAK:
+        case TimerState::PAUSED_LONG_BREAK:
+            elapsed_us = pausedTime - startTime;
+            break;
+        case TimerState::ALERT:
+            return duration * 1000UL;
+        default:
+            return 0;
+    }
+
+    uint64_t duration_us = duration * 1000000ULL;
+    if (elapsed_us > duration_us) elapsed_us = duration_us;
+    return (uint32_t)(elapsed_us / 1000ULL);
+}
+
+TimerProgress TimerCore::getProgress() const {
+    TimerProgress progress;
+    uint32_t duration_ms = duration * 1000UL;
+    progress.elapsedMs = getElapsedMs();
+    progress.remainingMs = duration_ms - progress.elapsedMs;
+    progress.progressQ16 = (duration_ms == 0) ? 0 :
+        (uint32_t)(((uint64_t)progress.elapsedMs << 16) / duration_ms);
+    return progress;
+}
+
+uint64_t TimerCore::nextDeadline() const {
+    uint64_t deadline = nextStateDeadline();
+    if (dirtyFields != 0) {
+        uint64_t save_at = dirtySince + SAVE_QUIET_MS * 1000ULL;
+        if (save_at < deadline) deadline = save_at;
+    }
+    return deadline;
+}
+
+uint64_t TimerCore::nextStateDeadline() const {
+    if (alertActive) {
+        // Next blink edge, or the end of the alert if that comes first
+        uint64_t blink_us = ALERT_BLINK_INTERVAL_MS * 1000ULL;
+        uint64_t elapsed = now() - alertStartTime;
+        uint64_t next_blink = alertStartTime + (elapsed / blink_us + 1) * blink_us;
+        uint64_t alert_end = alertStartTime + alarmDuration * 1000000ULL;
+        return (next_blink < alert_end) ? next_blink : alert_end;
+    }
+
+    switch (state) {
+        case TimerState::STARTING:
+            return windupStartTime + WINDUP_START_DELAY_MS * 1000ULL;
+
+        case TimerState::WORK:
+        case TimerState::SHORT_BREAK:
+        case TimerState::LONG_BREAK: {
+            // Remaining seconds change on every whole second since start
+            uint64_t elapsed = now() - startTime;
+            return startTime + (elapsed / 1000000ULL + 1) * 1000000ULL;
+        }
+
+        case TimerState::IDLE: {
+            // Idle label and idle timeout both move on whole minutes
+            uint64_t elapsed = now() - idleStartTime;
+            return idleStartTime + (elapsed / 60000000ULL + 1) * 60000000ULL;
+        }
+
+        default:
+            // Paused and wind-up only change on input
+            return TIMER_NO_DEADLINE;
     }
-    
-    return elapsed_ms >= timeout_ms;
 }
 
 
+// Persisted state is a single StateRecord, kept in the A/B flash slots
+// (or as the NVS blob "state" when there is no slot partition). Older
+// firmware wrote the blob or one key per setting; those are read once and
+// dropped from NVS by the next save.
 void TimerCore::loadState() {
-  Serial.println("Loading state from Preferences...");
-  
-  Preferences prefs;
-  prefs.begin("pomodoro", true);
-  
-  totalTasks = prefs.getUChar("totalTasks", 1);
-  currentTaskId = prefs.getUChar("currentTask", 0);
-  workDuration = prefs.getUChar("workDuration", WORK_DURATION);
-  shortBreakDuration = prefs.getUChar("shortBreak", SHORT_BREAK_DURATION);
-  longBreakDuration = prefs.getUChar("longBreak", LONG_BREAK_DURATION);
-  pomodorosBeforeLongBreak = prefs.getUChar("pomosB4Long", POMODOROS_BEFORE_LONG_BREAK);
-  pomodorosSinceLastLongBreak = prefs.getUChar("pomosSince", 0);
-  if (pomodorosSinceLastLongBreak > pomodorosBeforeLongBreak) {
-    pomodorosSinceLastLongBreak = pomodorosBeforeLongBreak;
+  coreLog("Loading state...\n");
+  uint64_t start_us = now();
+
+  size_t payload_len = 0;
+  uint16_t version = 0;
+  const uint8_t* payload = nullptr;
+  char source[32] = "NVS record";
+
+  StateSlots& slots = stateSlots();
+  size_t record_len = slots.load(recordBuffer, sizeof(recordBuffer));
+  if (record_len > 0) {
+    payload = openStateRecord(recordBuffer, record_len, &payload_len, &version);
+    if (payload != nullptr && unpackState(payload, payload_len, version, true)) {
+      snprintf(source, sizeof(source), "slot %c gen %lu",
+               'A' + slots.activeSlot(), (unsigned long)slots.generation());
+    } else {
+      payload = nullptr;
+    }
   }
-  // idleTimeoutDuration = prefs.getUChar("idleTimeout", IDLE_TIMEOUT_MINUTES);
-    idleTimeoutBattery = prefs.getUChar("idleTimeout", IDLE_TIMEOUT_BATTERY_MINUTES);  // Keep old key for compatibility
-    idleTimeoutUSB = prefs.getUChar("idleTimeUSB", IDLE_TIMEOUT_USB_MINUTES);
-    sleepOnUSB = prefs.getBool("sleepOnUSB", true);
-
-  brightnessLevel = prefs.getUChar("brightness", 4);
-  themeId = prefs.getUChar("theme", 1);
-  screenFlipped = prefs.getBool("screenFlip", false);
-  windupEnabled = prefs.getBool("windupEn", false);
-  // Load alarm settings
-  alarmDuration = prefs.getUChar("alarmDur", DEFAULT_ALARM_DURATION);
-  alarmVibrationEnabled = prefs.getBool("alarmVib", true);
-  alarmFlashEnabled = prefs.getBool("alarmFlash", true);
 
+  if (payload == nullptr) {
+    SettingsStore& store = settingsStore();
+    record_len = store.getBytesLength("state");
+    if (record_len > 0 && record_len <= sizeof(recordBuffer) &&
+        store.getBytes("state", recordBuffer, record_len) == record_len) {
+      payload = openStateRecord(recordBuffer, record_len, &payload_len, &version);
+    }
+    if (payload == nullptr || !unpackState(payload, payload_len, version, true)) {
+      if (record_len > 0) coreLog("State record invalid, falling back to keys\n");
+      loadLegacyState(store);
+      strcpy(source, "legacy keys");
+    }
+    // The NVS copy goes once the slots hold the state
+    if (slots.isMounted()) legacyKeys = true;
+  }
 
+  sanitizeState();
 
+  uint32_t elapsed_us = (uint32_t)(now() - start_us);
 
-  Serial.printf("Loaded: tasks=%d, task=%d, work=%d, short=%d, long=%d, bright=%d, windup=%d\n", 
-                totalTasks, currentTaskId, workDuration, shortBreakDuration, 
+  coreLog("Loaded: tasks=%d, task=%d, work=%d, short=%d, long=%d, bright=%d, windup=%d\n", 
+                tasks.count(), currentTaskId, workDuration, shortBreakDuration, 
                 longBreakDuration, brightnessLevel, windupEnabled);
-
-  Serial.printf("Alarm: dur=%d, vib=%d, flash=%d\n", 
+  coreLog("Alarm: dur=%d, vib=%d, flash=%d\n", 
                 alarmDuration, alarmVibrationEnabled, alarmFlashEnabled);
+  for (uint8_t i = 0; i < tasks.count(); i++) {
+    if (tasks.completed(i) > 0 || tasks.interrupted(i) > 0) {
+      coreLog("Task %d: completed=%d, interrupted=%d\n",
+                    i, tasks.completed(i), tasks.interrupted(i));
+    }
+  }
+  coreLog("Preferences loading complete: %s in %lu us\n", source, (unsigned long)elapsed_us);
+}
 
+void TimerCore::sanitizeState() {
+  if (currentTaskId >= tasks.count()) currentTaskId = tasks.count() - 1;
+  for (uint8_t i = 0; i < (uint8_t)MenuItem::MENU_ITEM_COUNT; i++) {
+    MenuItem item = (MenuItem)i;
+    const MenuDescriptor& d = menuDescriptor(item);
+    if (d.perTask) continue;
+    uint8_t value = getMenuValue(item);
+    uint8_t max = getMenuMax(item);
+    if (value < d.min) (this->*d.set)(d.min);
+    else if (value > max) (this->*d.set)(max);
+  }
+  recountTotals();
+}
 
+// The record is applied to RAM as a whole (unpackState() validates before
+// changing anything) and written back with a single commit
+bool TimerCore::importState(const uint8_t* record, size_t len) {
+  if (state != TimerState::IDLE || menuState != MenuState::CLOSED) {
+    coreLog("Import refused: timer is not idle\n");
+    return false;
+  }
+  size_t payload_len = 0;
+  uint16_t version = 0;
+  const uint8_t* payload = openStateRecord(record, len, &payload_len, &version);
+  if (payload == nullptr || !unpackState(payload, payload_len, version, false)) {
+    coreLog("Import rejected: invalid state record\n");
+    return false;
+  }
+  sanitizeState();
 
-  // Load pomodoro counts
-  for (int i = 0; i < MAX_TASKS; i++) {
-    String compKey = "comp" + String(i);
-    String intKey = "int" + String(i);
-    
-    completedPomodoros[i] = prefs.getUChar(compKey.c_str(), 0);
-    interruptedPomodoros[i] = prefs.getUChar(intKey.c_str(), 0);
-    
-    if (completedPomodoros[i] > 0 || interruptedPomodoros[i] > 0) {
-      Serial.printf("Task %d: completed=%d, interrupted=%d\n",
-                    i, completedPomodoros[i], interruptedPomodoros[i]);
-    }
+  for (uint8_t i = 0; i < (uint8_t)MenuItem::MENU_ITEM_COUNT; i++) {
+    notify(ChangeType::SETTINGS, i);
   }
-  
-  prefs.end();
-  Serial.println("Preferences loading complete");
+  notify(ChangeType::TASK);
+  notify(ChangeType::STATS);
+  markDirty(DIRTY_SETTINGS | DIRTY_TASKS | DIRTY_STATS);
+  commitState();
+  coreLog("Imported state record v%d: %u tasks\n", version, tasks.count());
+  return true;
 }
 
-extern void suspend_encoder_interrupts();
-extern void resume_encoder_interrupts();
+// Version 0: one NVS key per setting and per task counter
+void TimerCore::loadLegacyState(SettingsStore& store) {
+  currentTaskId = store.getUChar("currentTask", 0);
+  workDuration = store.getUChar("workDuration", WORK_DURATION);
+  shortBreakDuration = store.getUChar("shortBreak", SHORT_BREAK_DURATION);
+  longBreakDuration = store.getUChar("longBreak", LONG_BREAK_DURATION);
+  pomodorosBeforeLongBreak = store.getUChar("pomosB4Long", POMODOROS_BEFORE_LONG_BREAK);
+  pomodorosSinceLastLongBreak = store.getUChar("pomosSince", 0);
+  idleTimeoutBattery = store.getUChar("idleTimeout", IDLE_TIMEOUT_BATTERY_MINUTES);
+  idleTimeoutUSB = store.getUChar("idleTimeUSB", IDLE_TIMEOUT_USB_MINUTES);
+  sleepOnUSB = store.getBool("sleepOnUSB", true);
+  brightnessLevel = store.getUChar("brightness", 4);
+  themeId = store.getUChar("theme", 1);
+  screenFlipped = store.getBool("screenFlip", false);
+  windupEnabled = store.getBool("windupEn", false);
+  alarmDuration = store.getUChar("alarmDur", DEFAULT_ALARM_DURATION);
+  alarmVibrationEnabled = store.getBool("alarmVib", true);
+  alarmFlashEnabled = store.getBool("alarmFlash", true);
+
+  // Task counters: a TaskStore blob, or the older per-task keys
+  static uint8_t task_record[TaskStore::MAX_RECORD_SIZE];
+  size_t task_len = store.getBytesLength("tasks");
+  if (!(task_len > 0 && task_len <= sizeof(task_record) &&
+        store.getBytes("tasks", task_record, task_len) == task_len &&
+        tasks.restore(task_record, task_len))) {
+    tasks.clear();
+    tasks.setCount(store.getUChar("totalTasks", 1));
+    for (uint8_t i = 0; i < LEGACY_TASK_SLOTS; i++) {
+      tasks.setCompleted(i, store.getUChar(LEGACY_COMPLETED_KEYS[i], 0));
+      tasks.setInterrupted(i, store.getUChar(LEGACY_INTERRUPTED_KEYS[i], 0));
+    }
+  }
 
-void TimerCore::saveState() {
-   Serial.println("Saving state to Preferences...");
-   
-   suspend_encoder_interrupts();
-   Preferences prefs;
-   prefs.begin("pomodoro", false);
-   
-   prefs.putUChar("totalTasks", totalTasks);
-   prefs.putUChar("currentTask", currentTaskId);
-   prefs.putUChar("workDuration", workDuration);
-   prefs.putUChar("shortBreak", shortBreakDuration);
-   prefs.putUChar("longBreak", longBreakDuration);
-   prefs.putUChar("pomosB4Long", pomodorosBeforeLongBreak);
-   prefs.putUChar("pomosSince", pomodorosSinceLastLongBreak);
-   // prefs.putUChar("idleTimeout", idleTimeoutDuration);
-    prefs.putUChar("idleTimeout", idleTimeoutBattery);  // Keep old key name
-    prefs.putUChar("idleTimeUSB", idleTimeoutUSB);
-    prefs.putBool("sleepOnUSB", sleepOnUSB);   
-   prefs.putUChar("brightness", brightnessLevel);
-   prefs.putUChar("theme", themeId);
-   prefs.putBool("screenFlip", screenFlipped);
-   prefs.putBool("windupEn", windupEnabled);  
-   // NEW: Save alarm settings
-   prefs.putUChar("alarmDur", alarmDuration);
-   prefs.putBool("alarmVib", alarmVibrationEnabled);
-   prefs.putBool("alarmFlash", alarmFlashEnabled);
-   
+  SessionStats::Snapshot snapshot;
+  if (store.getBytesLength("stats") == sizeof(snapshot) &&
+      store.getBytes("stats", &snapshot, sizeof(snapshot)) == sizeof(snapshot)) {
+    stats.restore(snapshot);
+  }
 
-    
-    Serial.printf("Saving: idle battery=%d, idle USB=%d, sleep on USB=%d\n",
-                  idleTimeoutBattery, idleTimeoutUSB, sleepOnUSB);
+  legacyKeys = store.isKey("workDuration") || store.isKey("tasks");
+  if (legacyKeys) coreLog("Migrating per-key settings to a single state record\n");
+}
 
-   Serial.printf("Saving: work=%d, short=%d, long=%d, pomodoros=%d, brightness=%d\n",
-                workDuration, shortBreakDuration, longBreakDuration, 
-                pomodorosBeforeLongBreak, brightnessLevel);
-   Serial.printf("Alarm: dur=%d, vib=%d, flash=%d\n", 
-                alarmDuration, alarmVibrationEnabled, alarmFlashEnabled);
-   
-   // Save pomodoro counts
-   for (int i = 0; i < MAX_TASKS; i++) {
-      String compKey = "comp" + String(i);
-      String intKey = "int" + String(i);
-      
-      prefs.putUChar(compKey.c_str(), completedPomodoros[i]);
-      prefs.putUChar(intKey.c_str(), interruptedPomodoros[i]);
+size_t TimerCore::packState(uint8_t* payload, size_t len) const {
+  StateSettings settings;
+  settings.currentTask = currentTaskId;
+  settings.workDuration = workDuration;
+  settings.shortBreak = shortBreakDuration;
+  settings.longBreak = longBreakDuration;
+  settings.pomosBeforeLong = pomodorosBeforeLongBreak;
+  settings.pomosSince = pomodorosSinceLastLongBreak;
+  settings.idleTimeoutBattery = idleTimeoutBattery;
+  settings.idleTimeoutUSB = idleTimeoutUSB;
+  settings.sleepOnUSB = sleepOnUSB;
+  settings.brightness = brightnessLevel;
+  settings.theme = themeId;
+  settings.screenFlipped = screenFlipped;
+  settings.windupEnabled = windupEnabled;
+  settings.alarmDuration = alarmDuration;
+  settings.alarmVibration = alarmVibrationEnabled;
+  settings.alarmFlash = alarmFlashEnabled;
+
+  SessionStats::Snapshot snapshot;
+  stats.save(snapshot);
+  FlashTelemetry::Snapshot telemetry;
+  flashTelemetry().save(telemetry);
+
+  if (len < sizeof(settings) + sizeof(snapshot) + sizeof(telemetry)) return 0;
+  memcpy(payload, &settings, sizeof(settings));
+  memcpy(payload + sizeof(settings), &snapshot, sizeof(snapshot));
+  memcpy(payload + sizeof(settings) + sizeof(snapshot), &telemetry, sizeof(telemetry));
+  size_t used = sizeof(settings) + sizeof(snapshot) + sizeof(telemetry);
+  size_t task_len = tasks.save(payload + used, len - used);
+  return task_len ? used + task_len : 0;
+}
+
+bool TimerCore::unpackState(const uint8_t* payload, size_t len, uint16_t version,
+                            bool withTelemetry) {
+  if (version != 1 && version != STATE_VERSION) {
+    coreLog("Unknown state record version %d\n", version);
+    return false;
   }
-  
-   prefs.end();
-   resume_encoder_interrupts();
-   Serial.println("Preferences save complete");
+  size_t telemetry_len = (version >= 2) ? sizeof(FlashTelemetry::Snapshot) : 0;
+  if (len < STATE_PAYLOAD_MIN + telemetry_len) return false;
+
+  StateSettings settings;
+  SessionStats::Snapshot snapshot;
+  FlashTelemetry::Snapshot telemetry;
+  memcpy(&settings, payload, sizeof(settings));
+  memcpy(&snapshot, payload + sizeof(settings), sizeof(snapshot));
+  size_t used = sizeof(settings) + sizeof(snapshot);
+  if (telemetry_len) memcpy(&telemetry, payload + used, telemetry_len);
+  used += telemetry_len;
+  if (!tasks.restore(payload + used, len - used)) return false;
+  // Lifetime flash counters belong to this device, never to an import
+  if (telemetry_len && withTelemetry) flashTelemetry().restore(telemetry);
+
+  currentTaskId = settings.currentTask;
+  workDuration = settings.workDuration;
+  shortBreakDuration = settings.shortBreak;
+  longBreakDuration = settings.longBreak;
+  pomodorosBeforeLongBreak = settings.pomosBeforeLong;
+  pomodorosSinceLastLongBreak = settings.pomosSince;
+  idleTimeoutBattery = settings.idleTimeoutBattery;
+  idleTimeoutUSB = settings.idleTimeoutUSB;
+  sleepOnUSB = settings.sleepOnUSB != 0;
+  brightnessLevel = settings.brightness;
+  themeId = settings.theme;
+  screenFlipped = settings.screenFlipped != 0;
+  windupEnabled = settings.windupEnabled != 0;
+  alarmDuration = settings.alarmDuration;
+  alarmVibrationEnabled = settings.alarmVibration != 0;
+  alarmFlashEnabled = settings.alarmFlash != 0;
+  stats.restore(snapshot);
+  legacyKeys = false;
+  return true;
+}
+
+// Changes are collected and written together: every modification marks
+// what it touched and restarts the quiet period, update() writes the
+// record once SAVE_QUIET_MS pass without another change.
+void TimerCore::markDirty(uint8_t fields) {
+   dirtyFields |= fields;
+   dirtySince = now();
+}
+
+void TimerCore::commitState() {
+   if (dirtyFields == 0) return;
+   coreLog("Committing state (dirty:%s%s%s)\n",
+                 (dirtyFields & DIRTY_SETTINGS) ? " settings" : "",
+                 (dirtyFields & DIRTY_TASKS) ? " tasks" : "",
+                 (dirtyFields & DIRTY_STATS) ? " stats" : "");
+   saveState();
+}
+
+bool TimerCore::flushState() {
+   commitState();
+   // Deep sleep follows; make sure every queued record reached flash
+   if (!stateWriter().flush(STATE_FLUSH_TIMEOUT_MS)) {
+      coreLog("State write failed or still pending at flush timeout\n");
+      return false;
+   }
+   return true;
+}
+
+// The snapshot is the same record that was just flushed, so the next
+// wake can skip reading it back from flash
+void TimerCore::suspend() {
+   bool saved = flushState();
+   if (journal != nullptr && journal->isMounted()) {
+      storeRtcHistory(history, journal->nextSequence());
+   }
+   size_t record_len = sealState(recordBuffer, sizeof(recordBuffer));
+   if (record_len == 0) return;
+   storeRtcSnapshot(recordBuffer, record_len, !saved);
+   coreLog("RTC snapshot stored: %u bytes\n", (unsigned)record_len);
+}
+
+size_t TimerCore::sealState(uint8_t* record, size_t len) const {
+   if (len < sizeof(StateHeader)) return 0;
+   size_t payload_len = packState(record + sizeof(StateHeader), len - sizeof(StateHeader));
+   return payload_len ? sealStateRecord(record, payload_len) : 0;
+}
+
+// Packing runs on the caller; the flash write happens on the writer task
+void TimerCore::saveState() {
+   dirtyFields = 0;
+   size_t record_len = sealState(recordBuffer, sizeof(recordBuffer));
+   if (record_len == 0) {
+      coreLog("State record does not fit, not saved\n");
+      return;
+   }
+
+   uint64_t start_us = now();
+   uint32_t seq = stateWriter().submit(recordBuffer, record_len, legacyKeys);
+   legacyKeys = false;
+   coreLog("State #%lu queued: %u bytes in %lu us\n", (unsigned long)seq,
+                 (unsigned)record_len, (unsigned long)(now() - start_us));
 }
 
 void TimerCore::resetSaveState() {
-  totalTasks = 1;
   currentTaskId = 0;
   completedSessions = 0;
   pomodorosSinceLastLongBreak = 0;
-  
-  for (int i = 0; i < MAX_TASKS; i++) {
-    completedPomodoros[i] = 0;
-    interruptedPomodoros[i] = 0;
+  tasks.clear();
+  stats.reset();
+
+  notify(ChangeType::TASK);
+  notify(ChangeType::STATS);
+  markDirty(DIRTY_SETTINGS | DIRTY_TASKS | DIRTY_STATS);
+}
+
+// ---------------------------------------------------------------------------
+// State machine
+// ---------------------------------------------------------------------------
+
+static_assert((uint8_t)MenuItem::MENU_ITEM_COUNT <= 32,
+              "ChangeSet tracks settings in a 32-bit mask");
+
+namespace {
+
+struct TimerTransition {
+  bool legal;
+  TimerState target;
+};
+
+constexpr TimerTransition ILLEGAL = { false, TimerState::IDLE };
+constexpr TimerTransition TO_IDLE = { true, TimerState::IDLE };
+constexpr TimerTransition TO_WORK = { true, TimerState::WORK };
+constexpr TimerTransition TO_WIND_UP = { true, TimerState::WIND_UP };
+constexpr TimerTransition TO_STARTING = { true, TimerState::STARTING };
+constexpr TimerTransition TO_SHORT_BREAK = { true, TimerState::SHORT_BREAK };
+constexpr TimerTransition TO_LONG_BREAK = { true, TimerState::LONG_BREAK };
+constexpr TimerTransition TO_PAUSED_WORK = { true, TimerState::PAUSED_WORK };
+constexpr TimerTransition TO_PAUSED_SHORT = { true, TimerState::PAUSED_SHORT_BREAK };
+constexpr TimerTransition TO_PAUSED_LONG = { true, TimerState::PAUSED_LONG_BREAK };
+constexpr TimerTransition TO_ALERT = { true, TimerState::ALERT };
+
+// Rows follow TimerState order, columns follow TimerEvent order:
+//   START_WORK, START_WINDUP, CONFIRM_WINDUP, CANCEL_WINDUP, START_DELAY_DONE,
+//   PAUSE, RESUME, INTERRUPT, TIME_UP, START_SHORT_BREAK, START_LONG_BREAK,
+//   ALERT_DONE, RESET, NONE
+constexpr TimerTransition TRANSITIONS[TIMER_STATE_COUNT][TIMER_EVENT_COUNT] = {
+  // IDLE
+  { TO_WORK, TO_WIND_UP, ILLEGAL, ILLEGAL, ILLEGAL,
+    ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL,
+    ILLEGAL, TO_IDLE, ILLEGAL },
+  // WORK
+  { ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL,
+    TO_PAUSED_WORK, ILLEGAL, TO_IDLE, TO_ALERT, ILLEGAL, ILLEGAL,
+    ILLEGAL, TO_IDLE, ILLEGAL },
+  // WIND_UP
+  { ILLEGAL, ILLEGAL, TO_STARTING, TO_IDLE, ILLEGAL,
+    ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL,
+    ILLEGAL, TO_IDLE, ILLEGAL },
+  // STARTING
+  { ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, TO_WORK,
+    ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL,
+    ILLEGAL, TO_IDLE, ILLEGAL },
+  // SHORT_BREAK
+  { ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL,
+    TO_PAUSED_SHORT, ILLEGAL, ILLEGAL, TO_ALERT, ILLEGAL, ILLEGAL,
+    ILLEGAL, TO_IDLE, ILLEGAL },
+  // LONG_BREAK
+  { ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL,
+    TO_PAUSED_LONG, ILLEGAL, ILLEGAL, TO_ALERT, ILLEGAL, ILLEGAL,
+    ILLEGAL, TO_IDLE, ILLEGAL },
+  // PAUSED_WORK
+  { ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL,
+    ILLEGAL, TO_WORK, TO_IDLE, ILLEGAL, ILLEGAL, ILLEGAL,
+    ILLEGAL, TO_IDLE, ILLEGAL },
+  // PAUSED_SHORT_BREAK
+  { ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL,
+    ILLEGAL, TO_SHORT_BREAK, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL,
+    ILLEGAL, TO_IDLE, ILLEGAL },
+  // PAUSED_LONG_BREAK
+  { ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL,
+    ILLEGAL, TO_LONG_BREAK, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL,
+    ILLEGAL, TO_IDLE, ILLEGAL },
+  // ALERT
+  { ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL,
+    ILLEGAL, ILLEGAL, ILLEGAL, ILLEGAL, TO_SHORT_BREAK, TO_LONG_BREAK,
+    TO_IDLE, TO_IDLE, ILLEGAL },
+};
+
+constexpr TimerTransition transitionFor(uint8_t s, uint8_t e) {
+  return TRANSITIONS[s][e];
+}
+
+constexpr bool isRunning(TimerState s) {
+  return s == TimerState::WORK || s == TimerState::SHORT_BREAK ||
+         s == TimerState::LONG_BREAK;
+}
+
+constexpr bool isPaused(TimerState s) {
+  return s == TimerState::PAUSED_WORK || s == TimerState::PAUSED_SHORT_BREAK ||
+         s == TimerState::PAUSED_LONG_BREAK;
+}
+
+// Compile-time checks over every (state, event) pair. C++11 constexpr only
+// allows a single return, hence the recursion over rows and columns.
+constexpr bool pairOk(uint8_t s, uint8_t e) {
+  return
+    // RESET always returns to IDLE
+    (e != (uint8_t)TimerEvent::RESET ||
+      (transitionFor(s, e).legal && transitionFor(s, e).target == TimerState::IDLE)) &&
+    // NONE is never legal
+    (e != (uint8_t)TimerEvent::NONE || !transitionFor(s, e).legal) &&
+    // ALERT is only entered from a running session via TIME_UP
+    (!transitionFor(s, e).legal || transitionFor(s, e).target != TimerState::ALERT ||
+      (e == (uint8_t)TimerEvent::TIME_UP && isRunning((TimerState)s))) &&
+    // Paused states are only entered from a running session via PAUSE
+    (!transitionFor(s, e).legal || !isPaused(transitionFor(s, e).target) ||
+      (e == (uint8_t)TimerEvent::PAUSE && isRunning((TimerState)s))) &&
+    // RESUME only ever leads back to a running session
+    (e != (uint8_t)TimerEvent::RESUME || !transitionFor(s, e).legal ||
+      isRunning(transitionFor(s, e).target));
+}
+
+constexpr bool rowOk(uint8_t s, uint8_t e) {
+  return e >= TIMER_EVENT_COUNT || (pairOk(s, e) && rowOk(s, e + 1));
+}
+
+constexpr bool tableOk(uint8_t s) {
+  return s >= TIMER_STATE_COUNT || (rowOk(s, 0) && tableOk(s + 1));
+}
+
+static_assert((uint8_t)TimerState::ALERT + 1 == TIMER_STATE_COUNT,
+              "TIMER_STATE_COUNT out of sync with TimerState");
+static_assert((uint8_t)TimerEvent::NONE + 1 == TIMER_EVENT_COUNT,
+              "TIMER_EVENT_COUNT out of sync with TimerEvent");
+static_assert(tableOk(0), "Timer transition table violates a state machine invariant");
+static_assert(transitionFor((uint8_t)TimerState::IDLE, (uint8_t)TimerEvent::START_WORK).target == TimerState::WORK,
+              "IDLE + START_WORK must start a work session");
+static_assert(transitionFor((uint8_t)TimerState::STARTING, (uint8_t)TimerEvent::START_DELAY_DONE).target == TimerState::WORK,
+              "STARTING + START_DELAY_DONE must start a work session");
+
+} // namespace
+
+const TimerCore::TransitionAction TimerCore::TRANSITION_ACTIONS[TIMER_EVENT_COUNT] = {
+  &TimerCore::onStartWork,
+  &TimerCore::onStartWindup,
+  &TimerCore::onConfirmWindup,
+  &TimerCore::onCancelWindup,
+  &TimerCore::onStartDelayDone,
+  &TimerCore::onPause,
+  &TimerCore::onResume,
+  &TimerCore::onInterrupt,
+  &TimerCore::onTimeUp,
+  &TimerCore::onStartShortBreak,
+  &TimerCore::onStartLongBreak,
+  &TimerCore::onAlertDone,
+  &TimerCore::onReset,
+  &TimerCore::onNone,
+};
+
+bool TimerCore::canDispatch(TimerState state, TimerEvent event) {
+  if ((uint8_t)state >= TIMER_STATE_COUNT || (uint8_t)event >= TIMER_EVENT_COUNT) return false;
+  return TRANSITIONS[(uint8_t)state][(uint8_t)event].legal;
+}
+
+bool TimerCore::dispatch(TimerEvent event) {
+  if (!canDispatch(state, event)) return false;
+
+  TimerState from = state;
+  state = TRANSITIONS[(uint8_t)from][(uint8_t)event].target;
+  // Leaving ALERT by any route ends the alert
+  if (from == TimerState::ALERT) alertActive = false;
+  (this->*TRANSITION_ACTIONS[(uint8_t)event])(from);
+  notify(ChangeType::STATE);
+  return true;
+}
+
+void TimerCore::onStartWork(TimerState) {
+  duration = workDuration * 60;
+  remainingTime = duration;
+  startTime = now();
+  beginSession();
+  coreLog("Starting work session - Task %d\n", currentTaskId);
+}
+
+void TimerCore::onStartWindup(TimerState) {
+  windupValue = 0;
+  coreLog("Wind-up started - windupValue reset to 0\n");
+}
+
+void TimerCore::onConfirmWindup(TimerState) {
+  // Start work with the wound-up duration
+  duration = windupValue;
+  remainingTime = duration;
+  startTime = 0;
+  windupStartTime = now();
+  windupValue = 0;  // Reset for next time
+  coreLog("Work started from wind-up - Duration: %lu seconds\n", (unsigned long)duration);
+}
+
+void TimerCore::onCancelWindup(TimerState) {
+  windupValue = 0;
+  coreLog("Wind-up cancelled\n");
+}
+
+void TimerCore::onStartDelayDone(TimerState) {
+  startTime = now();
+  beginSession();
+}
+
+void TimerCore::onPause(TimerState) {
+  pausedTime = now();
+}
+
+void TimerCore::onResume(TimerState) {
+  uint64_t paused = now() - pausedTime;
+  startTime += paused;
+  sessionPausedUs += paused;
+}
+
+void TimerCore::onInterrupt(TimerState from) {
+  recordSession(from, SessionOutcome::INTERRUPTED);
+  tasks.addInterrupted(currentTaskId);
+  stats.addInterrupted();
+  notify(ChangeType::STATS);
+  markDirty(DIRTY_TASKS | DIRTY_STATS);
+  remainingTime = 0;
+}
+
+// A finished pomodoro is counted here, together with its history record,
+// so a RESET during the alert cannot leave one without the other
+void TimerCore::onTimeUp(TimerState from) {
+  coreLog("ALERT STARTED\n");
+  recordSession(from, SessionOutcome::COMPLETED);
+  if (from == TimerState::WORK && currentTaskId < MAX_TASKS) {
+    tasks.addCompleted(currentTaskId);
+    completedSessions++;
+    stats.addCompleted();
+    pomodorosSinceLastLongBreak++;
+    notify(ChangeType::STATS);
+    markDirty(DIRTY_SETTINGS | DIRTY_TASKS | DIRTY_STATS);
+  }
+  previousState = from;
+  remainingTime = 0;
+  alertStartTime = now();
+  alertActive = true;
+  blinkCount = 0;
+}
+
+void TimerCore::onStartShortBreak(TimerState) {
+  duration = shortBreakDuration * 60;
+  remainingTime = duration;
+  startTime = now();
+  beginSession();
+  coreLog("Starting short break\n");
+}
+
+void TimerCore::onStartLongBreak(TimerState) {
+  duration = longBreakDuration * 60;
+  remainingTime = duration;
+  startTime = now();
+  beginSession();
+  pomodorosSinceLastLongBreak = 0;
+  markDirty(DIRTY_SETTINGS);
+  coreLog("Starting LONG break\n");
+}
+
+void TimerCore::onAlertDone(TimerState) {
+  remainingTime = 0;
+}
+
+void TimerCore::onReset(TimerState from) {
+  recordSession(from, SessionOutcome::RESET);
+  remainingTime = 0;
+  startTime = 0;
+  pausedTime = 0;
+  windupValue = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Session history
+// ---------------------------------------------------------------------------
+
+void TimerCore::beginSession() {
+  sessionStartEpoch = clock->epochSeconds();
+  sessionPausedUs = 0;
+}
+
+void TimerCore::attachJournal(SessionJournal* journal) {
+  this->journal = journal;
+  if (journal == nullptr || !journal->isMounted()) return;
+
+  // Statistics are persisted on their own; only the ring is rebuilt,
+  // from the RTC copy when the journal has not moved since suspend()
+  uint64_t start_us = now();
+  if (takeRtcHistory(history, journal->nextSequence())) {
+    coreLog("Session history: %u records resumed from RTC memory in %lu us\n",
+                  history.size(), (unsigned long)(now() - start_us));
+    return;
+  }
+  uint32_t n = journal->count();
+  if (n > SessionHistory::CAPACITY) n = SessionHistory::CAPACITY;
+  history.clear();
+  for (uint32_t back = n; back-- > 0;) {
+    SessionRecord record;
+    if (journal->readNewest(back, record)) history.append(record);
+  }
+  coreLog("Session history: %u of %lu journal entries loaded\n",
+                history.size(), (unsigned long)journal->count());
+}
+
+// Append the session that `from` was running; no-op for states without one
+void TimerCore::recordSession(TimerState from, SessionOutcome outcome) {
+  SessionKind kind;
+  uint64_t end = now();
+  switch (from) {
+    case TimerState::WORK:               kind = SessionKind::WORK; break;
+    case TimerState::SHORT_BREAK:        kind = SessionKind::SHORT_BREAK; break;
+    case TimerState::LONG_BREAK:         kind = SessionKind::LONG_BREAK; break;
+    case TimerState::PAUSED_WORK:        kind = SessionKind::WORK; end = pausedTime; break;
+    case TimerState::PAUSED_SHORT_BREAK: kind = SessionKind::SHORT_BREAK; end = pausedTime; break;
+    case TimerState::PAUSED_LONG_BREAK:  kind = SessionKind::LONG_BREAK; end = pausedTime; break;
+    default: return;
   }
 
-  saveState();
+  uint64_t ran_s = (end - startTime) / 1000000ULL;
+  if (ran_s > duration) ran_s = duration;
+  uint64_t paused_s = (sessionPausedUs + (now() - end)) / 1000000ULL;
+
+  SessionRecord record;
+  record.startEpoch = sessionStartEpoch;
+  record.durationSec = (ran_s > 0xFFFF) ? 0xFFFF : (uint16_t)ran_s;
+  record.pausedSec = (paused_s > 0xFFFF) ? 0xFFFF : (uint16_t)paused_s;
+  record.taskId = currentTaskId;
+  record.kind = kind;
+  record.outcome = outcome;
+  record.reserved = 0;
+  history.append(record);
+  if (journal != nullptr) {
+    uint32_t erases = journal->stats().inlineErases;
+    uint64_t start_us = now();
+    bool ok = journal->append(record);
+    flashTelemetry().record(FlashTarget::JOURNAL, SessionJournal::ENTRY_SIZE,
+                            journal->stats().inlineErases - erases, (uint32_t)(now() - start_us));
+    if (!ok) coreLog("Session journal append failed\n");
+  }
+  stats.record(record);
+  notify(ChangeType::STATS);
+
+  coreLog("Session recorded: kind %d, outcome %d, task %d, %us run, %us paused\n",
+                (int)kind, (int)outcome, currentTaskId + 1,
+                record.durationSec, record.pausedSec);
 }
 
+// Completed / interrupted totals over the active tasks. TaskStore keeps
+// the sums current, so this is a copy rather than a rescan.
+void TimerCore::recountTotals() {
+  stats.setTotals(tasks.totalCompleted(), tasks.totalInterrupted());
+}
+
+// The finished pomodoro was already counted by onTimeUp()
 void TimerCore::startBreak() {
-  pomodorosSinceLastLongBreak++;
   if (pomodorosSinceLastLongBreak >= pomodorosBeforeLongBreak) {
-    duration = longBreakDuration * 60;
-    state = TimerState::LONG_BREAK;
-    pomodorosSinceLastLongBreak = 0;
-    Serial.println("Starting LONG break");
+    dispatch(TimerEvent::START_LONG_BREAK);
   } else {
-    duration = shortBreakDuration * 60;
-    state = TimerState::SHORT_BREAK;
-    Serial.println("Starting short break");
+    dispatch(TimerEvent::START_SHORT_BREAK);
   }
-  remainingTime = duration;
-  startTime = millis();
 }
 
 void TimerCore::startWork() {
-  duration = workDuration * 60;
-  remainingTime = duration;
-  startTime = millis();
-  state = TimerState::WORK;
-  Serial.printf("Starting work session - Task %d\n", currentTaskId);
+  dispatch(TimerEvent::START_WORK);
 }
 
 void TimerCore::pause() {
-  if (state == TimerState::WORK) {
-    pausedTime = millis();
-    state = TimerState::PAUSED_WORK;
-  } else if (state == TimerState::SHORT_BREAK) {
-    pausedTime = millis();
-    state = TimerState::PAUSED_SHORT_BREAK;
-  } else if (state == TimerState::LONG_BREAK) {
-    pausedTime = millis();
-    state = TimerState::PAUSED_LONG_BREAK;
-  }
+  dispatch(TimerEvent::PAUSE);
 }
 
 void TimerCore::resume() {
-  if (state == TimerState::PAUSED_WORK) {
-    startTime += (millis() - pausedTime);
-    state = TimerState::WORK;
-  } else if (state == TimerState::PAUSED_SHORT_BREAK) {
-    startTime += (millis() - pausedTime);
-    state = TimerState::SHORT_BREAK;
-  } else if (state == TimerState::PAUSED_LONG_BREAK) {
-    startTime += (millis() - pausedTime);
-    state = TimerState::LONG_BREAK;
-  }
+  dispatch(TimerEvent::RESUME);
 }
 
 void TimerCore::interrupt() {
-  if (state == TimerState::WORK || state == TimerState::PAUSED_WORK) {
-    interruptedPomodoros[currentTaskId]++;
-    saveState();
-    state = TimerState::IDLE;
-    remainingTime = 0;
-  }
+  dispatch(TimerEvent::INTERRUPT);
 }
 
 void TimerCore::reset() {
-  state = TimerState::IDLE;
-  remainingTime = 0;
-  startTime = 0;
-  pausedTime = 0;
+  dispatch(TimerEvent::RESET);
 }
 
 void TimerCore::resetTaskStats() {
   completedSessions = 0;
-  for (int i = 0; i < MAX_TASKS; i++) {
-    completedPomodoros[i] = 0;
-    interruptedPomodoros[i] = 0;
-  }
+  tasks.clearCounters();
+  stats.reset();
+  notify(ChangeType::STATS);
+  markDirty(DIRTY_SETTINGS | DIRTY_TASKS | DIRTY_STATS);
 }
 
 void TimerCore::addTask() {
-  if (totalTasks < MAX_TASKS) {
-    totalTasks++;
-    currentTaskId = totalTasks - 1;
-    saveState();
+  if (tasks.count() < MAX_TASKS) {
+    tasks.setCount(tasks.count() + 1);
+    currentTaskId = tasks.count() - 1;
+    recountTotals();
+    notify(ChangeType::TASK);
+    markDirty(DIRTY_SETTINGS | DIRTY_TASKS);
   }
 }
 
 void TimerCore::selectTask(uint8_t taskId) {
-  if (taskId < totalTasks) {
+  if (taskId < tasks.count() && taskId != currentTaskId) {
     currentTaskId = taskId;
+    notify(ChangeType::TASK);
   }
 }
 
 void TimerCore::startAlert() {
-    Serial.println("ALERT STARTED");
-    
-    previousState = state;
-    state = TimerState::ALERT;
-    alertStartTime = millis();
-    alertActive = true;
-    blinkCount = 0;
-    
-    Serial.println("Alert state initialized");
+    dispatch(TimerEvent::TIME_UP);
 }
 
 void TimerCore::updateAlert() {
     if (!alertActive) return;
 
-    uint32_t elapsed = millis() - alertStartTime;
+    uint32_t elapsed = (uint32_t)((now() - alertStartTime) / 1000ULL);
     
     // Use the configurable alarm duration (convert seconds to milliseconds)
     uint32_t alert_duration = alarmDuration * 1000;
     
     // Update blink state
-    uint32_t blink_interval = 400;
-    blinkCount = (elapsed / blink_interval) % 2;
+    uint32_t blink_interval = ALERT_BLINK_INTERVAL_MS;
+    uint8_t blink = (elapsed / blink_interval) % 2;
+    if (blink != blinkCount) notify(ChangeType::SECOND);
+    blinkCount = blink;
     
     if (elapsed >= alert_duration) {
-        alertActive = false;
-        Serial.println("Alert finished - processing completion");
+        coreLog("Alert finished\n");
 
         if (previousState == TimerState::WORK) {
-            // Update stats
-            if (currentTaskId < MAX_TASKS) {
-                completedPomodoros[currentTaskId]++;
-                completedSessions++;
-            }
-
-            // Start appropriate break
             startBreak();
-            saveState();
         } else {
-            state = TimerState::IDLE;
-            remainingTime = 0;
+            dispatch(TimerEvent::ALERT_DONE);
         }
-        
-        // if (previousState == TimerState::WORK) {
-        //     if (currentTaskId < MAX_TASKS) {
-        //         completedPomodoros[currentTaskId]++;
-        //         completedSessions++;
-        //         Serial.printf("Work completed - Task %d: %d pomodoros, Total sessions: %d\n",
-        //                     currentTaskId, completedPomodoros[currentTaskId], completedSessions);
-        //     }
-            
-        //     Serial.println("Saving state...");
-        //     saveState();
-        //     Serial.println("State saved");
-            
-        //     pomodorosSinceLastLongBreak++;
-        //     if (pomodorosSinceLastLongBreak >= pomodorosBeforeLongBreak) {
-        //         duration = longBreakDuration * 60;
-        //         state = TimerState::LONG_BREAK;
-        //         pomodorosSinceLastLongBreak = 0;
-        //         Serial.println("Starting LONG break");
-        //     } else {
-        //         duration = shortBreakDuration * 60;
-        //         state = TimerState::SHORT_BREAK;
-        //         Serial.println("Starting short break");
-        //     }
-        //     remainingTime = duration;
-        //     startTime = millis();
-            
-        // } else {
-        //     state = TimerState::IDLE;
-        //     remainingTime = 0;
-        //     Serial.println("Break finished - returning to IDLE");
-        // }
-        return;
     }
 }
 
 void TimerCore::update() {
+    // Deferred save once settings have been left alone for a moment
+    if (dirtyFields != 0 && now() - dirtySince >= SAVE_QUIET_MS * 1000ULL) {
+        commitState();
+    }
+
     if (alertActive) {
         updateAlert();
         return;
     }
 
+    if (state == TimerState::IDLE) {
+        // The idle label counts whole minutes
+        uint32_t idleMinutes = getIdleElapsedMs() / 60000UL;
+        if (idleMinutes != lastIdleMinutes) notify(ChangeType::SECOND);
+        lastIdleMinutes = idleMinutes;
+        return;
+    }
+
     if (state == TimerState::STARTING) {
-        if (millis() - windupStartTime >= WINDUP_START_DELAY_MS) {
-            startTime = millis();
-            state = TimerState::WORK;
+        if (now() - windupStartTime >= WINDUP_START_DELAY_MS * 1000ULL) {
+            dispatch(TimerEvent::START_DELAY_DONE);
         }
         return;
     }
@@ -869,23 +1314,18 @@ void TimerCore::update() {
         state == TimerState::SHORT_BREAK || 
         state == TimerState::LONG_BREAK) {
         
-        uint32_t currentTime = millis();
-        uint32_t elapsed_ms;
-        
-        if (currentTime >= startTime) {
-            elapsed_ms = currentTime - startTime;
-        } else {
-            elapsed_ms = (0xFFFFFFFF - startTime) + currentTime + 1;
-        }
+        // 64-bit microsecond clock never wraps
+        uint32_t elapsed_ms = (uint32_t)((now() - startTime) / 1000ULL);
         
         uint32_t elapsed_seconds = elapsed_ms / 1000;
         uint32_t duration_ms = duration * 1000UL;
         
         if (elapsed_ms >= duration_ms || elapsed_seconds >= duration) {
-            remainingTime = 0;
             startAlert();
         } else {
-            remainingTime = (elapsed_seconds < duration) ? (duration - elapsed_seconds) : 0;
+            uint32_t remaining = (elapsed_seconds < duration) ? (duration - elapsed_seconds) : 0;
+            if (remaining != remainingTime) notify(ChangeType::SECOND);
+            remainingTime = remaining;
         }
     }
 }
@@ -1,7 +1,19 @@
 #pragma once
 #ifndef TIMER_CORE_H
 #define TIMER_CORE_H
-#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "timer_clock.h"
+#include "change_queue.h"
+#include "session_history.h"
+#include "session_stats.h"
+#include "task_store.h"
+#include "state_record.h"
+#include "state_slots.h"
+#include "state_writer.h"
+
+class SettingsStore;
+class SessionJournal;
 
 // Timing constants
 const uint8_t WORK_DURATION = 25;  // in minutes
@@ -16,10 +28,21 @@ const uint8_t IDLE_TIMEOUT_USB_MINUTES = 30;     // Longer timeout on USB
 // Alert configurations (defaults)
 const uint8_t DEFAULT_ALARM_DURATION = 2;  // in seconds
 const uint8_t ALERT_BLINK_COUNT = 5;       // Number of times to blink
+const uint16_t ALERT_BLINK_INTERVAL_MS = 400;
 const uint16_t WINDUP_START_DELAY_MS = 2500;
 
+// Quiet period after the last change before the state record is written
+const uint16_t SAVE_QUIET_MS = 2000;
+const uint32_t STATE_FLUSH_TIMEOUT_MS = 1000;  // flushState() wait for the writer task
+
+// Returned by nextDeadline() when nothing changes until the next input
+const uint64_t TIMER_NO_DEADLINE = UINT64_MAX;
+
+// Fixed-point progress: 0 = session start, PROGRESS_Q16_ONE = session end
+const uint32_t PROGRESS_Q16_ONE = 1UL << 16;
+
 // Task management constants
-const uint8_t MAX_TASKS = 12;  // Maximum number of tasks to track
+const uint8_t LEGACY_TASK_SLOTS = 12;  // Tasks stored as per-task keys before TaskStore
 
 enum class TimerState {
     IDLE,
@@ -33,9 +56,37 @@ enum class TimerState {
     PAUSED_LONG_BREAK,
     ALERT
 };
+const uint8_t TIMER_STATE_COUNT = 10;
+
+// Inputs to the state machine. Legal (state, event) pairs and their target
+// states live in the constexpr transition table in timer_core.cpp.
+enum class TimerEvent : uint8_t {
+    START_WORK,         // IDLE -> WORK
+    START_WINDUP,       // IDLE -> WIND_UP
+    CONFIRM_WINDUP,     // WIND_UP -> STARTING
+    CANCEL_WINDUP,      // WIND_UP -> IDLE
+    START_DELAY_DONE,   // STARTING -> WORK
+    PAUSE,              // running -> paused
+    RESUME,             // paused -> running
+    INTERRUPT,          // WORK / PAUSED_WORK -> IDLE
+    TIME_UP,            // running -> ALERT
+    START_SHORT_BREAK,  // ALERT -> SHORT_BREAK
+    START_LONG_BREAK,   // ALERT -> LONG_BREAK
+    ALERT_DONE,         // ALERT -> IDLE
+    RESET,              // any -> IDLE
+    NONE                // Never legal; for inputs that do nothing in a state
+};
+const uint8_t TIMER_EVENT_COUNT = 14;
 
 #endif
 
+// Snapshot of the running session, taken with one call
+struct TimerProgress {
+    uint32_t elapsedMs;
+    uint32_t remainingMs;
+    uint32_t progressQ16;  // 0..PROGRESS_Q16_ONE of the actual session duration
+};
+
 // Add to existing enums
 enum class MenuState {
     CLOSED,
@@ -66,21 +117,89 @@ enum class MenuItem {
     MENU_ITEM_COUNT      // Keep this last for iteration
 };
 
+// How a menu value is displayed
+enum class MenuUnit : uint8_t {
+    MINUTES,      // "25 min"
+    SECONDS,      // "5 sec"
+    COUNT,        // "3"
+    POMODOROS,    // "4 pomodoros"
+    TASKS,        // "2 tasks"
+    LEVEL_PCT,    // Brightness level 0-7 shown as a percentage
+    THEME,        // "Theme 1"
+    PROGRESS,     // "2 / 4" against the dynamic maximum
+    ON_OFF,
+    ORIENTATION   // "Normal" / "Flipped"
+};
+
+class TimerCore;
+
+// One row of the settings menu. Every menu operation is a lookup into
+// TimerCore::menuDescriptor(); adding a setting means adding a row.
+struct MenuDescriptor {
+    const char* label;  // printf format with the task number for per-task rows
+    MenuUnit unit;
+    uint8_t min;
+    uint8_t max;
+    uint8_t step;
+    bool toggle;        // Any encoder step flips 0 <-> 1
+    bool perTask;
+    uint8_t (TimerCore::*get)() const;
+    void (TimerCore::*set)(uint8_t value);
+    uint8_t (TimerCore::*dynamicMax)() const;  // Overrides max when set
+};
+
 class TimerCore {
 private:
+    // Time source (esp_timer on the device, FakeClock in host simulation)
+    Clock* clock;
+    uint64_t now() const { return clock->nowMicros(); }
+
+    // Change notifications for the UI, drained once per frame
+    ChangeQueue changes;
+    void notify(ChangeType type, uint8_t arg = 0) { changes.publish(type, arg); }
+
     // Menu
     MenuState menuState;
     MenuItem currentMenuItem;
     uint8_t editingValue;  // Temporary value while editing
 
+    // Menu accessors with the uniform uint8_t signature MenuDescriptor uses
+    uint8_t menuGetCompleted() const { return tasks.completed(currentTaskId); }
+    void menuSetCompleted(uint8_t v) { setTaskCompletedPomodoros(currentTaskId, v); }
+    uint8_t menuGetInterrupted() const { return tasks.interrupted(currentTaskId); }
+    void menuSetInterrupted(uint8_t v) { setTaskInterruptedPomodoros(currentTaskId, v); }
+    uint8_t menuGetSleepOnUSB() const { return sleepOnUSB ? 1 : 0; }
+    void menuSetSleepOnUSB(uint8_t v) { setSleepOnUSB(v != 0); }
+    uint8_t menuGetWindup() const { return windupEnabled ? 1 : 0; }
+    void menuSetWindup(uint8_t v) { setWindupEnabled(v != 0); }
+    uint8_t menuGetVibration() const { return alarmVibrationEnabled ? 1 : 0; }
+    void menuSetVibration(uint8_t v) { setAlarmVibration(v != 0); }
+    uint8_t menuGetFlash() const { return alarmFlashEnabled ? 1 : 0; }
+    void menuSetFlash(uint8_t v) { setAlarmFlash(v != 0); }
+    uint8_t menuGetFlipped() const { return screenFlipped ? 1 : 0; }
+    void menuSetFlipped(uint8_t v) { setScreenFlipped(v != 0); }
+
     // Timer state variables
     TimerState state;
     TimerState previousState;
-    uint32_t startTime;
-    uint32_t pausedTime;
+    uint64_t startTime;      // us
+    uint64_t pausedTime;     // us
     uint32_t remainingTime;
     uint32_t duration;
-    uint32_t idleStartTime;
+    uint64_t idleStartTime;  // us
+    uint32_t lastIdleMinutes;  // Last idle minute published as a SECOND change
+
+    // Session history: recent sessions in RAM, every session in the journal
+    SessionHistory history;
+    SessionJournal* journal;
+    uint32_t sessionStartEpoch;  // Wall-clock start of the running session
+    uint64_t sessionPausedUs;    // Pause total of the running session
+    void beginSession();
+    void recordSession(TimerState from, SessionOutcome outcome);
+
+    // Running statistics fed by recordSession() and the task counters
+    SessionStats stats;
+    void recountTotals();
 
     // Timer settings
     uint8_t workDuration;
@@ -105,28 +224,63 @@ private:
     bool alarmFlashEnabled;
 
     // Alert handling
-    uint32_t alertStartTime;
+    uint64_t alertStartTime;  // us
     bool alertActive;
     uint8_t blinkCount;
     
 
     // Task tracking
     uint8_t currentTaskId;
-    uint8_t totalTasks;
-    uint8_t completedPomodoros[MAX_TASKS];
-    uint8_t interruptedPomodoros[MAX_TASKS];
+    TaskStore tasks;
+    bool legacyKeys;  // Pre-record keys still in NVS, dropped on next save
+
+    // Deferred saves: what changed since the last write, and when
+    static const uint8_t DIRTY_SETTINGS = 0x01;
+    static const uint8_t DIRTY_TASKS = 0x02;
+    static const uint8_t DIRTY_STATS = 0x04;
+    uint8_t dirtyFields;
+    uint64_t dirtySince;  // us, restarts the quiet period
+    void markDirty(uint8_t fields);
+    void commitState();  // Queue the record if anything is dirty
+    uint64_t nextStateDeadline() const;
 
     // EEPROM functions
     void saveState();
     void loadState();
+    void loadLegacyState(SettingsStore& store);
+    size_t packState(uint8_t* payload, size_t len) const;
+    size_t sealState(uint8_t* record, size_t len) const;  // Header + payload, 0 if it does not fit
+    bool unpackState(const uint8_t* payload, size_t len, uint16_t version, bool withTelemetry);
+    void sanitizeState();  // Clamp loaded values to what the menu allows
+
+    // Transition actions, one per TimerEvent (run after the state changes)
+    void onStartWork(TimerState from);
+    void onStartWindup(TimerState from);
+    void onConfirmWindup(TimerState from);
+    void onCancelWindup(TimerState from);
+    void onStartDelayDone(TimerState from);
+    void onPause(TimerState from);
+    void onResume(TimerState from);
+    void onInterrupt(TimerState from);
+    void onTimeUp(TimerState from);
+    void onStartShortBreak(TimerState from);
+    void onStartLongBreak(TimerState from);
+    void onAlertDone(TimerState from);
+    void onReset(TimerState from);
+    void onNone(TimerState) {}
+    typedef void (TimerCore::*TransitionAction)(TimerState from);
+    static const TransitionAction TRANSITION_ACTIONS[TIMER_EVENT_COUNT];
 
     // Wind-up feature
     bool windupEnabled;
     uint32_t windupValue;  // Current wound-up seconds (0 to workDuration*60)
-    uint32_t windupStartTime;
+    uint64_t windupStartTime;  // us
 
 public:
-    TimerCore();
+    explicit TimerCore(Clock* clock = nullptr);
+    // Load persisted state: from the RTC snapshot after a deep sleep wake,
+    // otherwise from flash. Returns true if the snapshot was used.
+    bool begin(bool wokeFromSleep);
     void openMenu();
     void closeMenu();
     void navigateMenu(int8_t direction);  // +1 or -1
@@ -136,9 +290,18 @@ public:
     MenuState getMenuState() const { return menuState; }
     MenuItem getCurrentMenuItem() const { return currentMenuItem; }
     uint8_t getEditingValue() const { return editingValue; }
+    static const MenuDescriptor& menuDescriptor(MenuItem item);
+    uint8_t getMenuValue(MenuItem item) const;      // Current stored value
+    uint8_t getMenuMax(MenuItem item) const;        // Upper bound, dynamic if needed
+    void formatMenuLabel(MenuItem item, char* buf, size_t len) const;
+    void formatMenuValue(MenuItem item, uint8_t value, char* buf, size_t len) const;
 
     void resetSaveState();  // function to reset EEPROM
 
+    // State machine: one table lookup; returns false if illegal in this state
+    bool dispatch(TimerEvent event);
+    static bool canDispatch(TimerState state, TimerEvent event);
+
     // Timer controls
     void startWork();
     void startBreak();
@@ -148,7 +311,16 @@ public:
     void update();
     void interrupt();  // New: handle interruptions
     bool checkIdleTimeout(float batteryVoltage);  // Returns true if we should sleep
-    void resetIdleTimer() { idleStartTime = millis(); }
+    void logIdleStatus(float batteryVoltage) const;  // Idle countdown debug print
+    uint64_t nextDeadline() const;  // Next clock time (us) at which update() changes anything visible or saves
+    bool flushState();              // Write pending changes now; false if the writer timed out
+    void suspend();                 // Flush and leave an RTC snapshot (before deep sleep)
+
+    // Settings and stats transfer for provisioning, as a sealed state record
+    size_t exportState(uint8_t* record, size_t len) const { return sealState(record, len); }
+    bool importState(const uint8_t* record, size_t len);  // Idle only; one commit
+    bool hasUnsavedChanges() const { return dirtyFields != 0; }
+    void resetIdleTimer() { idleStartTime = now(); }
 
     // Task management
     void addTask();
@@ -203,15 +375,26 @@ public:
     void setAlarmFlash(bool enabled);                 // NEW
 
     // Getters
+    Clock& getClock() const { return *clock; }
+    ChangeQueue& getChanges() { return changes; }
+    const SessionHistory& getHistory() const { return history; }
+    // Log sessions to `journal` and refill the RAM history from it
+    void attachJournal(SessionJournal* journal);
+    const SessionStats& getStats() const { return stats; }
     TimerState getState() const { return state; }
     uint32_t getRemainingSeconds() const { return remainingTime; }
     uint32_t getRemainingMinutes() const { return remainingTime / 60; }
     uint32_t getRemainingSecondsInMinute() const { return remainingTime % 60; }
+    uint32_t getSessionDuration() const { return duration; }  // seconds, wind-up aware
+    uint32_t getElapsedMs() const;
+    uint32_t getRemainingMs() const { return duration * 1000UL - getElapsedMs(); }
+    uint32_t getProgressQ16() const { return getProgress().progressQ16; }
+    TimerProgress getProgress() const;
     uint8_t getCompletedSessions() const { return completedSessions; }
     uint8_t getCurrentTaskId() const { return currentTaskId; }
-    uint8_t getTotalTasks() const { return totalTasks; }
-    uint8_t getTaskCompletedPomodoros(uint8_t taskId) const { return completedPomodoros[taskId]; }
-    uint8_t getTaskInterruptedPomodoros(uint8_t taskId) const { return interruptedPomodoros[taskId]; }
+    uint8_t getTotalTasks() const { return tasks.count(); }
+    uint8_t getTaskCompletedPomodoros(uint8_t taskId) const { return tasks.completed(taskId); }
+    uint8_t getTaskInterruptedPomodoros(uint8_t taskId) const { return tasks.interrupted(taskId); }
     bool isWorkPeriod() const { return state == TimerState::WORK || state == TimerState::PAUSED_WORK; }
     bool isBreakPeriod() const { 
         return state == TimerState::SHORT_BREAK || state == TimerState::LONG_BREAK || 
@@ -232,7 +415,7 @@ public:
     uint8_t getAlarmDuration() const { return alarmDuration; }           
     bool getAlarmVibration() const { return alarmVibrationEnabled; }     
     bool getAlarmFlash() const { return alarmFlashEnabled; }             
-    uint32_t getIdleStartTime() const { return idleStartTime; }
+    uint32_t getIdleElapsedMs() const { return (uint32_t)((now() - idleStartTime) / 1000ULL); }
 
 
 };